@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+
+/**
+ * Minimal harness of the 1158engine_bench executable.
+ *
+ * Every file of bench/ declares its benchmarks with BENCHMARK(); main() runs
+ * all of them, or the ones whose name contains its first argument. Timings
+ * are the best of a few repetitions, reported per processed item.
+ */
+namespace bench {
+
+using BenchFunction = void (*)();
+
+/**
+ * @brief Adds a benchmark to the list main() runs. Use BENCHMARK() instead.
+ */
+bool Register(const char* name, BenchFunction function);
+
+/**
+ * @brief Keeps a result alive, so the work producing it is not optimized out.
+ */
+void Consume(double value);
+
+/**
+ * @brief Times `body` and prints the best of `repetitions` runs.
+ *
+ * @param label Printed in front of the timing.
+ * @param items Work items one call of `body` processes.
+ * @param body Callable running the measured work once.
+ * @param repetitions Number of timed calls.
+ * @return The best time per item, in nanoseconds.
+ */
+template <typename Body>
+double Measure(const char* label, std::size_t items, Body&& body,
+               int repetitions = 5) {
+  using Clock = std::chrono::steady_clock;
+  double best = std::numeric_limits<double>::max();
+
+  for (int i = 0; i < repetitions; ++i) {
+    const Clock::time_point start = Clock::now();
+    body();
+    const std::chrono::duration<double, std::nano> elapsed =
+        Clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+
+  const double perItem =
+      best / static_cast<double>(std::max<std::size_t>(items, 1));
+  std::printf("  %-44s %10.2f ns/item %10.3f ms\n", label, perItem,
+              best / 1e6);
+  return perItem;
+}
+
+}  // namespace bench
+
+/**
+ * Defines a benchmark function and registers it under its own name.
+ */
+#define BENCHMARK(name)                                              \
+  static void name();                                                \
+  static const bool name##Registered = bench::Register(#name, name); \
+  static void name()
@@ -0,0 +1,116 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "LightComponent.h"
+#include "Scene.h"
+#include "TransformComponent.h"
+
+// Component lookup and iteration on a 10k-object scene: the typed slot lookup
+// of GameObject::GetComponent() against the dynamic_cast scan it replaced,
+// and per-object lookups against walking the archetype columns.
+
+namespace {
+
+constexpr std::size_t ObjectCount = 10000;
+
+/** Every third object of the scene carries a light. */
+void FillScene(Scene& scene, std::vector<GameObject*>& objects) {
+  objects.reserve(ObjectCount);
+
+  for (std::size_t i = 0; i < ObjectCount; ++i) {
+    GameObject* object = scene.CreateGameObject("Object" + std::to_string(i));
+    object->GetComponent<TransformComponent>()->SetPosition(
+        glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+    if (i % 3 == 0) {
+      object->AddComponent<LightComponent>()->SetIntensity(1.0f);
+    }
+    objects.push_back(object);
+  }
+}
+
+/** The lookup GameObject::GetComponent() did before component types had
+ * IDs: a dynamic_cast of every component until one matches. */
+template <typename T>
+T* FindByCast(const std::vector<Component*>& components) {
+  for (Component* component : components) {
+    if (T* match = dynamic_cast<T*>(component)) {
+      return match;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+BENCHMARK(GetComponent) {
+  Scene scene;
+  std::vector<GameObject*> objects;
+  FillScene(scene, objects);
+
+  // The same components, listed per object like the old component vector.
+  std::vector<std::vector<Component*>> componentLists(objects.size());
+  for (std::size_t i = 0; i < objects.size(); ++i) {
+    componentLists[i].push_back(objects[i]->GetComponent<TransformComponent>());
+    if (auto* light = objects[i]->GetComponent<LightComponent>()) {
+      componentLists[i].push_back(light);
+    }
+  }
+
+  bench::Measure("dynamic_cast scan", ObjectCount, [&] {
+    float sum = 0.0f;
+    for (const std::vector<Component*>& components : componentLists) {
+      sum += FindByCast<TransformComponent>(components)->GetPosition().x;
+      if (auto* light = FindByCast<LightComponent>(components)) {
+        sum += light->GetIntensity();
+      }
+    }
+    bench::Consume(sum);
+  });
+
+  bench::Measure("GameObject::GetComponent()", ObjectCount, [&] {
+    float sum = 0.0f;
+    for (GameObject* object : objects) {
+      sum += object->GetComponent<TransformComponent>()->GetPosition().x;
+      if (auto* light = object->GetComponent<LightComponent>()) {
+        sum += light->GetIntensity();
+      }
+    }
+    bench::Consume(sum);
+  });
+}
+
+BENCHMARK(ArchetypeIteration) {
+  Scene scene;
+  std::vector<GameObject*> objects;
+  FillScene(scene, objects);
+
+  bench::Measure("GetComponent() per object", ObjectCount, [&] {
+    float sum = 0.0f;
+    for (GameObject* object : objects) {
+      sum += object->GetComponent<TransformComponent>()->GetPosition().x;
+    }
+    bench::Consume(sum);
+  });
+
+  bench::Measure("View<TransformComponent>", ObjectCount, [&] {
+    float sum = 0.0f;
+    scene.View<TransformComponent>().ForEach(
+        [&sum](GameObject&, TransformComponent& transform) {
+          sum += transform.GetPosition().x;
+        });
+    bench::Consume(sum);
+  });
+
+  const std::size_t lightCount =
+      scene.View<TransformComponent, LightComponent>().Count();
+  bench::Measure("View<TransformComponent, LightComponent>", lightCount, [&] {
+    float sum = 0.0f;
+    scene.View<TransformComponent, LightComponent>().ForEach(
+        [&sum](GameObject&, TransformComponent& transform,
+               LightComponent& light) {
+          sum += transform.GetPosition().x * light.GetIntensity();
+        });
+    bench::Consume(sum);
+  });
+}
@@ -0,0 +1,120 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Bench.h"
+#include "core/AabbTree.h"
+#include "core/Bounds.h"
+
+// The scene's bounding volume hierarchy with N unit boxes at a constant
+// density: building it, refitting moving objects, and box and frustum queries
+// against testing every box.
+
+namespace {
+
+Aabb MakeBox(const glm::vec3& center) {
+  Aabb box;
+  box.Expand(center - glm::vec3(0.5f));
+  box.Expand(center + glm::vec3(0.5f));
+  return box;
+}
+
+void Run(std::size_t count) {
+  // About one box per 8 cubic units, whatever the count.
+  const float halfSize = 0.5f * std::cbrt(8.0f * static_cast<float>(count));
+
+  std::mt19937 generator(1158);
+  std::uniform_real_distribution<float> position(-halfSize, halfSize);
+  std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+
+  std::vector<Aabb> boxes(count);
+  for (Aabb& box : boxes) {
+    box = MakeBox(
+        glm::vec3(position(generator), position(generator),
+                  position(generator)));
+  }
+
+  // 1000 probes of 4 units, and a camera at the edge looking at the center
+  // with a 50-unit draw distance.
+  std::vector<Aabb> probes(1000);
+  for (Aabb& probe : probes) {
+    const glm::vec3 center(position(generator), position(generator),
+                           position(generator));
+    probe.Expand(center - glm::vec3(2.0f));
+    probe.Expand(center + glm::vec3(2.0f));
+  }
+  const Frustum frustum = Frustum::FromMatrix(
+      glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f,
+                       50.0f) *
+      glm::lookAt(glm::vec3(0.0f, 0.0f, halfSize), glm::vec3(0.0f),
+                  glm::vec3(0.0f, 1.0f, 0.0f)));
+
+  std::printf(" %zu objects\n", count);
+
+  AabbTree tree;
+  std::vector<std::int32_t> proxies(count);
+  bench::Measure("Insert each object", count, [&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      proxies[i] = tree.CreateProxy(boxes[i], &boxes[i]);
+    }
+  }, 1);
+
+  bench::Measure("SAH rebuild", count, [&] { tree.Rebuild(); }, 1);
+
+  // Every tenth object moves by up to a unit per frame, mostly out of its fat
+  // box.
+  const std::size_t movingCount = count / 10;
+  bench::Measure("Refit 10% moving objects", movingCount, [&] {
+    for (std::size_t i = 0; i < count; i += 10) {
+      boxes[i] = MakeBox(boxes[i].GetCenter() +
+                         glm::vec3(step(generator), step(generator),
+                                   step(generator)));
+      tree.MoveProxy(proxies[i], boxes[i]);
+    }
+  });
+
+  std::size_t hits = 0;
+  bench::Measure("Box queries, tree", probes.size(), [&] {
+    for (const Aabb& probe : probes) {
+      tree.QueryAabb(probe, [&hits](std::int32_t) {
+        ++hits;
+        return true;
+      });
+    }
+  });
+  // A tenth of the probes, which is enough for a scan of every box.
+  const std::size_t scannedProbes = probes.size() / 10;
+  bench::Measure("Box queries, every box", scannedProbes, [&] {
+    for (std::size_t i = 0; i < scannedProbes; ++i) {
+      for (const Aabb& box : boxes) {
+        hits += box.Overlaps(probes[i]) ? 1 : 0;
+      }
+    }
+  }, 1);
+
+  bench::Measure("Frustum query, tree", count, [&] {
+    tree.QueryFrustum(frustum, [&hits](std::int32_t) {
+      ++hits;
+      return true;
+    });
+  });
+  bench::Measure("Frustum query, every box", count, [&] {
+    for (const Aabb& box : boxes) {
+      hits += frustum.Overlaps(box) ? 1 : 0;
+    }
+  });
+
+  bench::Consume(static_cast<double>(hits));
+}
+
+}  // namespace
+
+BENCHMARK(SpatialIndex) {
+  for (std::size_t count : {10000u, 100000u, 1000000u}) {
+    Run(count);
+  }
+}
@@ -0,0 +1,90 @@
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "Bench.h"
+#include "core/TransformKernel.h"
+
+// World matrices of N transforms: the per-object glm path the renderer used
+// before the kernel, then every kernel this CPU runs.
+
+namespace {
+
+void Run(std::size_t count) {
+  std::mt19937 generator(1158);
+  std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+  std::array<std::vector<float>, 10> arrays;
+  for (std::vector<float>& array : arrays) {
+    array.resize(count);
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const glm::quat rotation = glm::normalize(glm::quat(
+        value(generator), value(generator), value(generator),
+        value(generator)));
+    arrays[0][i] = value(generator) * 100.0f;
+    arrays[1][i] = value(generator) * 100.0f;
+    arrays[2][i] = value(generator) * 100.0f;
+    arrays[3][i] = rotation.x;
+    arrays[4][i] = rotation.y;
+    arrays[5][i] = rotation.z;
+    arrays[6][i] = rotation.w;
+    arrays[7][i] = 1.0f + value(generator) * 0.5f;
+    arrays[8][i] = 1.0f + value(generator) * 0.5f;
+    arrays[9][i] = 1.0f + value(generator) * 0.5f;
+  }
+
+  const TransformSoA input{arrays[0].data(), arrays[1].data(),
+                           arrays[2].data(), arrays[3].data(),
+                           arrays[4].data(), arrays[5].data(),
+                           arrays[6].data(), arrays[7].data(),
+                           arrays[8].data(), arrays[9].data()};
+  std::vector<glm::mat4> output(count);
+
+  std::printf(" %zu transforms\n", count);
+
+  bench::Measure("glm translate * rotate * scale", count, [&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      output[i] =
+          glm::translate(glm::mat4(1.0f),
+                         glm::vec3(arrays[0][i], arrays[1][i], arrays[2][i])) *
+          glm::mat4_cast(glm::quat(arrays[6][i], arrays[3][i], arrays[4][i],
+                                   arrays[5][i])) *
+          glm::scale(glm::mat4(1.0f),
+                     glm::vec3(arrays[7][i], arrays[8][i], arrays[9][i]));
+    }
+    bench::Consume(output[count - 1][3][0]);
+  });
+
+  const std::array<std::pair<const char*, TransformKernelFn>, 3> kernels{
+      {{"Scalar kernel", GetTransformKernelScalar()},
+       {"SSE4.2 kernel", GetTransformKernelSse42()},
+       {"AVX2 kernel", GetTransformKernelAvx2()}}};
+
+  for (std::size_t level = 0; level < kernels.size(); ++level) {
+    const auto& [label, kernel] = kernels[level];
+    // The selected level is the best one the CPU runs.
+    if (kernel == nullptr ||
+        level > static_cast<std::size_t>(GetTransformKernelLevel())) {
+      continue;
+    }
+
+    bench::Measure(label, count, [&] {
+      kernel(input, count, output.data());
+      bench::Consume(output[count - 1][3][0]);
+    });
+  }
+}
+
+}  // namespace
+
+BENCHMARK(TransformKernel) {
+  for (std::size_t count : {1000, 100000, 1000000}) {
+    Run(count);
+  }
+}
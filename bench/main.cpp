@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Bench.h"
+
+namespace {
+
+struct Benchmark {
+  const char* name;
+  bench::BenchFunction function;
+};
+
+std::vector<Benchmark>& GetBenchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+volatile double sink = 0.0;
+
+}  // namespace
+
+bool bench::Register(const char* name, BenchFunction function) {
+  GetBenchmarks().push_back({name, function});
+  return true;
+}
+
+void bench::Consume(double value) {
+  sink = sink + value;
+}
+
+int main(int argc, char* argv[]) {
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+  std::size_t runCount = 0;
+
+  for (const Benchmark& benchmark : GetBenchmarks()) {
+    if (filter != nullptr && std::strstr(benchmark.name, filter) == nullptr) {
+      continue;
+    }
+
+    std::printf("%s\n", benchmark.name);
+    benchmark.function();
+    ++runCount;
+  }
+
+  if (runCount == 0) {
+    std::fprintf(stderr, "No benchmark matches \"%s\"\n",
+                 filter != nullptr ? filter : "");
+    return 1;
+  }
+
+  return 0;
+}
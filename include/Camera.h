@@ -56,43 +56,48 @@ class Camera {
 
   /**
      * @brief Moves the camera forward in the direction it is facing.
+     *
+     * Movement and rotation speeds are per second, so the camera moves at
+     * the same pace whatever the frame rate.
+     *
+     * @param deltaTime Time elapsed since the last frame, in seconds.
      */
-  void MoveForward();
+  void MoveForward(float deltaTime);
 
   /**
      * @brief Moves the camera backward, opposite to the direction it is facing.
      */
-  void MoveBackward();
+  void MoveBackward(float deltaTime);
 
   /**
      * @brief Moves the camera to the left.
      */
-  void MoveLeft();
+  void MoveLeft(float deltaTime);
 
   /**
      * @brief Moves the camera to the right.
      */
-  void MoveRight();
+  void MoveRight(float deltaTime);
 
   /**
      * @brief Moves the camera upward along the Y-axis.
      */
-  void MoveUp();
+  void MoveUp(float deltaTime);
 
   /**
      * @brief Moves the camera downward along the Y-axis.
      */
-  void MoveDown();
+  void MoveDown(float deltaTime);
 
   /**
      * @brief Rotates the camera to the left.
      */
-  void RotateLeft();
+  void RotateLeft(float deltaTime);
 
   /**
      * @brief Rotates the camera to the right.
      */
-  void RotateRight();
+  void RotateRight(float deltaTime);
 
   /**
      * @brief Rotates the camera based on mouse movement.
@@ -119,7 +124,10 @@ class Camera {
   /**< The upward direction in the world coordinate system. */
   glm::vec3 m_worldUp;
 
-  float m_speed = 0.5f; /**< Base movement speed of the camera. */
+  /**< Movement speed of the Move* methods, in units per second. */
+  float m_speed = 30.0f;
+  /**< Turn speed of the Rotate* methods, in degrees per second. */
+  float m_turnSpeed = 300.0f;
   float m_yaw;   /**< Yaw angle for horizontal rotation around the Y-axis. */
   float m_pitch; /**< Pitch angle for vertical rotation around the X-axis. */
   float m_movementSpeed;    /**< Current speed at which the camera moves. */
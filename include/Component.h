@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include "core/ComponentType.h"
 
 class GameObject;
 
@@ -11,21 +12,51 @@ class GameObject;
  * The Component class serves as a base for all components that can be attached
  * to game objects in the game engine. It provides an interface for updating and
  * rendering components.
+ *
+ * Every concrete component declares `static constexpr ComponentType
+ * StaticType` and must be nothrow move constructible, because the
+ * ArchetypeStorage relocates components when their owner's archetype changes.
  */
 class Component {
  public:
+  /**
+   * Components are updated in parallel by default. Types whose Update() is
+   * not thread-safe shadow this with `true` to stay on the main thread.
+   */
+  static constexpr bool MainThreadOnly = false;
+
+  /**
+   * Whether Update() does any work. Types whose Update() is empty shadow this
+   * with `false`; the scene then never visits their columns when updating.
+   */
+  static constexpr bool HasUpdate = true;
+
+  /**
+   * Whether Render() does any work. False by default, like Render() itself;
+   * types overriding Render() shadow this with `true`.
+   */
+  static constexpr bool HasRender = false;
+
+  /**
+   * Whether the component contributes to its owner's bounds. Adding or
+   * removing such a component refits the owner in the scene's spatial index;
+   * types shadowing this with `true` also call
+   * TransformComponent::MarkBoundsDirty() when their bounds change.
+   */
+  static constexpr bool HasBounds = false;
+
   /**
   * @brief Constructs a Component with the specified owner GameObject.
   *
   * @param owner Pointer to the GameObject that owns this component.
   */
-  explicit Component(std::weak_ptr<GameObject> owner)
-      : m_owner(std::move(owner)) {};
+  explicit Component(GameObject* owner) : m_owner(owner) {};
 
   // We probably won't need them right now until we'll implement duplicating.
   Component(const Component&) = delete;
   Component& operator=(const Component&) = delete;
-  Component(Component&&) = delete;
+  // Used by the ArchetypeStorage to relocate components between chunks.
+  Component(Component&&) noexcept = default;
   Component& operator=(Component&&) = delete;
 
   /**
@@ -50,7 +81,13 @@ class Component {
   */
   virtual void Render() {};
 
+  /**
+  * @brief Gets the GameObject that owns this component.
+  */
+  [[nodiscard]] GameObject* GetOwner() const { return m_owner; }
+
  protected:
-  /** Weak pointer to the GameObject that owns this component. */
-  std::weak_ptr<GameObject> m_owner;
+  /** The GameObject that owns this component. Components are destroyed
+   * before their owner, so the pointer never dangles. */
+  GameObject* m_owner;
 };
\ No newline at end of file
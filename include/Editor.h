@@ -4,16 +4,21 @@
 // Copyright (c) 2014-2024 Omar Cornut
 // License: MIT (included in the LICENSE file)
 
+#include "MeshLibrary.h"
 #include "NotificationManager.h"
 #include "SceneManager.h"
 #include "Scene.h"
+#include "core/FrameArena.h"
 #include "imgui.h"
 #include <glad/glad.h>
 #include <string>
 #include <GLFW/glfw3.h>
 #include <filesystem>
+#include <memory>
 #include <vector>
 
+class Renderer;
+
 class Editor {
  public:
   Editor();
@@ -47,9 +52,25 @@ class Editor {
 
   /**
     * @brief Ends the frame for ImGui rendering.
+    * 
+    * Only finalizes the draw data; RenderDrawData() draws it.
     */
   static void End();
 
+  /**
+    * @brief Draws UI output produced by End(), on the OpenGL thread.
+    * 
+    * @param drawData The draw data to render; nullptr draws nothing.
+    */
+  static void RenderDrawData(const ImDrawData* drawData);
+
+  /**
+    * @brief Resizes the viewport framebuffer, on the OpenGL thread.
+    * 
+    * @param size Viewport size the frame being drawn was laid out with.
+    */
+  void SyncFramebuffer(ImVec2 size);
+
   /**
     * @brief Renders the editor UI and scene.
     * 
@@ -67,6 +88,22 @@ class Editor {
 
   [[nodiscard]] bool IsViewportFocused() const { return m_viewportFocused; }
 
+  /**
+    * @brief Sets the arena that per-frame UI strings are allocated from.
+    */
+  void SetFrameArena(std::shared_ptr<FrameArena> frameArena) {
+    m_frameArena = std::move(frameArena);
+  }
+
+  /**
+    * @brief Sets the renderer whose settings the Render panel edits.
+    * 
+    * Held weakly: the renderer owns the editor.
+    */
+  void SetRenderer(std::weak_ptr<Renderer> renderer) {
+    m_renderer = std::move(renderer);
+  }
+
  private:
   struct FileEntry {
     std::string name;     /** Name of the file or directory. */
@@ -90,10 +127,14 @@ class Editor {
   /** Renders the hierarchy of objects in the scene. */
   void RenderSceneHierarchy(const std::shared_ptr<Scene>& scene);
   /** Renders the properties panel for selected objects. */
-  void RenderPropertiesPanel() const;
+  void RenderPropertiesPanel(const std::shared_ptr<Scene>& scene) const;
   /** Renders the menu bar for editor options. */
   void RenderMenuBar(const std::shared_ptr<Scene>& scene);
   void RenderAssetsPanel(); /** Renders the assets panel to browse files. */
+  /** Lists the meshes of the MeshLibrary with their memory use. */
+  void RenderMeshLibraryPanel();
+  /** Renders the renderer's culling and level of detail settings. */
+  void RenderSettingsPanel() const;
 
   /** Updates the contents of the current directory. */
   void UpdateDirectoryContents();
@@ -104,13 +145,22 @@ class Editor {
   GLuint m_depthStencilRBO{0}; /** Renderbuffer object for depth and stencil. */
 
   ImVec2 m_viewportSize; /** Size of the viewport in the editor. */
+  /** Size the framebuffer is allocated with; owned by the OpenGL thread. */
+  ImVec2 m_framebufferSize;
   /** Indicates if the viewport is currently focused. */
   bool m_viewportFocused{false};
 
-  /** Currently selected game object. */
-  std::shared_ptr<GameObject> m_selectedObject{nullptr};
+  /** Currently selected game object; null or stale when nothing is. */
+  EntityHandle m_selectedObject;
 
   std::shared_ptr<SceneManager> m_sceneManager{nullptr};
 
   std::shared_ptr<NotificationManager> m_notificationManager{nullptr};
+
+  std::shared_ptr<FrameArena> m_frameArena{nullptr};
+
+  std::weak_ptr<Renderer> m_renderer;
+
+  /** Refilled by the meshes panel every frame, keeping its capacity. */
+  std::vector<MeshLibrary::MeshStats> m_meshStats;
 };
\ No newline at end of file
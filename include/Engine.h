@@ -1,5 +1,6 @@
 #pragma once
 #include "Editor.h"
+#include "RenderThread.h"
 #include "Renderer.h"
 #include "SceneManager.h"
 
@@ -48,6 +49,26 @@ class Engine {
 	*/
   void Run();
 
+  /**
+	* @brief Sets the length of a simulation step.
+	* 
+	* The scene is updated in steps of exactly this length, independently of
+	* the frame rate; rendering interpolates between the last two steps.
+	* 
+	* @param seconds Step length, 1/60 by default.
+	*/
+  void SetFixedTimeStep(double seconds) { m_fixedTimeStep = seconds; }
+
+  /**
+	* @brief Selects whether frames are submitted by a dedicated render thread.
+	* 
+	* When enabled, the main thread simulates and extracts frame N while the
+	* render thread submits frame N-1. Takes effect at the next Run().
+	* 
+	* @param pipelined True by default.
+	*/
+  void SetPipelined(bool pipelined) { m_pipelined = pipelined; }
+
   /**
 	* @brief Shuts down the engine and releases resources.
 	* 
@@ -62,6 +83,18 @@ class Engine {
   /**Pointer to the SceneManager that handles scene transitions and GameObject management. */
   std::shared_ptr<SceneManager> m_sceneManager{nullptr};
   std::shared_ptr<Editor> m_editor{nullptr};
+  /**Engine-wide worker threads. */
+  std::shared_ptr<JobSystem> m_jobSystem{nullptr};
+  /**Double-buffered scratch memory, reset at the start of every frame. */
+  std::shared_ptr<FrameArena> m_frameArena{nullptr};
+  /**Owns the OpenGL context while Run() is pipelined. */
+  std::unique_ptr<RenderThread> m_renderThread{nullptr};
+  /**Whether Run() submits frames from a dedicated render thread. */
+  bool m_pipelined{true};
+  /**Most simulation steps run in one frame before the backlog is dropped. */
+  static constexpr int MaxStepsPerFrame = 5;
+  /**Length of a simulation step, in seconds. */
+  double m_fixedTimeStep{1.0 / 60.0};
   /**Flag indicating whether the engine is currently running. */
   bool m_isRunning{false};
 };
@@ -1,137 +1,160 @@
 #pragma once
+#include <array>
 #include <iostream>
 #include <memory>
 #include <string>
-#include <vector>
+#include <type_traits>
 #include "Component.h"
 #include "LightComponent.h"
 #include "ScriptComponent.h"
 #include "TransformComponent.h"
+#include "core/ArchetypeStorage.h"
+#include "core/EntityHandle.h"
 
 
 /**
  * @class GameObject
  * @brief Represents a game object that can have various components attached.
  * 
- * The GameObject class serves as a container for different components,
- * allowing for modular functionality in the game engine. It manages
- * components, updates their state, and handles rendering.
+ * The GameObject class is a view over the scene's ArchetypeStorage: the
+ * components themselves live in the columns of the archetype matching the
+ * object's component set, and the GameObject only keeps its location there.
+ *
+ * GameObjects are owned by their scene's EntityTable. Code that needs to
+ * keep referring to an object across frames stores its EntityHandle.
  */
-class GameObject : public std::enable_shared_from_this<GameObject> {
+class GameObject {
  public:
   /**
      * @brief Constructs a GameObject with given name.
      * 
-     * Initializes a TransformComponent and adds it to the game object.
-     * Every GameObject must have at least a TransformComponent.
+     * The object starts without components; Initialize() adds the
+     * TransformComponent every GameObject must have.
 	 * 
      * @param name The name of the game object.
+     * @param storage The storage of the scene the object belongs to.
      */
-  explicit GameObject(std::string name)
-      : m_name(std::move(name)), m_id(nextID++) {
+  GameObject(std::string name, std::shared_ptr<ArchetypeStorage> storage)
+      : m_name(std::move(name)),
+        m_storage(std::move(storage)),
+        m_id(nextID++) {
     std::cout << "Creating GameObject: " << m_name << std::endl;
   }
 
+  GameObject(const GameObject&) = delete;
+  GameObject& operator=(const GameObject&) = delete;
+  GameObject(GameObject&&) = delete;
+  GameObject& operator=(GameObject&&) = delete;
+
   void Initialize() {
-    //std::cout << "Running transformComponent = std::make_unique<TransformComponent>(shared_from_this()); from GameObject::Initialize()\n";
-    if (!transformComponent) {
-      transformComponent =
-          std::make_unique<TransformComponent>(shared_from_this());
-      m_components.push_back(std::move(transformComponent));
+    if (GetComponent<TransformComponent>() == nullptr) {
+      EmplaceComponent<TransformComponent>(this);
     }
   }
 
   /**
      * @brief Destroys the GameObject and cleans up components.
      * 
-     * Deletes all components associated with the game object to free resources.
+     * Destroys the components still stored for this object and frees its row.
      */
   ~GameObject() {
     std::cout << "Destroying GameObject: " << m_name << std::endl;
-  }
-
-  /**
-     * @brief Adds a component to the game object.
-     * 
-     * @param component Pointer to the component to be added.
-     * 
-     * This method prevents adding multiple TransformComponents.
-     */
-  void AddComponent(std::unique_ptr<Component> component) {
-    if (dynamic_cast<TransformComponent*>(component.get()) != nullptr) {
-      return;
-    }
-    m_components.push_back(std::move(component));
+    m_storage->RemoveEntity(*this);
   }
 
   /**
      * @brief Template method to add a component of a specific type.
      * 
+     * Adding a component moves the object to another archetype, so pointers
+     * to its other components must be fetched again afterwards.
+     * 
      * @tparam T The type of the component to add.
      * @tparam Args Variadic template parameters for constructor arguments.
      * 
      * @param args Constructor arguments for the component.
-     * @return Pointer to the newly created component, or nullptr if the component is TransformComponent.
+     * @return Pointer to the component of type T (the existing one if the
+     * object already has it), or nullptr if the component is TransformComponent.
      */
   template <typename T, typename... Args>
-  std::unique_ptr<T> AddComponent(Args&&... args) {
-    if (std::is_same<T, TransformComponent>::value) {
+  T* AddComponent(Args&&... args) {
+    if constexpr (std::is_same_v<T, TransformComponent>) {
       return nullptr;
-    }
-
-    auto component =
-        std::make_unique<T>(shared_from_this(), std::forward<Args>(args)...);
+    } else {
+      if (T* existing = GetComponent<T>()) {
+        return existing;
+      }
 
-    m_components.push_back(std::move(component));
+      T* component = EmplaceComponent<T>(this, std::forward<Args>(args)...);
+      if constexpr (T::HasBounds) {
+        GetComponent<TransformComponent>()->MarkBoundsDirty();
+      }
+      return component;
+    }
+  }
 
-    return component;
+  /**
+     * @brief Destroys the component of a specific type, if present.
+     * 
+     * The TransformComponent cannot be removed.
+     * 
+     * @tparam T The type of the component to remove.
+     */
+  template <typename T>
+  void RemoveComponent() {
+    if constexpr (!std::is_same_v<T, TransformComponent>) {
+      if constexpr (T::HasBounds) {
+        if (GetComponent<T>() != nullptr) {
+          GetComponent<TransformComponent>()->MarkBoundsDirty();
+        }
+      }
+      m_storage->RemoveComponent(*this, T::StaticType);
+    }
   }
 
   /**
      * @brief Retrieves a component of a specified type.
      * 
+     * Constant time: the slot table is indexed by T::StaticType, without any
+     * RTTI or scan over the components.
+     * 
      * @tparam T The type of the component to retrieve.
      * @return Pointer to the component of type T, or nullptr if not found.
      */
   template <typename T>
   T* GetComponent() {
-    for (const auto& component : m_components) {
-      if (auto castedComponent = dynamic_cast<T*>(component.get())) {
-        return castedComponent;
-      }
-    }
-
-    return nullptr;
+    return static_cast<T*>(
+        m_componentSlots[static_cast<std::size_t>(T::StaticType)]);
   }
 
+  /**
+     * @brief Retrieves a component by its runtime type.
+     * 
+     * @param type The type of the component to retrieve.
+     * @return Pointer to the component, or nullptr if not found.
+     */
+  Component* GetComponent(ComponentType type);
+
   /**
      * @brief Updates the game object and its components.
      * 
+     * Scene::Update walks the archetype columns instead; this is for updating
+     * a single object out of band.
+     * 
      * @param deltaTime The time elapsed since the last update.
      */
-  void Update(float deltaTime) {
-    //std::cout << "\tUpdating " << m_name << "." << std::endl; Will reuse this in the Log Dock
-    for (const auto& component : m_components) {
-      component->Update(deltaTime);
-    }
-  }
+  void Update(float deltaTime);
 
   /**
      * @brief Renders the game object and its components.
      */
-  void Render() {
-    //std::cout << "\tRendering " << m_name << ".\n";
-    for (const auto& component : m_components) {
-      component->Render();
-    }
-  }
+  void Render();
 
   /**
      * @brief Retrieves the name of the game object.
      * 
      * @return The name of the game object.
      */
-  [[nodiscard]] std::string GetName() const { return m_name; }
+  [[nodiscard]] const std::string& GetName() const { return m_name; }
 
   /**
      * @brief Sets the name of the game object.
@@ -142,10 +165,31 @@ class GameObject : public std::enable_shared_from_this<GameObject> {
 
   [[nodiscard]] unsigned int GetID() const { return m_id; }
 
+  /**
+     * @brief Retrieves the handle of the game object in its scene.
+     * 
+     * @return A handle that resolves to nullptr once the object is destroyed.
+     */
+  [[nodiscard]] EntityHandle GetHandle() const { return m_handle; }
+
  private:
+  friend class ArchetypeStorage;
+  friend class EntityTable;
+
+  template <typename T, typename... Args>
+  T* EmplaceComponent(Args&&... args) {
+    void* slot = m_storage->AddComponentSlot(*this, T::StaticType);
+    return new (slot) T(std::forward<Args>(args)...);
+  }
+
   std::string m_name; /**The name of the game object. */
-  std::vector<std::unique_ptr<Component>> m_components;
-  std::unique_ptr<TransformComponent> transformComponent{nullptr};
+  /**Storage holding the components; shared so it outlives every object. */
+  std::shared_ptr<ArchetypeStorage> m_storage;
+  EntityLocation m_location; /**Row of the object inside m_storage. */
+  /**Address of each owned component, indexed by ComponentType. Refreshed by
+   * the ArchetypeStorage whenever m_location changes. */
+  std::array<void*, ComponentTypeCount> m_componentSlots{};
   unsigned int m_id;
+  EntityHandle m_handle; /**Assigned by the EntityTable owning the object. */
   static unsigned int nextID;
 };
\ No newline at end of file
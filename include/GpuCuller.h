@@ -0,0 +1,141 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include "ShaderManager.h"
+#include "core/StreamingBuffer.h"
+
+/**
+ * @struct InstanceBounds
+ * @brief World box of one instance, in the layout shaders/cull.comp reads.
+ */
+struct InstanceBounds {
+  glm::vec3 center;
+  /**Indirect command the instance belongs to. */
+  std::uint32_t draw;
+  /**Half size of the box along each axis. */
+  glm::vec3 extents;
+  std::uint32_t padding{0};
+};
+
+/**
+ * @class GpuCuller
+ * @brief Frustum and occlusion culling of instances in a compute shader.
+ *
+ * Every instance of the frame is tested on the GPU against the frustum, then
+ * against a hierarchical depth (Hi-Z) pyramid: mip levels of the previous
+ * frame's depth buffer, each texel holding the farthest depth of the four
+ * below it. Survivors bump the instanceCount of their indirect command with
+ * an atomic and write their index into the visible-instance list from the
+ * command's baseInstance on. The draws read the list as MeshBuffer's
+ * per-instance attribute, so they consume the result without a CPU readback.
+ *
+ * The pyramid lags one frame behind. Boxes are projected with the view
+ * projection the pyramid was built with, so each is compared with the depth
+ * at the place it covered in that frame rather than where the current camera
+ * puts it. An object uncovered since, by the camera or by a moving occluder,
+ * still appears a frame late.
+ *
+ * Requires OpenGL 4.5 core, without extensions: compute shaders, storage
+ * buffers, atomics, r32f image load/store and direct state access.
+ *
+ * All methods must run on the thread whose OpenGL context is current.
+ */
+class GpuCuller {
+ public:
+  /**Storage buffer bindings of shaders/cull.comp. */
+  static constexpr GLuint VisibleBinding = 2;
+  static constexpr GLuint BoundsBinding = 3;
+  static constexpr GLuint CommandBinding = 4;
+
+  explicit GpuCuller(std::shared_ptr<ShaderManager> shaderManager);
+  ~GpuCuller();
+
+  GpuCuller(const GpuCuller&) = delete;
+  GpuCuller& operator=(const GpuCuller&) = delete;
+
+  /**
+   * @brief Loads the compute shaders.
+   *
+   * @return False if the shaders failed to build; the renderer then keeps
+   * culling on the CPU.
+   */
+  bool Initialize();
+
+  /**
+   * @brief Deletes every GPU resource.
+   */
+  void Shutdown();
+
+  [[nodiscard]] bool IsAvailable() const { return m_available; }
+
+  /**
+   * @brief Culls the instances of a frame into its indirect commands.
+   *
+   * The commands must have been uploaded with instanceCount 0 and their
+   * first slot in the visible-instance list as baseInstance. Ends with the
+   * barrier that makes the commands and the list readable by indirect draws.
+   *
+   * @param viewProjection The frame's projection * view.
+   * @param bounds One box per instance, in instance order.
+   * @param count Number of instances.
+   * @param commands DrawElementsIndirectCommand records.
+   * @param visible Receives the index of every visible instance.
+   */
+  void Cull(const glm::mat4& viewProjection, const InstanceBounds* bounds,
+            std::size_t count, const StreamAllocation& commands,
+            const StreamAllocation& visible);
+
+  /**
+   * @brief Builds the depth pyramid the next Cull() tests against.
+   *
+   * Called after the scene pass.
+   *
+   * @param framebuffer Framebuffer the scene was drawn into. Its depth
+   * attachment must be GL_DEPTH24_STENCIL8, like the editor's viewport.
+   * @param width Size of the framebuffer, in pixels.
+   * @param height Size of the framebuffer, in pixels.
+   * @param viewProjection The projection * view the scene was drawn with.
+   */
+  void UpdateDepthPyramid(GLuint framebuffer, int width, int height,
+                          const glm::mat4& viewProjection);
+
+  /**
+   * @brief Forgets the depth pyramid; the next Cull() only tests the frustum.
+   *
+   * For frames whose previous depth is unrelated, e.g. after a camera cut.
+   */
+  void InvalidateDepthPyramid() { m_pyramidValid = false; }
+
+ private:
+  /**Threads per work group of shaders/cull.comp. */
+  static constexpr std::size_t CullGroupSize = 64;
+  /**Threads per side of a work group of shaders/hiz.comp. */
+  static constexpr int PyramidGroupSize = 8;
+  /**Most work groups dispatched along x in one call. */
+  static constexpr std::size_t MaxGroupCount = 65535;
+
+  /**
+   * @brief Recreates the depth copy and the pyramid for a new size.
+   */
+  void ResizeDepthPyramid(int width, int height);
+
+  std::shared_ptr<ShaderManager> m_shaderManager;
+  bool m_available{false};
+  /**Copy of the scene's depth, which a renderbuffer cannot provide to
+   * shaders. */
+  GLuint m_depthFramebuffer{0};
+  GLuint m_depthTexture{0};
+  /**r32f mip chain, level 0 at half the depth's resolution. */
+  GLuint m_pyramidTexture{0};
+  int m_pyramidLevels{0};
+  int m_depthWidth{0};
+  int m_depthHeight{0};
+  /**Camera of the frame the pyramid was built from. */
+  glm::mat4 m_pyramidViewProjection{1.0f};
+  /**False until a pyramid was built from a frame of the current size. */
+  bool m_pyramidValid{false};
+};
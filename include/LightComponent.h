@@ -12,14 +12,16 @@
  * It also provides methods for updating the component's state within the 
  * game loop.
  */
-class LightComponent : public Component {
+class LightComponent final : public Component {
  public:
+  static constexpr ComponentType StaticType = ComponentType::Light;
+
   /**
      * @brief Constructs a LightComponent for the specified GameObject.
      * 
      * @param owner Pointer to the GameObject that owns this light component.
      */
-  LightComponent(const std::shared_ptr<GameObject>& owner);
+  explicit LightComponent(GameObject* owner);
 
   /**
      * @brief Updates the light component's state, including its position and direction based on owner's transform.
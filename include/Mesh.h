@@ -1,25 +1,59 @@
 #pragma once
 #include <glad/glad.h>
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <glm/glm.hpp>
 #include <string_view>
 #include <vector>
+#include "core/Bounds.h"
+#include "core/MeshBuffer.h"
+#include "core/Span.h"
 
 enum class MeshType : std::uint8_t { Cube, Plane, Capsule, Custom, Count };
 
 constexpr std::array<std::string_view, 4> MeshTypeNames = {"Cube", "Plane",
                                                            "Capsule", "Custom"};
 
+/**
+ * @struct MeshLod
+ * @brief A level of detail: a range of the mesh's index buffer.
+ */
+struct MeshLod {
+  unsigned int firstIndex{0};
+  unsigned int indexCount{0};
+};
+
+/**
+ * @struct MeshInstance
+ * @brief Per-instance data read by basic_instanced.vert from a storage
+ * buffer.
+ *
+ * The normal matrix is the inverse transpose of the model matrix, computed
+ * once per instance instead of once per vertex. Its columns are padded to
+ * vec4, as std430 lays out a mat3.
+ */
+struct MeshInstance {
+  glm::mat4 model;
+  std::array<glm::vec4, 3> normalMatrix;
+};
+
 /**
  * @class Mesh
  * @brief Represents a 3D mesh that can be rendered using OpenGL.
  * 
  * The Mesh class encapsulates the data and methods necessary to create and render 
- * 3D geometries such as cubes and planes. It manages vertex array objects (VAO),
- * vertex buffer objects (VBO), and element buffer objects (EBO).
+ * 3D geometries such as cubes and planes. Its GPU copy is a range of the
+ * shared MeshBuffer, so every mesh can be drawn with one indirect call.
+ * 
+ * Meshes shared through the MeshLibrary are handed out as const: drawing
+ * only fills in the GPU copy, which is a cache of the geometry.
  */
 class Mesh {
  public:
+  /**Most levels of detail a mesh carries, the full mesh included. */
+  static constexpr std::size_t MaxLodCount = 4;
+
   /**
 	* @brief Default constructor for the Mesh class.
 	*/
@@ -28,7 +62,8 @@ class Mesh {
   /**
 	* @brief Destructor for the Mesh class.
 	* 
-	* Cleans up OpenGL resources associated with the mesh.
+	* Returns its ranges of the MeshBuffer, which is safe on any thread, as
+	* the last reference may be released away from the GL thread.
 	*/
   ~Mesh();
 
@@ -42,63 +77,213 @@ class Mesh {
   /**
 	* @brief Creates a cube mesh.
 	* 
-	* This method defines the vertices and indices for a cube and initializes 
-	* the OpenGL buffers accordingly.
+	* This method defines the vertices and indices for a cube. They are
+	* copied into the shared MeshBuffer by the first GetDrawCommand(), on the
+	* thread owning the context.
 	*/
   void CreateCube();
 
   /**
 	* @brief Creates a plane mesh.
 	* 
-	* This method defines the vertices and indices for a plane and initializes 
-	* the OpenGL buffers accordingly.
+	* This method defines the vertices and indices for a plane, copied into
+	* the MeshBuffer by the first GetDrawCommand().
 	*/
   void CreatePlane();
 
+  /**
+	* @brief Creates a capsule mesh with a chain of coarser levels of detail.
+	* 
+	* Each level halves the segments and rings of the previous one, down to
+	* 8 segments and 4 rings; all levels share one vertex buffer.
+	* 
+	* @param radius Radius of the cylinder and of the two hemispheres.
+	* @param height Length of the cylinder.
+	* @param segments Subdivisions around the axis of the finest level.
+	* @param rings Subdivisions of the two hemispheres of the finest level.
+	*/
   void CreateCapsule(float radius, float height, int segments, int rings);
 
   /**
-	* @brief Renders the mesh.
+	* @brief Replaces the geometry with custom data and simplifies it.
+	* 
+	* Coarser levels of detail are generated with SimplifyMesh(), each with
+	* about half the triangles of the previous one, for as long as that
+	* keeps the surface close to the original.
+	* 
+	* @param vertices Interleaved vertices: position, normal, then optional
+	* texture coordinates.
+	* @param indices Triangle list.
+	* @param stride Floats per vertex, 6 or 8.
+	*/
+  void SetGeometry(std::vector<float> vertices,
+                   std::vector<unsigned int> indices, int stride);
+
+  /**
+	* @brief Describes instances of the mesh as an indirect draw command.
+	* 
+	* Copies the geometry into the MeshBuffer first if needed, so it must
+	* run on the GL thread.
 	* 
-	* Binds the appropriate VAO and draws the mesh using the stored indices.
+	* @param lod Level of detail to draw, clamped to the coarsest one.
+	* @param instanceCount Number of instances to draw.
+	* @param[out] command The command, which reads the MeshBuffer.
+	* @return False for a mesh without triangles, which has no command.
 	*/
-  void Draw();
+  bool GetDrawCommand(std::size_t lod, std::uint32_t instanceCount,
+                      DrawElementsIndirectCommand& command) const;
 
   /**
 	* @brief Clears the mesh data.
 	* 
-	* Deletes the VAO, VBO, and EBO from the GPU and clears the vertex and 
-	* index vectors.
+	* Returns the mesh's ranges of the MeshBuffer, so the next upload
+	* allocates new ones, and clears the vertex and index vectors.
 	*/
   void Clear();
 
   /**
-	* @brief Retrieves the VAO associated with the mesh.
+	* @brief Frees the CPU copy of the geometry once it is on the GPU.
+	* 
+	* Bounds, levels of detail and memory figures are kept, so the mesh can
+	* still be culled and drawn; GetVertices(), GetIndices() and
+	* GetLodIndices() return nothing afterwards. Must not run concurrently
+	* with readers of the CPU copy.
 	* 
-	* @return The VAO identifier.
+	* @return False if the mesh is not uploaded yet, in which case nothing
+	* is freed.
+	*/
+  bool ReleaseCpuData();
+
+  /**
+	* @brief Whether the vertex and index data are still held on the CPU.
+	*/
+  [[nodiscard]] bool HasCpuData() const { return !m_vertices.empty(); }
+
+  /**
+	* @brief Whether the geometry is in the MeshBuffer; safe from any thread.
 	*/
-  [[nodiscard]] unsigned int GetVAO() const { return m_VAO; }
+  [[nodiscard]] bool IsUploaded() const {
+    return m_uploaded.load(std::memory_order_acquire);
+  }
+
+  /**
+	* @brief Bytes held by the CPU copy of the geometry.
+	*/
+  [[nodiscard]] std::size_t GetCpuMemoryUsage() const;
+
+  /**
+	* @brief Bytes of the mesh's ranges of the MeshBuffer, 0 until uploaded.
+	*/
+  [[nodiscard]] std::size_t GetGpuMemoryUsage() const;
 
   /**
 	* @brief Retrieves the count of indices used in the mesh.
 	* 
-	* @return The number of indices as an unsigned int.
+	* @return The number of indices of every level of detail together.
 	*/
   [[nodiscard]] unsigned int GetIndexCount() const {
-    return static_cast<unsigned int>(m_indices.size());
+    return m_lods.empty() ? 0
+                          : m_lods.back().firstIndex + m_lods.back().indexCount;
   }
 
   [[nodiscard]] MeshType GetType() const;
 
+  /**
+	* @brief Identifier unique to this mesh, for render sort keys.
+	*/
+  [[nodiscard]] std::uint32_t GetId() const { return m_id; }
+
+  /**
+	* @brief Retrieves the interleaved vertex data, position first.
+	* 
+	* @return GetVertexStride() floats per vertex.
+	*/
+  [[nodiscard]] const std::vector<float>& GetVertices() const {
+    return m_vertices;
+  }
+
+  [[nodiscard]] const std::vector<unsigned int>& GetIndices() const {
+    return m_indices;
+  }
+
+  [[nodiscard]] int GetVertexStride() const { return m_vertexStride; }
+
+  /**
+	* @brief Number of vertices, kept after ReleaseCpuData().
+	*/
+  [[nodiscard]] std::size_t GetVertexCount() const { return m_vertexCount; }
+
+  /**
+	* @brief Number of levels of detail, 0 for an empty mesh.
+	*/
+  [[nodiscard]] std::size_t GetLodCount() const { return m_lods.size(); }
+
+  [[nodiscard]] const MeshLod& GetLod(std::size_t lod) const {
+    return m_lods[lod];
+  }
+
+  /**
+	* @brief Retrieves the triangle list of one level of detail.
+	* 
+	* Requires the CPU copy of the geometry.
+	*/
+  [[nodiscard]] Span<const unsigned int> GetLodIndices(std::size_t lod) const {
+    return {m_indices.data() + m_lods[lod].firstIndex, m_lods[lod].indexCount};
+  }
+
+  /**
+	* @brief Retrieves the bounds of the vertex positions, in model space.
+	*/
+  [[nodiscard]] const Aabb& GetBounds() const { return m_bounds; }
+
+  /**
+	* @brief Retrieves a sphere enclosing the vertex positions, in model space.
+	* 
+	* Centered on the bounds, so it is cheap to transform and cull; its radius
+	* is 0 for a mesh without vertices.
+	*/
+  [[nodiscard]] const Sphere& GetBoundingSphere() const {
+    return m_boundingSphere;
+  }
+
  private:
-  unsigned int m_VAO; /**Vertex Array Object identifier. */
-  unsigned int m_VBO; /**Vertex Buffer Object identifier. */
-  unsigned int m_EBO; /**Element Buffer Object identifier. */
+  /** Copies the vertex and index data into the MeshBuffer. */
+  void Upload() const;
+
+  /** Appends the vertices and triangles of one capsule level of detail. */
+  void AppendCapsule(float radius, float height, int segments, int rings);
+
+  /** Records indices [first, end) as the next level of detail. */
+  void AddLod(std::size_t firstIndex);
+
+  /** Recomputes m_bounds, m_boundingSphere and m_vertexCount from the
+   * vertex data. */
+  void ComputeBounds();
+
+  /** Returns the mesh's ranges to the MeshBuffer. */
+  void ReleaseBuffers();
+
+  /**Ranges of the MeshBuffer holding the geometry. */
+  mutable MeshAllocation m_allocation;
+  /**Set by Upload() once the buffers hold the geometry. */
+  mutable std::atomic<bool> m_uploaded{false};
 
   /**Array of vertex data (positions, normals, etc.). */
   std::vector<float> m_vertices;
   /**Array of indices for indexed drawing. */
   std::vector<unsigned int> m_indices;
+  /**Index ranges of the levels of detail, finest first. */
+  std::vector<MeshLod> m_lods;
+  /**Floats per vertex: position and normal, plus texture coordinates. */
+  int m_vertexStride{6};
+  /**Vertices in m_vertices, or uploaded once the CPU copy is released. */
+  std::size_t m_vertexCount{0};
+  /**Bounds of the vertex positions. */
+  Aabb m_bounds;
+  /**Sphere around m_bounds' center enclosing every vertex. */
+  Sphere m_boundingSphere;
 
   MeshType m_meshType;
+  /**Assigned from a counter on construction. */
+  std::uint32_t m_id;
 };
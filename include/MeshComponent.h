@@ -1,6 +1,6 @@
 #pragma once
 #include "Component.h"
-#include "Mesh.h"
+#include "MeshLibrary.h"
 
 /**
  * @class MeshComponent
@@ -9,28 +9,35 @@
  * The MeshComponent class is responsible for holding and rendering 
  * a Mesh instance associated with a GameObject. It inherits from 
  * the base Component class.
+ * 
+ * Meshes are shared with other components, usually through the
+ * MeshLibrary, so the component never modifies them.
  */
-class MeshComponent : public Component {
+class MeshComponent final : public Component {
  public:
+  static constexpr ComponentType StaticType = ComponentType::Mesh;
+  /** Meshes are drawn by the Renderer from a snapshot, not per component. */
+  static constexpr bool HasUpdate = false;
+  static constexpr bool HasBounds = true;
+
   /**
 	* @brief Constructs a MeshComponent with a specified owner and mesh.
 	* 
 	* @param owner The GameObject that owns this component.
 	* @param mesh The mesh to be associated with this component.
 	*/
-  MeshComponent(std::shared_ptr<GameObject> owner, std::shared_ptr<Mesh> mesh)
-      : Component(owner), m_mesh(mesh) {}
+  MeshComponent(GameObject* owner, std::shared_ptr<const Mesh> mesh)
+      : Component(owner), m_mesh(std::move(mesh)) {}
 
   /**
 	* @brief Default constructor for the MeshComponent.
 	* 
-	* Initializes a MeshComponent with a default cube mesh.
+	* Initializes a MeshComponent with the library's cube mesh.
 	* 
 	* @param owner The GameObject that owns this component.
 	*/
-  MeshComponent(std::shared_ptr<GameObject> owner) : Component(owner) {
-    m_mesh = std::make_shared<Mesh>(MeshType::Cube);
-  }
+  explicit MeshComponent(GameObject* owner)
+      : Component(owner), m_mesh(MeshLibrary::Get(MeshType::Cube)) {}
 
   /**
 	* @brief Renders the mesh associated with the component.
@@ -49,19 +56,21 @@ class MeshComponent : public Component {
 	* 
 	* @param deltaTime The time elapsed since the last update.
 	*/
-  void Update(float deltaTime) override {}
+  void Update(float /*deltaTime*/) override {}
 
   /**
 	* @brief Sets the mesh associated with the component.
 	* 
-	* @param mesh The new mesh to be associated with this component.
+	* @param mesh The new mesh to be associated with this component. The
+	* owner's bounds in the scene's spatial index follow at the next update.
 	*/
-  void SetMesh(const std::shared_ptr<Mesh>& mesh);
+  void SetMesh(const std::shared_ptr<const Mesh>& mesh);
 
   /**
-	* @brief Clears the current mesh's data.
+	* @brief Detaches the current mesh from the component.
 	* 
-	* This method releases the resources held by the current mesh.
+	* Only this component's reference is dropped; the mesh is released once
+	* no other component or the MeshLibrary holds it.
 	*/
   void ClearMesh();
 
@@ -70,10 +79,16 @@ class MeshComponent : public Component {
 	* 
 	* @return A pointer to the associated mesh.
 	*/
-  std::shared_ptr<Mesh> GetMesh();
+  std::shared_ptr<const Mesh> GetMesh();
 
+  /**
+	* @brief Type of the current mesh, MeshType::Custom without one.
+	*/
   [[nodiscard]] MeshType GetMeshType() const;
 
  private:
-  std::shared_ptr<Mesh> m_mesh;
+  /** Has the owner's spatial proxy refit at the next scene update. */
+  void MarkBoundsDirty();
+
+  std::shared_ptr<const Mesh> m_mesh;
 };
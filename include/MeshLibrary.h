@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Mesh.h"
+
+/**
+ * @class MeshLibrary
+ * @brief Shares one immutable Mesh between every user of the same geometry.
+ *
+ * Meshes are keyed by primitive type and parameters, or by asset path, so a
+ * scene full of cubes holds a single cube: one copy of the vertices and one
+ * set of GPU buffers. Handles are const; building the geometry is the
+ * library's job.
+ *
+ * The library keeps its own reference to every mesh, so geometry survives
+ * while no object uses it; ReleaseUnused() drops those.
+ *
+ * Called from the main thread. Meshes may still be drawn by the render
+ * thread, which only reads them.
+ */
+class MeshLibrary {
+ public:
+  /**
+   * @struct MeshStats
+   * @brief Memory held by one unique mesh.
+   */
+  struct MeshStats {
+    /**Points into the library; valid until the mesh is dropped. */
+    const std::string* key{nullptr};
+    /**Handles held outside the library. */
+    long users{0};
+    std::size_t vertexCount{0};
+    std::size_t indexCount{0};
+    std::size_t cpuBytes{0};
+    std::size_t gpuBytes{0};
+  };
+
+  /**Fills an empty mesh, typically with Mesh::SetGeometry(). */
+  using Builder = std::function<void(Mesh&)>;
+
+  MeshLibrary() = delete;
+
+  /**
+   * @brief Retrieves the shared mesh of a primitive type.
+   *
+   * @return nullptr for MeshType::Custom, which has no geometry of its own.
+   */
+  static std::shared_ptr<const Mesh> Get(MeshType type);
+
+  /**
+   * @brief Retrieves a shared capsule, see Mesh::CreateCapsule().
+   */
+  static std::shared_ptr<const Mesh> GetCapsule(float radius, float height,
+                                                int segments, int rings);
+
+  /**
+   * @brief Retrieves the mesh of an asset, building it on first use.
+   *
+   * Unlike primitives, asset meshes give up their CPU copy once uploaded;
+   * see ReleaseUploadedCpuData().
+   *
+   * @param path Asset path, the key of the mesh.
+   * @param build Called once, without the library's lock held.
+   */
+  static std::shared_ptr<const Mesh> Get(const std::string& path,
+                                         const Builder& build);
+
+  /**
+   * @brief Retrieves a mesh that is already in the library.
+   *
+   * @return nullptr if no mesh has this key.
+   */
+  static std::shared_ptr<const Mesh> Find(const std::string& key);
+
+  /**
+   * @brief Frees the CPU copy of every uploaded mesh that does not need it.
+   *
+   * Primitives keep theirs: they are small and the renderer rasterizes cubes
+   * and planes as occluders. Called once per frame by the engine, on the
+   * thread that extracts frames.
+   */
+  static void ReleaseUploadedCpuData();
+
+  /**
+   * @brief Drops the meshes no handle refers to anymore.
+   *
+   * @return The number of meshes dropped.
+   */
+  static std::size_t ReleaseUnused();
+
+  /**
+   * @brief Memory figures of every mesh, sorted by key.
+   *
+   * Keys are not copied, and reusing `stats` from one call to the next
+   * keeps its capacity, so a panel refreshed every frame allocates nothing.
+   *
+   * @param stats Cleared, then filled with one entry per mesh.
+   */
+  static void GetStats(std::vector<MeshStats>& stats);
+
+  /**
+   * @brief Drops every mesh; handles held elsewhere stay valid.
+   *
+   * Called on shutdown, while the GLDeletionQueue can still take the
+   * buffers.
+   */
+  static void Clear();
+};
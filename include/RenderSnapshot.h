@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "GpuCuller.h"
+#include "Light.h"
+#include "Mesh.h"
+#include "imgui.h"
+
+/**
+ * @struct RenderItem
+ * @brief A mesh to draw, its interpolated world matrix and level of detail.
+ */
+struct RenderItem {
+  /**Keeps the mesh alive until the frame is submitted. */
+  std::shared_ptr<const Mesh> mesh;
+  glm::mat4 model;
+  /**Level of detail to draw. */
+  std::uint32_t lod{0};
+};
+
+/**
+ * @struct RenderBatch
+ * @brief Consecutive instances drawn by one indirect draw command.
+ */
+struct RenderBatch {
+  /**Kept alive by the snapshot's items. */
+  const Mesh* mesh;
+  /**Index in the renderer's table of scene shaders. */
+  std::uint32_t shader;
+  std::uint32_t lod;
+  /**Range of RenderSnapshot::instances. */
+  std::uint32_t firstInstance;
+  std::uint32_t instanceCount;
+};
+
+/**
+ * @class RenderSnapshot
+ * @brief Everything needed to draw one frame, extracted from the scene.
+ *
+ * The simulation thread fills a snapshot at the end of its frame; from then
+ * on the snapshot is read-only and the render thread submits it while the
+ * next frame is simulated. Nothing in it points back into the scene, so the
+ * scene may change freely meanwhile.
+ *
+ * Snapshots are reused: Clear() keeps the storage of every array, so a
+ * steady-state frame does not allocate.
+ */
+class RenderSnapshot {
+ public:
+  RenderSnapshot() = default;
+  ~RenderSnapshot();
+
+  RenderSnapshot(const RenderSnapshot&) = delete;
+  RenderSnapshot& operator=(const RenderSnapshot&) = delete;
+  RenderSnapshot(RenderSnapshot&&) = delete;
+  RenderSnapshot& operator=(RenderSnapshot&&) = delete;
+
+  /**
+   * @brief Empties the snapshot, keeping its storage.
+   */
+  void Clear();
+
+  /**
+   * @brief Copies the output of ImGui::Render().
+   *
+   * ImGui reuses its draw lists on the next NewFrame(), which the simulation
+   * thread calls before this snapshot is submitted, so the vertex, index and
+   * command buffers are copied into draw lists owned by the snapshot.
+   *
+   * @param drawData The draw data of the frame, or nullptr for no UI.
+   */
+  void CaptureUi(const ImDrawData* drawData);
+
+  /**
+   * @brief The captured UI, or nullptr if CaptureUi() was not called.
+   */
+  [[nodiscard]] const ImDrawData* GetUiDrawData() const {
+    return m_uiDrawData.Valid ? &m_uiDrawData : nullptr;
+  }
+
+  /**Items left after culling, in extraction order. */
+  std::vector<RenderItem> items;
+  /**Per-instance attributes of the items, in render queue order. */
+  std::vector<MeshInstance> instances;
+  /**Runs of instances sharing every state but depth, in draw order. */
+  std::vector<RenderBatch> batches;
+  /**World boxes of the instances, in instance order, when culled on the
+   * GPU; the draw of each is its batch index. */
+  std::vector<InstanceBounds> instanceBounds;
+  /**True if the items were left for GpuCuller instead of culled on the
+   * CPU. */
+  bool gpuCulling{false};
+  std::vector<Light> lights;
+
+  glm::mat4 view{1.0f};
+  glm::mat4 projection{1.0f};
+  /**Window size in screen coordinates. */
+  int screenWidth{0};
+  int screenHeight{0};
+  /**Size of the editor viewport, which the scene is rendered into. */
+  ImVec2 viewportSize{0.0f, 0.0f};
+
+  /**Mesh items dropped by frustum culling; items.size() were kept. */
+  std::size_t culledItems{0};
+  /**Items that passed frustum culling but were hidden by occluders. */
+  std::size_t occludedItems{0};
+
+  double fps{0.0};
+  /**Heap allocations made during the previous frame. */
+  std::uint64_t frameAllocations{0};
+
+ private:
+  ImDrawData m_uiDrawData;
+  /**Draw lists owned by the snapshot; grows to the most lists ever seen. */
+  std::vector<ImDrawList*> m_uiLists;
+};
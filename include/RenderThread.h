@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "RenderSnapshot.h"
+#include "Renderer.h"
+
+/**
+ * @class RenderThread
+ * @brief Submits render snapshots on a dedicated thread owning the GL context.
+ *
+ * The main thread fills one of two snapshots while the render thread draws
+ * the other, so frame N is simulated while frame N-1 is submitted. The main
+ * thread is never more than one frame ahead: Publish() waits for the previous
+ * snapshot to be drawn before handing over the new one.
+ */
+class RenderThread {
+ public:
+  explicit RenderThread(std::shared_ptr<Renderer> renderer);
+
+  /**
+   * @brief Stops the thread if it is still running.
+   */
+  ~RenderThread();
+
+  RenderThread(const RenderThread&) = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+  RenderThread(RenderThread&&) = delete;
+  RenderThread& operator=(RenderThread&&) = delete;
+
+  /**
+   * @brief Moves the OpenGL context from the calling thread to the render
+   * thread and starts it.
+   */
+  void Start();
+
+  /**
+   * @brief Draws the last published snapshot, joins the thread and makes the
+   * OpenGL context current on the calling thread again.
+   */
+  void Stop();
+
+  /**
+   * @brief The snapshot the main thread may fill for the next frame.
+   *
+   * Not being read by the render thread until the next Publish().
+   */
+  [[nodiscard]] RenderSnapshot& GetWriteSnapshot() {
+    return m_snapshots[m_writeIndex];
+  }
+
+  /**
+   * @brief Hands the write snapshot over to the render thread.
+   *
+   * Blocks until the previously published snapshot has been submitted.
+   */
+  void Publish();
+
+ private:
+  /** Body of the render thread. */
+  void Run();
+
+  std::shared_ptr<Renderer> m_renderer;
+  std::array<RenderSnapshot, 2> m_snapshots;
+  /**Snapshot owned by the main thread. */
+  std::size_t m_writeIndex{0};
+  /**Snapshot handed to the render thread. */
+  std::size_t m_readIndex{0};
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  /**Signaled when a snapshot is published or the thread must stop. */
+  std::condition_variable m_published;
+  /**Signaled when the render thread has submitted a snapshot. */
+  std::condition_variable m_submitted;
+  /**A published snapshot has not been submitted yet. */
+  bool m_pending{false};
+  bool m_stopRequested{false};
+};
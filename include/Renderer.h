@@ -1,5 +1,6 @@
 #pragma once
 #include <glad/glad.h>
+#include <array>
 #include <GLFW/glfw3.h>
 #include "Shader.h"
 #include "Mesh.h"
@@ -11,6 +12,12 @@
 #include "ShaderManager.h"
 #include "TextRenderer.h"
 #include "Editor.h"
+#include "GpuCuller.h"
+#include "RenderSnapshot.h"
+#include "core/FrustumCulling.h"
+#include "core/OcclusionBuffer.h"
+#include "core/RenderQueue.h"
+#include "core/StreamingBuffer.h"
 
 /**
  * @class Renderer
@@ -18,6 +25,11 @@
  * 
  * The Renderer class is responsible for initializing OpenGL, creating a 
  * window with GLFW, managing shaders, and rendering objects in a scene.
+ * 
+ * A frame is drawn in two halves: BuildSnapshot() runs on the simulation
+ * thread and copies what the frame needs out of the scene, Submit() issues
+ * the OpenGL calls from that snapshot alone, on whichever thread owns the
+ * context.
  */
 class Renderer {
  public:
@@ -51,11 +63,41 @@ class Renderer {
   bool ShouldClose();
 
   /**
-	* @brief Renders the specified scene.
+	* @brief Renders the specified scene on the calling thread.
+	* 
+	* Equivalent to BuildSnapshot() followed by Submit().
+	* 
+	* @param scene The scene to render.
+	* @param deltaTime Real time elapsed since the last frame, in seconds.
+	* @param interpolation Position of the frame between the last two
+	* simulation steps, in [0, 1).
+	*/
+  void Render(const std::shared_ptr<Scene>& scene, float deltaTime,
+              float interpolation);
+
+  /**
+	* @brief Polls input, moves the camera, builds the editor UI and extracts
+	* the frame into a snapshot.
+	* 
+	* Runs on the main thread, since GLFW only delivers events there. Makes
+	* no OpenGL calls.
 	* 
 	* @param scene The scene to render.
+	* @param deltaTime Real time elapsed since the last frame, in seconds.
+	* @param interpolation Position of the frame between the last two
+	* simulation steps, in [0, 1).
+	* @param snapshot Receives the frame; its previous content is discarded.
 	*/
-  void Render(const std::shared_ptr<Scene>& scene);
+  void BuildSnapshot(const std::shared_ptr<Scene>& scene, float deltaTime,
+                     float interpolation, RenderSnapshot& snapshot);
+
+  /**
+	* @brief Draws a snapshot and presents it.
+	* 
+	* Must run on the thread whose OpenGL context is current; reads nothing
+	* but the snapshot and the renderer's GPU resources.
+	*/
+  void Submit(const RenderSnapshot& snapshot);
 
   /**
 	* @brief Sets the camera for the Renderer.
@@ -77,10 +119,59 @@ class Renderer {
   void CalculateFPS();
 
   void SetEditor(std::shared_ptr<Editor> editor) { m_editor = editor; }
+  /**
+	* @brief Sets the job system the occlusion pass runs on.
+	* 
+	* @param jobSystem The engine's job system, or nullptr to cull serially.
+	*/
+  void SetJobSystem(std::shared_ptr<JobSystem> jobSystem) {
+    m_jobSystem = std::move(jobSystem);
+  }
+  /**
+	* @brief Shifts every level of detail selection.
+	* 
+	* @param bias Each unit halves the screen size objects are judged by, so
+	* positive values pick coarser levels and negative ones finer levels.
+	*/
+  void SetLodBias(float bias) { m_lodBias = bias; }
+  [[nodiscard]] float GetLodBias() const { return m_lodBias; }
 
-  [[nodiscard]] GLFWwindow* GetWindow() const { return m_window; }
+  /**
+	* @brief Chooses between culling on the GPU, the default, and on the CPU.
+	* 
+	* Has no effect where the culling compute shaders could not be built.
+	*/
+  void SetGpuCulling(bool enabled) { m_gpuCullingEnabled = enabled; }
+  /**
+	* @brief Whether the next snapshots are culled on the GPU.
+	*/
+  [[nodiscard]] bool IsGpuCulling() const {
+    return m_gpuCullingEnabled && IsGpuCullingAvailable();
+  }
+  /**
+	* @brief Whether the culling compute shaders were built.
+	*/
+  [[nodiscard]] bool IsGpuCullingAvailable() const {
+    return m_gpuCuller != nullptr && m_gpuCuller->IsAvailable();
+  }
 
-  void UpdateLights(const std::shared_ptr<Scene>& scene);
+  /**
+	* @brief Heap allocations made during the previous frame.
+	*/
+  [[nodiscard]] std::uint64_t GetFrameAllocations() const {
+    return m_frameAllocations;
+  }
+
+  /**
+	* @brief Draws and state changes of the scene pass of the last frame.
+	* 
+	* Written by Submit(), so only meaningful on the thread that submits.
+	*/
+  [[nodiscard]] const RenderStats& GetRenderStats() const {
+    return m_renderStats;
+  }
+
+  [[nodiscard]] GLFWwindow* GetWindow() const { return m_window; }
 
  private:
   GLFWwindow* m_window; /**Pointer to the GLFW window. */
@@ -96,16 +187,146 @@ class Renderer {
   std::shared_ptr<Editor> m_editor;
 
   std::vector<Light> m_lights; /**Vector of lights in the scene. */
+  /**Most lights the default shader accepts, the size of its light array. */
+  std::uint32_t m_maxLights{0};
+  /**Room for "lights[<any uint32>].intensity" and its terminator. */
+  static constexpr std::size_t LightUniformNameSize = 48;
+  /**Snapshot reused by Render() when no render thread is running. */
+  RenderSnapshot m_snapshot;
+  /**Bytes of StreamingBuffer each frame starts with. */
+  static constexpr std::size_t StreamingRegionSize = 8 << 20;
+  /**Storage buffer binding of the frame's MeshInstance records, read by
+   * basic_instanced.vert. The indices of the instances to draw, grouped by
+   * command, reach it as MeshBuffer's per-instance attribute. */
+  static constexpr GLuint InstanceBinding = 1;
+  /**
+	* @struct DrawRun
+	* @brief Consecutive indirect commands drawn with the same shader.
+	*/
+  struct DrawRun {
+    std::uint32_t shader;
+    std::uint32_t firstCommand;
+    std::uint32_t commandCount;
+  };
+  /**Scratch arrays of Submit(), reused every frame. */
+  std::vector<DrawElementsIndirectCommand> m_drawCommands;
+  std::vector<DrawRun> m_drawRuns;
+  /**Culls on the GPU when IsGpuCulling(). */
+  std::unique_ptr<GpuCuller> m_gpuCuller;
+  bool m_gpuCullingEnabled{true};
+  /**Shaders the scene pass draws with, indexed by the sort key's shader
+   * field. */
+  static constexpr std::array<const char*, 1> SceneShaders{"instanced"};
+  /**Pass field of the sort key of opaque geometry, the only pass so far. */
+  static constexpr std::uint32_t OpaquePass = 0;
+  static constexpr float NearPlane = 0.1f;
+  static constexpr float FarPlane = 100.0f;
+  /**Sort keys of the visible items, reused every frame. */
+  RenderQueue m_renderQueue;
+  /**Draws and state changes of the last scene pass. */
+  RenderStats m_renderStats;
+  /**
+	* @struct CullBatch
+	* @brief Scratch SoA bounding spheres of the culled items, reused every
+	* frame.
+	*/
+  struct CullBatch {
+    std::vector<float> centerX, centerY, centerZ, radius;
+    /**World boxes of the items that passed the frustum test. */
+    std::vector<Aabb> bounds;
+    std::vector<std::uint8_t> visible;
+  };
+  CullBatch m_cullBatch;
+  /**Most occluders rasterized per frame. */
+  static constexpr std::size_t MaxOccluders = 16;
+  /**Smallest bounding radius over view depth of an occluder. */
+  static constexpr float MinOccluderSize = 0.15f;
+  /**Boxes tested against the occlusion buffer per job. */
+  static constexpr std::size_t OcclusionTestBatchSize = 256;
+  OcclusionBuffer m_occlusionBuffer;
+  /**Scratch (screen size, item index) of the frame's occluders. */
+  std::vector<std::pair<float, std::uint32_t>> m_occluders;
+  /**Workers for the occlusion pass, or nullptr to run it serially. */
+  std::shared_ptr<JobSystem> m_jobSystem;
+  /**Smallest screen size, as a fraction of half the viewport height, of
+   * each level of detail but the coarsest. */
+  static constexpr std::array<float, Mesh::MaxLodCount - 1> LodScreenSizes{
+      0.4f, 0.15f, 0.05f};
+  /**Relative margin a size must cross before an object changes level. */
+  static constexpr float LodHysteresis = 0.1f;
+  /**Stored in m_lodHistory for objects never drawn. */
+  static constexpr std::uint8_t NoLod = 0xFF;
+  float m_lodBias{0.0f};
+  /**Last level of detail drawn for each entity slot. */
+  std::vector<std::uint8_t> m_lodHistory;
 
   /**
-	* @brief Renders a single GameObject.
+	* @brief Copies the light components of the scene into the snapshot.
+	*/
+  void ExtractLights(const std::shared_ptr<Scene>& scene,
+                     RenderSnapshot& snapshot) const;
+
+  /**
+	* @brief Picks the level of detail of an object from its size on screen.
+	* 
+	* @param mesh The object's mesh.
+	* @param bounds World bounding sphere of the object.
+	* @param entitySlot Index of the object's handle, under which its last
+	* level is remembered.
+	* @param view The camera's view matrix.
+	* @param projectionScale 1 / tan(fovy / 2) of the projection.
+	* @return The level to draw.
+	*/
+  std::uint32_t SelectLod(const Mesh& mesh, const Sphere& bounds,
+                          std::uint32_t entitySlot, const glm::mat4& view,
+                          float projectionScale);
+  /**
+	* @brief Drops the snapshot items outside the camera frustum.
+	* 
+	* Bounding spheres, extracted with the items, are tested four at a time
+	* first, then the boxes of the items that pass.
+	* 
+	* @param frustum Frustum of the snapshot's projection * view.
+	* @param snapshot Snapshot whose items are filtered in place.
+	*/
+  void CullItems(const Frustum& frustum, RenderSnapshot& snapshot);
+  /**
+	* @brief Drops the snapshot items hidden behind large occluders.
+	* 
+	* The biggest cubes and planes on screen are rasterized into
+	* m_occlusionBuffer, then the boxes left by CullItems() are tested
+	* against it on the job system.
+	* 
+	* @param viewProjection The snapshot's projection * view.
+	* @param snapshot Snapshot whose items are filtered in place.
+	*/
+  void CullOccludedItems(const glm::mat4& viewProjection,
+                         RenderSnapshot& snapshot);
+  /**
+	* @brief Orders the snapshot items through the render queue, fills the
+	* per-instance attributes and groups each run into a batch.
 	* 
-	* @param object The GameObject to render.
+	* Items are sorted by pass, shader, material, mesh and level of detail,
+	* then front to back; runs equal in everything but depth become batches.
+	* Snapshots culled on the GPU also get the world box of every instance.
+	*/
+  void BuildBatches(RenderSnapshot& snapshot);
+  /**
+	* @brief Uploads the lights of a snapshot to the bound scene shader.
+	*/
+  void SubmitLights(const std::vector<Light>& lights) const;
+
+  /**
+	* @brief Samples the heap allocation counter once per frame.
 	*/
-  void RenderObject(const std::shared_ptr<GameObject>& object) const;
+  void CountFrameAllocations();
 
   double m_lastTime;  /**Last recorded time for FPS calculations. */
   int m_nbFrames;     /**Number of frames rendered in the last second. */
   double m_fps;       /**Current frames per second. */
   double m_frameTime; /**Time taken to render the last frame. */
+  /**Allocation counter when the previous frame started. */
+  std::uint64_t m_lastAllocationCount{0};
+  /**Heap allocations made during the previous frame. */
+  std::uint64_t m_frameAllocations{0};
 };
@@ -1,9 +1,29 @@
 #pragma once
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
 #include "GameObject.h"
+#include "core/AabbTree.h"
+#include "core/ComponentView.h"
+#include "core/EntityCommandBuffer.h"
+#include "core/EntityTable.h"
+#include "core/Span.h"
+#include "core/TransformHierarchy.h"
+
+/**
+ * @struct SceneSnapshot
+ * @brief An immutable copy of a scene's object list, tagged with its version.
+ */
+struct SceneSnapshot {
+  /**Scene version the copy was taken at. */
+  std::uint64_t version{0};
+  /**Handles of the objects of the scene at that version. */
+  std::shared_ptr<const std::vector<EntityHandle>> objects;
+};
 
 /**
  * @class Scene
@@ -12,28 +32,43 @@
  * The Scene class handles the storage, updating, and rendering of GameObjects 
  * within a specific scene. It allows for adding, removing, and iterating over 
  * the game objects to facilitate game logic and rendering.
+ *
+ * Components of the scene's objects live in the scene's ArchetypeStorage, so
+ * GameObjects must be created through CreateGameObject(). The scene owns its
+ * objects through an EntityTable; keep EntityHandles rather than pointers
+ * to refer to them across frames.
+ *
+ * Code that runs during Update() or while iterating the scene must not change
+ * it directly; it records the change in GetCommandBuffer() instead.
  */
 class Scene {
  public:
   /**
 	 * @brief Constructs a new Scene with a default name.
 	 */
-  Scene() : m_name("NewScene") {}
+  Scene()
+      : m_name("NewScene"), m_storage(std::make_shared<ArchetypeStorage>()) {}
 
   /**
 	 * @brief Constructs a new Scene with a specified name.
 	 * 
 	 * @param sceneName The name of the scene.
 	 */
-  Scene(const std::string& sceneName) : m_name(sceneName) {}
+  Scene(const std::string& sceneName)
+      : m_name(sceneName), m_storage(std::make_shared<ArchetypeStorage>()) {}
 
   /**
 	 * @brief Destructs the Scene and cleans up resources.
 	 * 
-	 * Deletes all GameObjects contained in the scene.
+	 * The EntityTable destroys every GameObject along with its components.
 	 */
   ~Scene() = default;
 
+  Scene(const Scene&) = delete;
+  Scene& operator=(const Scene&) = delete;
+  Scene(Scene&&) = delete;
+  Scene& operator=(Scene&&) = delete;
+
   bool IsNameTaken(const std::string& name) const {
     return m_objectsNames.find(name) != m_objectsNames.end();
   }
@@ -50,68 +85,302 @@ class Scene {
   }
 
   /**
-	 * @brief Gets the list of GameObjects in the scene.
+	 * @brief Gets the list of GameObjects in the scene without copying it.
+	 * 
+	 * The view is invalidated by CreateGameObject() and RemoveGameObject(), so
+	 * callers that change the scene while iterating must defer the change or
+	 * use GetSnapshot().
 	 * 
-	 * @return A vector of pointers to GameObjects in the scene.
+	 * @return A non-owning view of the GameObjects in the scene.
 	 */
-  std::vector<std::shared_ptr<GameObject>> GetGameObjects() {
+  [[nodiscard]] Span<GameObject* const> GetGameObjects() const {
     return m_gameObjects;
   }
 
   /**
-	 * @brief Adds a GameObject to the scene.
+	 * @brief Resolves a handle to one of the scene's GameObjects.
+	 * 
+	 * @param handle A handle obtained from GameObject::GetHandle().
+	 * @return The object, or nullptr if it was removed.
+	 */
+  [[nodiscard]] GameObject* GetGameObject(EntityHandle handle) const {
+    return m_entities.Get(handle);
+  }
+
+  /**
+	 * @brief Gets the version of the object list.
+	 * 
+	 * Incremented every time an object is added to or removed from the scene.
+	 */
+  [[nodiscard]] std::uint64_t GetVersion() const { return m_version; }
+
+  /**
+	 * @brief Gets the usage of the pool the scene's GameObjects live in.
+	 * 
+	 * Per component statistics are available from
+	 * ArchetypeStorage::GetComponentStats().
+	 */
+  [[nodiscard]] const PoolStats& GetGameObjectStats() const {
+    return m_entities.GetStats();
+  }
+
+  /**
+	 * @brief Gets a stable copy of the object list.
+	 * 
+	 * The copy is shared between callers and only rebuilt after the scene
+	 * changed, so asking for a snapshot every frame is cheap. It holds
+	 * handles, which resolve to nullptr once their object is removed.
+	 * 
+	 * @return The snapshot matching the current version.
+	 */
+  SceneSnapshot GetSnapshot() {
+    if (m_snapshot.objects == nullptr || m_snapshot.version != m_version) {
+      m_snapshot.version = m_version;
+      auto handles = std::make_shared<std::vector<EntityHandle>>();
+      handles->reserve(m_gameObjects.size());
+
+      for (const GameObject* gameObject : m_gameObjects) {
+        handles->push_back(gameObject->GetHandle());
+      }
+
+      m_snapshot.objects = std::move(handles);
+    }
+
+    return m_snapshot;
+  }
+
+  /**
+	 * @brief Creates a GameObject stored in this scene and adds it to the scene.
+	 * 
+	 * The object is initialized, so it already has a TransformComponent.
 	 * 
-	 * @param gameObject Pointer to the GameObject to be added.
+	 * @param name The name of the new GameObject.
+	 * @return Pointer to the new GameObject, owned by the scene.
 	 */
-  void AddGameObject(std::shared_ptr<GameObject> gameObject) {
-    m_gameObjects.push_back(gameObject);
-    m_objectsNames.insert(gameObject->GetName());
+  GameObject* CreateGameObject(const std::string& name) {
+    GameObject& gameObject = m_entities.Create(name, m_storage);
+    gameObject.Initialize();
+    m_hierarchy.Add(gameObject);
+
+    m_gameObjects.push_back(&gameObject);
+    m_objectsNames.insert(gameObject.GetName());
+    ++m_version;
+
+    return &gameObject;
   }
 
   /**
 	 * @brief Removes a GameObject from the scene.
 	 * 
-	 * @param gameObject Pointer to the GameObject to be removed.
+	 * The GameObject and its components are destroyed, and every handle to it
+	 * becomes stale. Its children are attached to its parent.
+	 * 
+	 * @param handle Handle of the GameObject to be removed.
+	 * @return false if the handle was already stale.
+	 */
+  bool RemoveGameObject(EntityHandle handle) {
+    return RemoveGameObjects(Span<const EntityHandle>(&handle, 1)) != 0;
+  }
+
+  /**
+	 * @brief Removes several GameObjects at once.
+	 * 
+	 * The object list and the hierarchy are compacted once for the whole
+	 * batch, instead of once per object.
+	 * 
+	 * @param handles Handles of the GameObjects to remove; stale and repeated
+	 * handles are ignored.
+	 * @return The number of objects removed.
+	 */
+  std::size_t RemoveGameObjects(Span<const EntityHandle> handles) {
+    std::vector<GameObject*>& removed = m_removedObjects;
+    removed.clear();
+
+    for (EntityHandle handle : handles) {
+      if (GameObject* gameObject = m_entities.Get(handle)) {
+        removed.push_back(gameObject);
+      }
+    }
+
+    if (removed.empty()) {
+      return 0;
+    }
+
+    std::sort(removed.begin(), removed.end(), std::less<>());
+    removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+
+    m_gameObjects.erase(
+        std::remove_if(m_gameObjects.begin(), m_gameObjects.end(),
+                       [&removed](GameObject* gameObject) {
+                         return std::binary_search(removed.begin(),
+                                                   removed.end(), gameObject,
+                                                   std::less<>());
+                       }),
+        m_gameObjects.end());
+    m_hierarchy.Remove(removed);
+
+    for (GameObject* gameObject : removed) {
+      std::uint32_t slot = gameObject->GetHandle().index;
+      if (slot < m_spatialProxies.size() &&
+          m_spatialProxies[slot] != AabbTree::NullNode) {
+        m_spatialIndex.DestroyProxy(m_spatialProxies[slot]);
+        m_spatialProxies[slot] = AabbTree::NullNode;
+      }
+
+      m_objectsNames.erase(gameObject->GetName());
+      m_entities.Destroy(gameObject->GetHandle());
+    }
+    ++m_version;
+
+    return removed.size();
+  }
+
+  /**
+	 * @brief Reserves room for `count` more GameObjects.
+	 */
+  void ReserveGameObjects(std::size_t count) {
+    m_gameObjects.reserve(m_gameObjects.size() + count);
+    m_hierarchy.Reserve(m_gameObjects.size() + count);
+  }
+
+  /**
+	 * @brief Gets the queue of deferred changes to the scene.
+	 * 
+	 * Safe to record into from any thread; the commands are applied at the
+	 * start of the next Update().
+	 * 
+	 * @return The scene's command buffer.
+	 */
+  EntityCommandBuffer& GetCommandBuffer() { return m_commands; }
+
+  /**
+	 * @brief Attaches a GameObject to a parent in the transform hierarchy.
+	 * 
+	 * @param child The object to attach, with its own children.
+	 * @param parent The new parent, or a null handle to detach `child`.
+	 * @return false if a handle is stale or `parent` is `child` or one of its
+	 * descendants.
 	 */
-  void RemoveGameObject(std::shared_ptr<GameObject> gameObject) {
-    auto it = std::find(m_gameObjects.begin(), m_gameObjects.end(), gameObject);
+  bool SetParent(EntityHandle child, EntityHandle parent) {
+    GameObject* childObject = m_entities.Get(child);
+    GameObject* parentObject = m_entities.Get(parent);
 
-    if (it != m_gameObjects.end()) {
-      m_objectsNames.erase((*it)->GetName());
-      m_gameObjects.erase(it);
+    if (childObject == nullptr ||
+        (parentObject == nullptr && !parent.IsNull())) {
+      return false;
     }
+
+    return m_hierarchy.SetParent(*childObject, parentObject);
   }
 
   /**
 	 * @brief Updates all GameObjects in the scene.
 	 * 
-	 * Calls the Update method of each GameObject, passing the delta time.
+	 * Applies the queued commands, then walks the archetype chunks column by
+	 * column, passing the delta time.
+	 * Scripts run first on the calling thread; world matrices and the spatial
+	 * index are then refreshed, and the remaining components are split into
+	 * batches across the job system.
 	 * 
 	 * @param deltaTime The time elapsed since the last update.
+	 * @param jobSystem Workers to use, or nullptr to update serially.
 	 */
-  void Update(float deltaTime) {
+  void Update(float deltaTime, JobSystem* jobSystem = nullptr) {
     //std::cout << "Updating " << m_name << "." << std::endl; Will reuse in the Log Dock
-    for (const auto& gameObject : m_gameObjects) {
-      gameObject->Update(deltaTime);
-    }
+    // Structural changes recorded since the last update are applied here,
+    // while nothing iterates the scene.
+    m_commands.Flush(*this);
+
+    m_storage->UpdateMainThread(deltaTime);
+    m_hierarchy.Update();
+    RefitSpatialIndex();
+    m_storage->UpdateParallel(deltaTime, jobSystem);
   }
 
   /**
 	 * @brief Renders all GameObjects in the scene.
 	 * 
-	 * Calls the Render method of each GameObject to draw them.
+	 * Calls the Render method of every stored component.
 	 */
-  void Render() {
-    for (const auto& gameObject : m_gameObjects) {
-      gameObject->Render();
-    }
+  void Render() { m_storage->Render(); }
+
+  /**
+	 * @brief Gets the component storage of the scene.
+	 * 
+	 * Systems use it to iterate dense component columns, e.g. with
+	 * ArchetypeStorage::ForEach().
+	 * 
+	 * @return The storage holding the components of the scene.
+	 */
+  ArchetypeStorage& GetStorage() { return *m_storage; }
+
+  /**
+	 * @brief Gets a cached view over the objects owning every component Ts.
+	 * 
+	 * Iterating the view only visits matching objects, e.g.
+	 * `scene.View<TransformComponent, LightComponent>().ForEach(...)`.
+	 * 
+	 * @tparam Ts Concrete component types.
+	 * @return A view that stays current as components are added or removed.
+	 */
+  template <typename... Ts>
+  [[nodiscard]] ComponentView<Ts...> View() {
+    return ComponentView<Ts...>(
+        m_storage->GetMatchingArchetypes(ComponentView<Ts...>::GetMask()));
+  }
+
+  /**
+	 * @brief Gets the parent/child relations of the scene's objects.
+	 * 
+	 * @return The hierarchy owning the cached world matrices.
+	 */
+  TransformHierarchy& GetHierarchy() { return m_hierarchy; }
+
+  /**
+	 * @brief Gets the bounding volume hierarchy of the scene's objects.
+	 * 
+	 * Each object has one proxy holding its world bounds, whose user data is
+	 * the GameObject. Bounds follow transform changes at every Update(); an
+	 * object without a mesh is a point at its origin.
+	 * 
+	 * @return The tree to run ray, box, sphere and frustum queries on.
+	 */
+  [[nodiscard]] const AabbTree& GetSpatialIndex() const {
+    return m_spatialIndex;
   }
 
  private:
+  /**
+	 * @brief Moves the proxies of the objects whose world matrix changed.
+	 * 
+	 * Rebuilds the tree with the surface area heuristic once many leaves were
+	 * reinserted since the last rebuild, e.g. after loading a scene.
+	 */
+  void RefitSpatialIndex();
+
   /**The name of the scene. */
   std::string m_name;
-  /**Vector containing pointers to GameObjects in the scene. */
-  std::vector<std::shared_ptr<GameObject>> m_gameObjects;
+  /**Components of every GameObject in the scene, grouped by archetype. */
+  std::shared_ptr<ArchetypeStorage> m_storage;
+  /**Parent/child relations and world matrices, in depth-first order. */
+  TransformHierarchy m_hierarchy;
+  /**World bounds of the objects, refit after the hierarchy. */
+  AabbTree m_spatialIndex;
+  /**Proxy of each object in m_spatialIndex, by entity slot. */
+  std::vector<std::int32_t> m_spatialProxies;
+  /**Owns the GameObjects; declared after the storage and the hierarchy, so
+   * the objects are destroyed before them. */
+  EntityTable m_entities;
+  /**Structural changes deferred to the next Update(). */
+  EntityCommandBuffer m_commands;
+  /**Scratch list reused by RemoveGameObjects(). */
+  std::vector<GameObject*> m_removedObjects;
+  /**GameObjects of the scene, in creation order. */
+  std::vector<GameObject*> m_gameObjects;
+  /**Bumped on every change to m_gameObjects. */
+  std::uint64_t m_version{0};
+  /**Last snapshot handed out by GetSnapshot(). */
+  SceneSnapshot m_snapshot;
   std::unordered_set<std::string> m_objectsNames;
   // Since i'm just doing name checking, i have chosen to go with hashing. Much faster with a little memory overhead.
 };
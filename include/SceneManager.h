@@ -1,13 +1,15 @@
 #pragma once
+#include <string>
 #include <vector>
 #include "Scene.h"
+#include "core/JobSystem.h"
 
 /**
  * @class SceneManager
  * @brief Manages the scenes in the game.
  * 
  * The SceneManager class is responsible for creating, destroying, 
- * and managing the Scenes in the game. It provides methods to add and remove 
+ * and managing the Scenes in the game. It provides methods to create and remove 
  * GameObjects to the current scene and to update and render the scene.
  */
 class SceneManager {
@@ -42,28 +44,30 @@ class SceneManager {
   }
 
   /**
-	 * @brief Adds a GameObject to the current scene.
+	 * @brief Creates a GameObject in the current scene.
 	 * 
-	 * @param gameObject Pointer to the GameObject to be added.
-	 * 
-	 * If there is no current scene, the GameObject will not be added.
+	 * @param name The name of the new GameObject.
+	 * @return Pointer to the new GameObject, or nullptr if there is no
+	 * current scene.
 	 */
-  void AddObjectToCurrentScene(std::shared_ptr<GameObject> gameObject) {
-    if (currentScene != nullptr) {
-      currentScene->AddGameObject(gameObject);
+  GameObject* CreateObjectInCurrentScene(const std::string& name) {
+    if (currentScene == nullptr) {
+      return nullptr;
     }
+
+    return currentScene->CreateGameObject(name);
   }
 
   /**
 	 * @brief Removes a GameObject from the current scene.
 	 * 
-	 * @param gameObject Pointer to the GameObject to be removed.
+	 * @param handle Handle of the GameObject to be removed.
 	 * 
 	 * If there is no current scene, the GameObject will not be removed.
 	 */
-  void RemoveObjectFromCurrentScene(std::shared_ptr<GameObject> gameObject) {
+  void RemoveObjectFromCurrentScene(EntityHandle handle) {
     if (currentScene != nullptr) {
-      currentScene->RemoveGameObject(gameObject);
+      currentScene->RemoveGameObject(handle);
     }
   }
 
@@ -76,10 +80,19 @@ class SceneManager {
 	 */
   void UpdateCurrentScene(float deltaTime) {
     if (currentScene != nullptr) {
-      currentScene->Update(deltaTime);
+      currentScene->Update(deltaTime, m_jobSystem.get());
     }
   }
 
+  /**
+	 * @brief Sets the job system used to update scenes in parallel.
+	 * 
+	 * @param jobSystem The engine's job system, or nullptr to update serially.
+	 */
+  void SetJobSystem(std::shared_ptr<JobSystem> jobSystem) {
+    m_jobSystem = std::move(jobSystem);
+  }
+
   /**
 	 * @brief Renders the current scene.
 	 * 
@@ -101,4 +114,6 @@ class SceneManager {
  private:
   /**Pointer to the current scene being managed. */
   std::shared_ptr<Scene> currentScene{nullptr};
+  /**Workers used by UpdateCurrentScene. */
+  std::shared_ptr<JobSystem> m_jobSystem{nullptr};
 };
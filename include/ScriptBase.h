@@ -9,7 +9,7 @@ class ScriptBase {
 
   virtual void OnCreate() {}
 
-  virtual void OnUpdate(float deltaTime) {}
+  virtual void OnUpdate(float /*deltaTime*/) {}
 
   virtual void OnDestroy() {}
 
@@ -22,13 +22,19 @@ class ScriptBase {
     return m_gameObject->template GetComponent<T>();
   }
 
+  // Handle of the scripted object, safe to keep across frames.
+  [[nodiscard]] EntityHandle GetHandle() const {
+    return m_gameObject != nullptr ? m_gameObject->GetHandle() : EntityHandle{};
+  }
+
   [[nodiscard]] virtual std::vector<std::pair<std::string, PropertyType>>
   GetProperties() const = 0;
 
   virtual void* GetPropertyPtr(const std::string& name) = 0;
 
  private:
-  std::shared_ptr<GameObject> m_gameObject = nullptr;
+  // Owner of the ScriptComponent running this script, which outlives it.
+  GameObject* m_gameObject = nullptr;
   friend class ScriptComponent;
 };
 
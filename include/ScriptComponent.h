@@ -6,7 +6,7 @@
 
 class ScriptBase;
 
-class ScriptComponent : public Component {
+class ScriptComponent final : public Component {
  private:
   bool compiled = false;
   std::string m_ScriptName;
@@ -22,12 +22,19 @@ class ScriptComponent : public Component {
   [[nodiscard]] std::string GetCompiledPath() const;
 
  public:
-  explicit ScriptComponent(const std::shared_ptr<GameObject>& owner)
+  static constexpr ComponentType StaticType = ComponentType::Script;
+  // Scripts run user code that may touch any object in the scene.
+  static constexpr bool MainThreadOnly = true;
+
+  explicit ScriptComponent(GameObject* owner)
       : Component(owner) {}
 
+  // Takes over the loaded library and script instance.
+  ScriptComponent(ScriptComponent&& other) noexcept;
+
   ~ScriptComponent() override;
 
-  [[nodiscard]] std::string GetName() const { return m_ScriptName; }
+  [[nodiscard]] const std::string& GetName() const { return m_ScriptName; }
 
   void LoadScript(const std::string& scriptName);
   std::string ReloadIfNeeded();
@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include "core/GLStateCache.h"
 
 /**
  * @class ShaderManager
@@ -13,6 +14,9 @@
  * The ShaderManager class handles loading, compiling, linking, and 
  * using shaders within an OpenGL context. It allows for easy access 
  * and management of multiple shader programs by name.
+ * 
+ * Programs are bound through a GLStateCache that the renderer's draws share,
+ * so redundant binds are skipped and the rest are counted.
  */
 class ShaderManager {
  public:
@@ -39,12 +43,22 @@ class ShaderManager {
   bool LoadShader(const std::string& name, const char* vertexPath,
                   const char* fragmentPath);
 
+  /**
+	 * @brief Loads a compute shader from the specified path.
+	 * 
+	 * @param name The name to associate with the loaded shader.
+	 * @param computePath The file path to the compute shader source code.
+	 * @return True if the shader compiled and linked; otherwise, false.
+	 */
+  bool LoadComputeShader(const std::string& name, const char* computePath);
+
   /**
 	 * @brief Activates the shader program associated with the given name.
 	 * 
 	 * @param name The name of the shader to activate.
+	 * @return True if the bound program changed.
 	 */
-  void UseShader(const std::string& name);
+  bool UseShader(const std::string& name);
 
   /**
 	 * @brief Sets a boolean uniform in the currently active shader.
@@ -52,7 +66,7 @@ class ShaderManager {
 	 * @param name The name of the uniform variable in the shader.
 	 * @param value The boolean value to set.
 	 */
-  void SetBool(const std::string& name, bool value);
+  void SetBool(const char* name, bool value);
 
   /**
 	 * @brief Sets an integer uniform in the currently active shader.
@@ -60,7 +74,7 @@ class ShaderManager {
 	 * @param name The name of the uniform variable in the shader.
 	 * @param value The integer value to set.
 	 */
-  void SetInt(const std::string& name, int value);
+  void SetInt(const char* name, int value);
 
   /**
 	 * @brief Sets a float uniform in the currently active shader.
@@ -68,7 +82,7 @@ class ShaderManager {
 	 * @param name The name of the uniform variable in the shader.
 	 * @param value The float value to set.
 	 */
-  void SetFloat(const std::string& name, float value);
+  void SetFloat(const char* name, float value);
 
   /**
 	 * @brief Sets a vec3 uniform in the currently active shader.
@@ -76,7 +90,15 @@ class ShaderManager {
 	 * @param name The name of the uniform variable in the shader.
 	 * @param value The glm::vec3 value to set.
 	 */
-  void SetVector3(const std::string& name, const glm::vec3& value);
+  void SetVector3(const char* name, const glm::vec3& value);
+
+  /**
+	 * @brief Sets a vec4 uniform in the currently active shader.
+	 * 
+	 * @param name The name of the uniform variable in the shader.
+	 * @param value The glm::vec4 value to set.
+	 */
+  void SetVector4(const char* name, const glm::vec4& value);
 
   /**
 	 * @brief Sets a 4x4 matrix uniform in the currently active shader.
@@ -84,7 +106,7 @@ class ShaderManager {
 	 * @param name The name of the uniform variable in the shader.
 	 * @param value The glm::mat4 value to set.
 	 */
-  void SetMatrix4(const std::string& name, const glm::mat4& value);
+  void SetMatrix4(const char* name, const glm::mat4& value);
 
   /**
 	 * @brief Retrieves the location of a uniform variable in the currently active shader.
@@ -92,7 +114,7 @@ class ShaderManager {
 	 * @param name The name of the uniform variable in the shader.
 	 * @return The uniform location or -1 if the shader is not in use.
 	 */
-  unsigned int GetUniformLocation(const std::string& name);
+  unsigned int GetUniformLocation(const char* name);
 
   /**
 	 * @brief Retrieves the OpenGL ID of a shader by its name.
@@ -102,6 +124,11 @@ class ShaderManager {
 	 */
   unsigned int GetShaderID(const std::string& name);
 
+  /**
+	 * @brief Retrieves the cache of bound OpenGL objects.
+	 */
+  GLStateCache& GetState() { return m_state; }
+
  private:
   /**
 	 * @struct Shader
@@ -118,6 +145,14 @@ class ShaderManager {
 		 */
     Shader(const char* vertexPath, const char* fragmentPath);
 
+    /**
+		 * @brief Constructs a compute Shader object from a compute shader path.
+		 * 
+		 * @param computePath The file path to the compute shader source code.
+		 * @throws std::runtime_error If the program fails to compile or link.
+		 */
+    explicit Shader(const char* computePath);
+
     /**
 		 * @brief Activates the shader program for use.
 		 */
@@ -136,4 +171,6 @@ class ShaderManager {
   std::unordered_map<std::string, std::shared_ptr<Shader>> m_shaders;
   /**Pointer to the currently active shader. */
   std::shared_ptr<Shader> m_currentShader{nullptr};
+  /**Bound program and vertex array. */
+  GLStateCache m_state;
 };
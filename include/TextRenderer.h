@@ -9,6 +9,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include FT_FREETYPE_H
 
@@ -45,7 +46,7 @@ class TextRenderer {
   /**
 	 * @brief Destructs the TextRenderer and frees associated resources.
 	 * 
-	 * Deletes the vertex array and buffer objects used for rendering text.
+	 * Deletes the vertex array used for rendering text.
 	 */
   ~TextRenderer();
 
@@ -61,13 +62,15 @@ class TextRenderer {
   /**
 	 * @brief Renders the specified text at the given position and scale.
 	 * 
+	 * The quads of every glyph are written at once into the StreamingBuffer.
+	 * 
 	 * @param text The text string to render.
 	 * @param x The x coordinate for the starting position of the text.
 	 * @param y The y coordinate for the starting position of the text.
 	 * @param scale The scale factor for the text size.
 	 * @param color The color of the text in RGB format.
 	 */
-  void RenderText(const std::string& text, float x, float y, float scale,
+  void RenderText(std::string_view text, float x, float y, float scale,
                   glm::vec3 color);
 
   /**
@@ -83,6 +86,5 @@ class TextRenderer {
   /**Map of characters and their corresponding properties. */
   std::map<char, Character> Characters;
   unsigned int VAO;       /**Vertex Array Object ID.*/
-  unsigned int VBO;       /**Vertex Buffer Object ID.*/
   glm::mat4 m_projection; /**Projection matrix for rendering text. */
 };
\ No newline at end of file
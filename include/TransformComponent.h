@@ -1,8 +1,11 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <iostream>
 #include "Component.h"
+#include "core/Quaternion.h"
+#include "core/TransformHierarchy.h"
 
 /**
  * @class TransformComponent
@@ -11,64 +14,116 @@
  * The TransformComponent class provides functionalities for setting and retrieving
  * the transformation properties of a GameObject, including position, rotation, 
  * and scale. It also allows generating a transformation matrix for rendering.
+ *
+ * The rotation is stored as a unit quaternion; Euler angles in degrees are
+ * only kept as the editor-facing view of it.
+ *
+ * Position, rotation and scale are relative to the parent in the scene's
+ * TransformHierarchy. The local matrix is cached until one of them changes;
+ * the world matrix is cached by the hierarchy and refreshed once per update.
  */
-class TransformComponent : public Component {
+class TransformComponent final : public Component {
  public:
+  static constexpr ComponentType StaticType = ComponentType::Transform;
+  /** World matrices are refreshed by the TransformHierarchy instead. */
+  static constexpr bool HasUpdate = false;
+
   /**
 	 * @brief Constructs a TransformComponent associated with the specified GameObject.
 	 * 
 	 * Initializes position to (0, 0, 0), rotation to (0, 0, 0), and scale to (1, 1, 1).
 	 * @param owner Pointer to the GameObject that owns this component.
 	 */
-  explicit TransformComponent(const std::weak_ptr<GameObject>& owner)
-      : Component(owner), m_position(0.0f), m_rotation(0.0f), m_scale(1.0f) {
-    std::cerr << "Transform Component is being created.\n";
-  }
+  explicit TransformComponent(GameObject* owner)
+      : Component(owner),
+        m_position(0.0f),
+        m_rotation(1.0f, 0.0f, 0.0f, 0.0f),
+        m_eulerDegrees(0.0f),
+        m_scale(1.0f) {}
+
+  /**
+	 * @brief Gets the world transformation matrix of the GameObject.
+	 * 
+	 * The matrix combines the object's local transform with its parents'. It
+	 * is cached by the scene's TransformHierarchy, so changes made during this
+	 * frame show up after the next hierarchy update.
+	 * @return A 4x4 transformation matrix.
+	 */
+  [[nodiscard]] glm::mat4 GetTransformMatrix() const {
+    if (m_hierarchy != nullptr) {
+      return m_hierarchy->GetWorldMatrix(m_hierarchyIndex);
+    }
 
-  ~TransformComponent() override {
-    std::cerr << "Transform Component is being destroyed.\n";
+    return GetLocalMatrix();
   }
 
   /**
-	 * @brief Calculates the transformation matrix for the GameObject.
+	 * @brief Gets the transformation matrix relative to the parent.
 	 * 
-	 * The matrix is based on the current position, rotation, and scale of the object.
+	 * Rebuilt directly from the quaternion, only when the position, rotation
+	 * or scale changed.
 	 * @return A 4x4 transformation matrix.
 	 */
-  [[nodiscard]] glm::mat4 GetTransformMatrix() const {
-    auto transform = glm::mat4(1.0f);
-
-    transform = glm::translate(transform, m_position);
-    transform =
-        glm::rotate(transform, glm::radians(m_rotation.x), glm::vec3(1, 0, 0));
-    transform =
-        glm::rotate(transform, glm::radians(m_rotation.y), glm::vec3(0, 1, 0));
-    transform =
-        glm::rotate(transform, glm::radians(m_rotation.z), glm::vec3(0, 0, 1));
-    transform = glm::scale(transform, m_scale);
-
-    return transform;
+  [[nodiscard]] const glm::mat4& GetLocalMatrix() const {
+    if (m_localDirty) {
+      glm::mat4 transform = glm::mat4_cast(m_rotation);
+
+      transform[0] *= m_scale.x;
+      transform[1] *= m_scale.y;
+      transform[2] *= m_scale.z;
+      transform[3] = glm::vec4(m_position, 1.0f);
+
+      m_localMatrix = transform;
+      m_localDirty = false;
+    }
+
+    return m_localMatrix;
   }
 
   /**
-	 * @brief Calculates the forward vector based on the current rotation.
+	 * @brief Gets the forward vector in world space.
 	 * 
-	 * Uses the rotation to determine the forward direction in the local space.
+	 * Read from the cached world matrix, or rotated by the quaternion when the
+	 * object is not part of a hierarchy; no matrix is built either way.
 	 * @return A glm::vec3 representing the forward direction.
 	 */
   [[nodiscard]] glm::vec3 GetForward() const {
-  
-    auto rotationMatrix = glm::mat4(1.0f);
-    rotationMatrix = glm::rotate(rotationMatrix, glm::radians(m_rotation.x),
-                                 glm::vec3(1, 0, 0));
-    rotationMatrix = glm::rotate(rotationMatrix, glm::radians(m_rotation.y),
-                                 glm::vec3(0, 1, 0));
-    rotationMatrix = glm::rotate(rotationMatrix, glm::radians(m_rotation.z),
-                                 glm::vec3(0, 0, 1));
-
-    glm::vec4 forward = rotationMatrix * glm::vec4(0, 0, -1, 0);
-
-    return {forward.x, forward.y, forward.z};
+    if (m_hierarchy != nullptr) {
+      return -glm::normalize(
+          glm::vec3(m_hierarchy->GetWorldMatrix(m_hierarchyIndex)[2]));
+    }
+
+    return GetLocalForward();
+  }
+
+  /**
+	 * @brief Gets the forward vector relative to the parent.
+	 */
+  [[nodiscard]] glm::vec3 GetLocalForward() const {
+    return m_rotation * glm::vec3(0.0f, 0.0f, -1.0f);
+  }
+
+  /**
+	 * @brief Gets the right vector relative to the parent.
+	 */
+  [[nodiscard]] glm::vec3 GetLocalRight() const {
+    return m_rotation * glm::vec3(1.0f, 0.0f, 0.0f);
+  }
+
+  /**
+	 * @brief Gets the up vector relative to the parent.
+	 */
+  [[nodiscard]] glm::vec3 GetLocalUp() const {
+    return m_rotation * glm::vec3(0.0f, 1.0f, 0.0f);
+  }
+
+  /**
+	 * @brief Gets the position in world space.
+	 * 
+	 * @return The translation of the world matrix.
+	 */
+  [[nodiscard]] glm::vec3 GetWorldPosition() const {
+    return glm::vec3(GetTransformMatrix()[3]);
   }
 
   /**
@@ -76,7 +131,7 @@ class TransformComponent : public Component {
 	 * 
 	 * @param deltaTime Time elapsed since the last frame (in seconds).
 	 */
-  void Update(float deltaTime) override {}
+  void Update(float /*deltaTime*/) override {}
 
   /**
 	 * @brief Sets the position of the GameObject.
@@ -84,14 +139,8 @@ class TransformComponent : public Component {
 	 * @param position New position in 3D space.
 	 */
   void SetPosition(glm::vec3 position) {
-    auto owner = m_owner.lock();
-
-    if (!owner) {
-      std::cerr << "OWNER NO LONGER VALID!\n";
-      return;
-    }
-
     m_position = position;
+    MarkDirty();
   }
 
   /**
@@ -99,14 +148,41 @@ class TransformComponent : public Component {
 	 * 
 	 * @param rotation New rotation values for the x, y, and z axes (in degrees).
 	 */
-  void SetRotation(glm::vec3 rotation) { m_rotation = rotation; }
+  void SetRotation(glm::vec3 rotation) {
+    m_eulerDegrees = rotation;
+    m_rotation = QuatFromEuler(rotation);
+    MarkDirty();
+  }
+
+  /**
+	 * @brief Sets the rotation of the GameObject as a quaternion.
+	 * 
+	 * @param orientation The new rotation; normalized before being stored.
+	 */
+  void SetOrientation(const glm::quat& orientation) {
+    m_rotation = glm::normalize(orientation);
+    m_eulerDegrees = EulerFromQuat(m_rotation);
+    MarkDirty();
+  }
+
+  /**
+	 * @brief Applies a rotation on top of the current one, in parent space.
+	 * 
+	 * @param rotation The rotation to apply.
+	 */
+  void Rotate(const glm::quat& rotation) {
+    SetOrientation(rotation * m_rotation);
+  }
 
   /**
 	 * @brief Sets the scale of the GameObject.
 	 * 
 	 * @param scale New scale values for the x, y, and z axes.
 	 */
-  void SetScale(glm::vec3 scale) { m_scale = scale; }
+  void SetScale(glm::vec3 scale) {
+    m_scale = scale;
+    MarkDirty();
+  }
 
   /**
 	 * @brief Retrieves the current position of the GameObject.
@@ -115,14 +191,63 @@ class TransformComponent : public Component {
 	 */
   [[nodiscard]] glm::vec3 GetPosition() const { return m_position; }
 
-  [[nodiscard]] glm::vec3 GetRotation() const { return m_rotation; }
+  /**
+	 * @brief Retrieves the rotation as Euler angles in degrees.
+	 * 
+	 * Returns the angles last passed to SetRotation(), so editing them does
+	 * not drift through quaternion round trips.
+	 */
+  [[nodiscard]] glm::vec3 GetRotation() const { return m_eulerDegrees; }
+
+  [[nodiscard]] const glm::quat& GetOrientation() const { return m_rotation; }
 
   [[nodiscard]] glm::vec3 GetScale() const { return m_scale; }
 
+  /**
+	 * @brief Gets the owner's position in the hierarchy's depth-first arrays.
+	 * 
+	 * Valid until the hierarchy changes structure.
+	 */
+  [[nodiscard]] std::uint32_t GetHierarchyIndex() const {
+    return m_hierarchyIndex;
+  }
+
+  /**
+	 * @brief Queues the owner for the next refit of the scene's spatial index
+	 * without moving it.
+	 * 
+	 * For changes of the owner's extent, such as a new mesh.
+	 */
+  void MarkBoundsDirty() {
+    if (m_hierarchy != nullptr && !m_worldDirty) {
+      m_worldDirty = true;
+      m_hierarchy->MarkDirty(m_hierarchyIndex);
+    }
+  }
+
  private:
+  friend class TransformHierarchy;
+
+  /** Invalidates the local matrix and queues the node in the hierarchy. */
+  void MarkDirty() {
+    m_localDirty = true;
+    MarkBoundsDirty();
+  }
+
   glm::vec3 m_position; /**Position of the GameObject in 3D space. */
-  /**Rotation of the GameObject in degrees (x, y, z axes). */
-  glm::vec3 m_rotation;
+  /**Rotation of the GameObject, a unit quaternion. */
+  glm::quat m_rotation;
+  /**Editor-facing view of m_rotation, in degrees (x, y, z axes). */
+  glm::vec3 m_eulerDegrees;
   /**Scale of the GameObject along the x, y, and z axes. */
   glm::vec3 m_scale;
+
+  mutable glm::mat4 m_localMatrix{1.0f};
+  mutable bool m_localDirty{true};
+  /**Already queued in the hierarchy for this update. */
+  bool m_worldDirty{false};
+  /**Hierarchy of the owner's scene, nullptr until it is added to one. */
+  TransformHierarchy* m_hierarchy{nullptr};
+  /**Index of the owner in m_hierarchy's depth-first order. */
+  std::uint32_t m_hierarchyIndex{0};
 };
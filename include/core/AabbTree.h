@@ -0,0 +1,353 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "core/Bounds.h"
+
+/**
+ * @class AabbTree
+ * @brief Dynamic bounding volume hierarchy of axis-aligned boxes.
+ *
+ * Each proxy is a leaf holding a "fat" box: the box it was given, inflated
+ * by FatMargin. Moving a proxy within its fat box is free; moving it out
+ * removes the leaf and inserts it again, picking the sibling that adds the
+ * least surface area and rebalancing with tree rotations on the way up.
+ *
+ * Incremental insertions degrade the tree slowly. Rebuild() rebuilds it from
+ * scratch with a binned surface area heuristic, which suits content that
+ * stopped moving, such as a freshly loaded scene.
+ *
+ * Proxies are node indices. They stay valid until DestroyProxy(), across
+ * moves and rebuilds.
+ */
+class AabbTree {
+ public:
+  /**Index of no node. */
+  static constexpr std::int32_t NullNode = -1;
+  /**Margin added on every side of a leaf box, in world units. */
+  static constexpr float FatMargin = 0.1f;
+
+  AabbTree() = default;
+
+  AabbTree(const AabbTree&) = delete;
+  AabbTree& operator=(const AabbTree&) = delete;
+  AabbTree(AabbTree&&) = delete;
+  AabbTree& operator=(AabbTree&&) = delete;
+
+  /**
+   * @brief Inserts a box.
+   *
+   * @param bounds The tight bounds of the object.
+   * @param userData Returned by GetUserData() for the proxy.
+   * @return The new proxy.
+   */
+  std::int32_t CreateProxy(const Aabb& bounds, void* userData);
+
+  /**
+   * @brief Removes a proxy created by CreateProxy().
+   */
+  void DestroyProxy(std::int32_t proxy);
+
+  /**
+   * @brief Updates the bounds of a proxy.
+   *
+   * @param proxy The proxy to move.
+   * @param bounds The new tight bounds.
+   * @return True if the leaf left its fat box and was reinserted.
+   */
+  bool MoveProxy(std::int32_t proxy, const Aabb& bounds);
+
+  /**
+   * @brief Rebuilds the whole tree top-down with the surface area heuristic.
+   *
+   * O(n log n). Proxies keep their indices and fat boxes.
+   */
+  void Rebuild();
+
+  [[nodiscard]] void* GetUserData(std::int32_t proxy) const {
+    return m_nodes[proxy].userData;
+  }
+
+  /**
+   * @brief The fat box stored for a proxy, which contains its tight bounds.
+   */
+  [[nodiscard]] const Aabb& GetFatBounds(std::int32_t proxy) const {
+    return m_nodes[proxy].bounds;
+  }
+
+  [[nodiscard]] std::size_t GetProxyCount() const { return m_proxyCount; }
+
+  /**
+   * @brief Leaves inserted since the last Rebuild(), including reinsertions.
+   */
+  [[nodiscard]] std::size_t GetInsertionsSinceRebuild() const {
+    return m_insertionsSinceRebuild;
+  }
+
+  /**
+   * @brief Number of edges on the longest path from the root to a leaf.
+   */
+  [[nodiscard]] std::int32_t GetHeight() const {
+    return m_root != NullNode ? m_nodes[m_root].height : 0;
+  }
+
+  /**
+   * @brief Calls `callback(proxy)` for every fat box overlapping `bounds`.
+   *
+   * The callback may return false to stop the query early.
+   */
+  template <typename Callback>
+  void QueryAabb(const Aabb& bounds, Callback&& callback) const {
+    Traverse([&bounds](const Aabb& node) { return node.Overlaps(bounds); },
+             callback);
+  }
+
+  /**
+   * @brief Calls `callback(proxy)` for every fat box overlapping `sphere`.
+   *
+   * The callback may return false to stop the query early.
+   */
+  template <typename Callback>
+  void QuerySphere(const Sphere& sphere, Callback&& callback) const {
+    Traverse([&sphere](const Aabb& node) { return sphere.Overlaps(node); },
+             callback);
+  }
+
+  /**
+   * @brief Calls `callback(proxy)` for every fat box inside or crossing the
+   * frustum.
+   *
+   * Subtrees entirely inside the frustum are reported without testing their
+   * nodes. The callback may return false to stop the query early.
+   */
+  template <typename Callback>
+  void QueryFrustum(const Frustum& frustum, Callback&& callback) const;
+
+  /**
+   * @brief Visits the fat boxes hit by a ray, nearest subtree first.
+   *
+   * `callback(proxy, distance)` receives the distance at which the ray
+   * enters the fat box and returns the new maximum distance: the distance of
+   * an exact hit to only look for closer ones, `maxDistance` to keep
+   * going, or 0 to stop.
+   *
+   * @param ray The ray; distances are in multiples of its direction.
+   * @param maxDistance Boxes further away are ignored.
+   * @param callback Called for each candidate.
+   */
+  template <typename Callback>
+  void RayCast(const Ray& ray, float maxDistance, Callback&& callback) const;
+
+ private:
+  /**
+   * @struct Node
+   * @brief A leaf (one proxy) or an internal node with two children.
+   */
+  struct Node {
+    Aabb bounds;
+    void* userData{nullptr};
+    /**Parent, or next free node while the node is on the free list. */
+    std::int32_t parent{NullNode};
+    std::int32_t child1{NullNode};
+    std::int32_t child2{NullNode};
+    /**0 for leaves, -1 for free nodes. */
+    std::int32_t height{-1};
+
+    [[nodiscard]] bool IsLeaf() const { return child1 == NullNode; }
+  };
+
+  /**
+   * @class NodeStack
+   * @brief Traversal stack; stays on the call stack for balanced trees.
+   */
+  class NodeStack {
+   public:
+    void Push(std::int32_t node) {
+      if (m_size < InlineCapacity) {
+        m_inline[m_size] = node;
+      } else {
+        m_overflow.push_back(node);
+      }
+      ++m_size;
+    }
+
+    std::int32_t Pop() {
+      --m_size;
+      if (m_size < InlineCapacity) {
+        return m_inline[m_size];
+      }
+      std::int32_t node = m_overflow.back();
+      m_overflow.pop_back();
+      return node;
+    }
+
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+
+   private:
+    static constexpr std::size_t InlineCapacity = 64;
+    std::int32_t m_inline[InlineCapacity];
+    std::vector<std::int32_t> m_overflow;
+    std::size_t m_size{0};
+  };
+
+  /** Calls a query callback; void callbacks never stop the query. */
+  template <typename Callback>
+  static bool Report(Callback& callback, std::int32_t proxy) {
+    if constexpr (std::is_void_v<decltype(callback(proxy))>) {
+      callback(proxy);
+      return true;
+    } else {
+      return callback(proxy);
+    }
+  }
+
+  /** Depth-first traversal reporting the leaves whose box passes `test`. */
+  template <typename Test, typename Callback>
+  void Traverse(Test&& test, Callback& callback) const;
+
+  std::int32_t AllocateNode();
+  void FreeNode(std::int32_t node);
+
+  void InsertLeaf(std::int32_t leaf);
+  void RemoveLeaf(std::int32_t leaf);
+
+  /** Rotates the subtree at `node` if its children differ in height by more
+   * than one. @return The node now at that position. */
+  std::int32_t Balance(std::int32_t node);
+
+  /** Refits bounds and heights from `node` up to the root, rebalancing. */
+  void RefitAncestors(std::int32_t node);
+
+  /** Builds a subtree over m_buildLeaves[first, last). @return Its root. */
+  std::int32_t BuildRange(std::size_t first, std::size_t last);
+
+  std::vector<Node> m_nodes;
+  std::int32_t m_root{NullNode};
+  std::int32_t m_freeList{NullNode};
+  std::size_t m_proxyCount{0};
+  std::size_t m_insertionsSinceRebuild{0};
+  /**Scratch leaf list reused by Rebuild(). */
+  std::vector<std::int32_t> m_buildLeaves;
+};
+
+template <typename Test, typename Callback>
+void AabbTree::Traverse(Test&& test, Callback& callback) const {
+  if (m_root == NullNode) {
+    return;
+  }
+
+  NodeStack stack;
+  stack.Push(m_root);
+
+  while (!stack.IsEmpty()) {
+    std::int32_t index = stack.Pop();
+    const Node& node = m_nodes[index];
+
+    if (!test(node.bounds)) {
+      continue;
+    }
+
+    if (node.IsLeaf()) {
+      if (!Report(callback, index)) {
+        return;
+      }
+    } else {
+      stack.Push(node.child1);
+      stack.Push(node.child2);
+    }
+  }
+}
+
+template <typename Callback>
+void AabbTree::QueryFrustum(const Frustum& frustum, Callback&& callback) const {
+  if (m_root == NullNode) {
+    return;
+  }
+
+  // Nodes are pushed with their sign flipped once an ancestor was found
+  // inside the frustum, so their subtree is reported without tests.
+  NodeStack stack;
+  stack.Push(m_root);
+
+  while (!stack.IsEmpty()) {
+    std::int32_t entry = stack.Pop();
+    bool inside = entry < 0;
+    std::int32_t index = inside ? -entry - 1 : entry;
+    const Node& node = m_nodes[index];
+
+    if (!inside) {
+      Containment containment = frustum.Classify(node.bounds);
+
+      if (containment == Containment::Outside) {
+        continue;
+      }
+
+      inside = containment == Containment::Inside;
+    }
+
+    if (node.IsLeaf()) {
+      if (!Report(callback, index)) {
+        return;
+      }
+    } else if (inside) {
+      stack.Push(-node.child1 - 1);
+      stack.Push(-node.child2 - 1);
+    } else {
+      stack.Push(node.child1);
+      stack.Push(node.child2);
+    }
+  }
+}
+
+template <typename Callback>
+void AabbTree::RayCast(const Ray& ray, float maxDistance,
+                       Callback&& callback) const {
+  if (m_root == NullNode) {
+    return;
+  }
+
+  const glm::vec3 inverseDirection = 1.0f / ray.direction;
+  NodeStack stack;
+  stack.Push(m_root);
+
+  while (!stack.IsEmpty()) {
+    std::int32_t index = stack.Pop();
+    const Node& node = m_nodes[index];
+    float distance = 0.0f;
+
+    if (!IntersectRay(node.bounds, ray, inverseDirection, maxDistance,
+                      distance)) {
+      continue;
+    }
+
+    if (node.IsLeaf()) {
+      maxDistance = callback(index, distance);
+
+      if (maxDistance <= 0.0f) {
+        return;
+      }
+
+      continue;
+    }
+
+    // Visit the nearer child first, so hits clip the further one sooner.
+    float distance1 = 0.0f;
+    float distance2 = 0.0f;
+    bool hit1 = IntersectRay(m_nodes[node.child1].bounds, ray,
+                             inverseDirection, maxDistance, distance1);
+    bool hit2 = IntersectRay(m_nodes[node.child2].bounds, ray,
+                             inverseDirection, maxDistance, distance2);
+
+    if (hit1 && hit2) {
+      bool firstIsNearer = distance1 <= distance2;
+      stack.Push(firstIsNearer ? node.child2 : node.child1);
+      stack.Push(firstIsNearer ? node.child1 : node.child2);
+    } else if (hit1) {
+      stack.Push(node.child1);
+    } else if (hit2) {
+      stack.Push(node.child2);
+    }
+  }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Number of calls to the global operator new since startup.
+ *
+ * The engine replaces the global allocation functions with counting ones, so
+ * sampling this value around a frame tells how many heap allocations the
+ * frame made. Allocations done directly with malloc (ImGui, FreeType) are not
+ * counted.
+ */
+std::uint64_t GetHeapAllocationCount();
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+#include "core/ComponentType.h"
+#include "core/PoolAllocator.h"
+
+class Archetype;
+class GameObject;
+class JobSystem;
+
+/**
+ * @struct EntityLocation
+ * @brief Row of an entity inside the archetype that currently stores it.
+ *
+ * Locations change whenever the entity (or the last entity of the same
+ * archetype) changes its component set, so they must not be cached across
+ * structural changes.
+ */
+struct EntityLocation {
+  Archetype* archetype{nullptr}; /**Archetype holding the entity, if any. */
+  std::uint32_t chunk{0};        /**Chunk index inside the archetype. */
+  std::uint32_t slot{0};         /**Row index inside the chunk. */
+};
+
+/**
+ * @class Archetype
+ * @brief Stores every entity that owns exactly the same set of components.
+ *
+ * Entities are packed into fixed-size chunks. Inside a chunk each component
+ * type has its own contiguous column, so systems can walk a column as a dense
+ * array instead of chasing one pointer per component. Rows are kept packed:
+ * removing an entity moves the last row into the hole.
+ *
+ * Chunks come from a pool owned by the archetype, header and columns in one
+ * block: a chunk emptied by removals goes back to the pool's free list and is
+ * reused by the next AllocateRow() instead of round-tripping through the
+ * system allocator.
+ */
+class Archetype {
+ public:
+  /** Target size of a chunk in bytes, a handful of L1-sized pages. */
+  static constexpr std::size_t ChunkBytes = 16 * 1024;
+  /** Alignment of chunk memory and of every column inside it. */
+  static constexpr std::size_t ChunkAlignment = 64;
+  /** Chunks the pool allocates at once when its free list runs dry. */
+  static constexpr std::size_t ChunksPerPage = 4;
+
+  /**
+   * @struct Chunk
+   * @brief A block of memory holding up to GetChunkCapacity() rows.
+   *
+   * The header is constructed at the start of its pool block, in front of
+   * the owner and component columns it points to.
+   */
+  struct Chunk {
+    Chunk() = default;
+    ~Chunk() = default;
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
+    Chunk(Chunk&&) = delete;
+    Chunk& operator=(Chunk&&) = delete;
+
+    GameObject** owners{nullptr}; /**Owner of each row. */
+    /**Start of each component column, nullptr if the type is not stored. */
+    std::array<std::byte*, ComponentTypeCount> columns{};
+    std::uint32_t count{0}; /**Number of live rows. */
+  };
+
+  explicit Archetype(ComponentMask mask);
+
+  /**
+   * @brief Destroys every component still stored in the archetype.
+   */
+  ~Archetype();
+
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+  Archetype(Archetype&&) = delete;
+  Archetype& operator=(Archetype&&) = delete;
+
+  [[nodiscard]] ComponentMask GetMask() const { return m_mask; }
+
+  [[nodiscard]] bool Has(ComponentType type) const {
+    return m_mask.test(static_cast<std::size_t>(type));
+  }
+
+  [[nodiscard]] std::uint32_t GetChunkCapacity() const {
+    return m_chunkCapacity;
+  }
+
+  [[nodiscard]] std::size_t GetChunkCount() const { return m_chunks.size(); }
+
+  /**
+   * @brief Usage of the chunk pool, counted in chunks.
+   */
+  [[nodiscard]] const PoolStats& GetChunkPoolStats() const {
+    return m_chunkPool->GetStats();
+  }
+
+  [[nodiscard]] const Chunk& GetChunk(std::size_t index) const {
+    return *m_chunks[index];
+  }
+
+  /**
+   * @brief Counts the entities stored in every chunk of the archetype.
+   *
+   * @return The number of live rows.
+   */
+  [[nodiscard]] std::size_t GetEntityCount() const;
+
+  /**
+   * @brief Retrieves the column of a component type inside a chunk.
+   *
+   * @tparam T The concrete component type.
+   * @param chunk The chunk to read from.
+   * @return Pointer to the first of chunk.count components, or nullptr.
+   */
+  template <typename T>
+  [[nodiscard]] T* GetColumn(const Chunk& chunk) const {
+    std::byte* column = chunk.columns[static_cast<std::size_t>(T::StaticType)];
+    return column != nullptr ? std::launder(reinterpret_cast<T*>(column))
+                             : nullptr;
+  }
+
+  /**
+   * @brief Retrieves a component of the entity stored at a location.
+   *
+   * @tparam T The concrete component type.
+   * @param location A location inside this archetype.
+   * @return Pointer to the component, or nullptr if the type is not stored.
+   */
+  template <typename T>
+  [[nodiscard]] T* Get(const EntityLocation& location) const {
+    T* column = GetColumn<T>(*m_chunks[location.chunk]);
+    return column != nullptr ? column + location.slot : nullptr;
+  }
+
+  /**
+   * @brief Type-erased variant of Get().
+   *
+   * @param type The component type.
+   * @param location A location inside this archetype.
+   * @return Pointer to the component storage, or nullptr.
+   */
+  [[nodiscard]] void* GetRaw(ComponentType type,
+                             const EntityLocation& location) const;
+
+ private:
+  friend class ArchetypeStorage;
+
+  /** Reserves a row at the end of the archetype, without constructing it. */
+  EntityLocation AllocateRow(GameObject* owner);
+
+  /**
+   * @brief Releases a row whose components were already moved or destroyed.
+   *
+   * @return The owner that was moved into the hole, or nullptr.
+   */
+  GameObject* ReleaseRow(const EntityLocation& location);
+
+  ComponentMask m_mask;
+  std::uint32_t m_chunkCapacity{0};
+  std::size_t m_chunkSize{0}; /**Bytes actually allocated per chunk. */
+  /**Byte offset of each column inside a chunk. */
+  std::array<std::size_t, ComponentTypeCount> m_columnOffsets{};
+  /**Blocks of m_chunkSize bytes; created once the size is known. */
+  std::unique_ptr<PoolAllocator> m_chunkPool;
+  /**Chunks in use, each living in a block of m_chunkPool. */
+  std::vector<Chunk*> m_chunks;
+};
+
+/**
+ * @class ArchetypeStorage
+ * @brief Owns the components of every entity of a scene, grouped by archetype.
+ *
+ * GameObjects do not own their components anymore: they only remember their
+ * EntityLocation, and every structural change goes through this class, which
+ * migrates the entity between archetypes.
+ */
+class ArchetypeStorage {
+ public:
+  ArchetypeStorage() = default;
+  ~ArchetypeStorage() = default;
+
+  ArchetypeStorage(const ArchetypeStorage&) = delete;
+  ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+  ArchetypeStorage(ArchetypeStorage&&) = delete;
+  ArchetypeStorage& operator=(ArchetypeStorage&&) = delete;
+
+  /**
+   * @brief Moves an entity into the archetype that also holds `type`.
+   *
+   * Existing components are relocated; the slot for the new component is
+   * returned uninitialized and must be constructed by the caller.
+   *
+   * @param object The entity gaining a component.
+   * @param type The component type being added. Must not be owned yet.
+   * @return Storage for the new component.
+   */
+  void* AddComponentSlot(GameObject& object, ComponentType type);
+
+  /**
+   * @brief Destroys one component and moves the entity to the smaller archetype.
+   *
+   * @param object The entity losing a component.
+   * @param type The component type to remove.
+   */
+  void RemoveComponent(GameObject& object, ComponentType type);
+
+  /**
+   * @brief Destroys every component of an entity and frees its row.
+   *
+   * @param object The entity to clear.
+   */
+  void RemoveEntity(GameObject& object);
+
+  /**
+   * @brief Updates every stored component, one column at a time.
+   *
+   * Runs UpdateMainThread() followed by UpdateParallel().
+   *
+   * @param deltaTime The time elapsed since the last update.
+   * @param jobSystem Workers to use, or nullptr to update serially.
+   */
+  void Update(float deltaTime, JobSystem* jobSystem = nullptr) {
+    UpdateMainThread(deltaTime);
+    UpdateParallel(deltaTime, jobSystem);
+  }
+
+  /**
+   * @brief Updates the columns of MainThreadOnly components.
+   *
+   * @param deltaTime The time elapsed since the last update.
+   */
+  void UpdateMainThread(float deltaTime);
+
+  /**
+   * @brief Updates every other column, one chunk column per job.
+   *
+   * @param deltaTime The time elapsed since the last update.
+   * @param jobSystem Workers to use, or nullptr to update serially.
+   */
+  void UpdateParallel(float deltaTime, JobSystem* jobSystem);
+
+  /**
+   * @brief Renders every stored component, one column at a time.
+   */
+  void Render();
+
+  /**
+   * @brief Calls `func(T&)` for every stored component of type T.
+   *
+   * Components are visited chunk by chunk in memory order. Structural changes
+   * must not happen while iterating.
+   */
+  template <typename T, typename Func>
+  void ForEach(Func&& func) {
+    for (const auto& archetype : m_archetypes) {
+      if (!archetype->Has(T::StaticType)) {
+        continue;
+      }
+
+      for (std::size_t i = 0; i < archetype->GetChunkCount(); ++i) {
+        const Archetype::Chunk& chunk = archetype->GetChunk(i);
+        T* column = archetype->template GetColumn<T>(chunk);
+
+        for (std::uint32_t slot = 0; slot < chunk.count; ++slot) {
+          func(column[slot]);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Usage statistics of one component type.
+   *
+   * Capacity counts the rows of every chunk able to hold the type, live count
+   * the components currently constructed.
+   *
+   * @param type The component type.
+   * @return The statistics of the type.
+   */
+  [[nodiscard]] PoolStats GetComponentStats(ComponentType type) const;
+
+  [[nodiscard]] const std::vector<std::unique_ptr<Archetype>>& GetArchetypes()
+      const {
+    return m_archetypes;
+  }
+
+  /**
+   * @brief Archetypes holding at least every type of `mask`.
+   *
+   * The first call for a mask scans the existing archetypes; the result is
+   * then cached and extended as matching archetypes are created, so later
+   * calls are a lookup. The returned list stays valid for the lifetime of
+   * the storage.
+   *
+   * @param mask The required component set.
+   * @return The matching archetypes, in creation order.
+   */
+  [[nodiscard]] const std::vector<Archetype*>& GetMatchingArchetypes(
+      ComponentMask mask);
+
+ private:
+  Archetype& GetOrCreateArchetype(ComponentMask mask);
+
+  /** Stores a new location and refreshes the object's component slot table. */
+  static void SetLocation(GameObject& object, const EntityLocation& location);
+
+  /** Moves every component present in both archetypes to a new row. */
+  EntityLocation MoveEntity(GameObject& object, Archetype& target);
+
+  /**
+   * @struct UpdateBatch
+   * @brief A chunk column queued for the parallel update pass.
+   */
+  struct UpdateBatch {
+    void (*updateColumn)(void* column, std::uint32_t count, float deltaTime);
+    std::byte* column;
+    std::uint32_t count;
+  };
+
+  /** Counts a constructed or destroyed component of every type in `mask`. */
+  void TrackComponents(ComponentMask mask, bool constructed);
+
+  /**Live count and high-water mark of each component type. */
+  std::array<PoolStats, ComponentTypeCount> m_componentStats{};
+
+  /**Reused every frame to avoid reallocating the batch list. */
+  std::vector<UpdateBatch> m_updateBatches;
+
+  /**
+   * @struct Query
+   * @brief Cached result of GetMatchingArchetypes() for one mask.
+   */
+  struct Query {
+    ComponentMask mask;
+    std::vector<Archetype*> archetypes;
+  };
+
+  /**Queries asked so far; boxed so the archetype lists never move. */
+  std::vector<std::unique_ptr<Query>> m_queries;
+
+  /**Archetypes created so far. There are at most 2^ComponentTypeCount of
+   * them, so a linear lookup by mask is enough. */
+  std::vector<std::unique_ptr<Archetype>> m_archetypes;
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <glm/glm.hpp>
+
+// Bounding volumes and the primitives they are tested against. Everything is
+// inline so that spatial queries can be used from scripts as well.
+
+/**
+ * @struct Aabb
+ * @brief Axis-aligned bounding box.
+ *
+ * The default box is empty (min above max), so growing it with Expand() or
+ * Union() starts from the first point or box added.
+ */
+struct Aabb {
+  glm::vec3 min{std::numeric_limits<float>::max()};
+  glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+  [[nodiscard]] bool IsEmpty() const {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+  }
+
+  [[nodiscard]] glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+
+  /**Half the size of the box along each axis. */
+  [[nodiscard]] glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+  /**
+   * @brief Surface area, the cost metric of the surface area heuristic.
+   */
+  [[nodiscard]] float GetSurfaceArea() const {
+    glm::vec3 size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+  }
+
+  void Expand(const glm::vec3& point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+  }
+
+  /** Grows the box by `margin` on every side. */
+  void Inflate(float margin) {
+    min -= glm::vec3(margin);
+    max += glm::vec3(margin);
+  }
+
+  [[nodiscard]] bool Contains(const Aabb& other) const {
+    return min.x <= other.min.x && min.y <= other.min.y &&
+           min.z <= other.min.z && other.max.x <= max.x &&
+           other.max.y <= max.y && other.max.z <= max.z;
+  }
+
+  [[nodiscard]] bool Overlaps(const Aabb& other) const {
+    return min.x <= other.max.x && other.min.x <= max.x &&
+           min.y <= other.max.y && other.min.y <= max.y &&
+           min.z <= other.max.z && other.min.z <= max.z;
+  }
+};
+
+/**
+ * @brief Smallest box containing both boxes.
+ */
+inline Aabb Union(const Aabb& a, const Aabb& b) {
+  return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+}
+
+/**
+ * @brief Bounds of a box after an affine transform.
+ *
+ * Projects the transformed half extents on each axis instead of
+ * transforming the eight corners.
+ *
+ * @param local Box in the transform's source space.
+ * @param matrix An affine transform.
+ * @return The world-space box, never smaller than the transformed one.
+ */
+inline Aabb TransformAabb(const Aabb& local, const glm::mat4& matrix) {
+  if (local.IsEmpty()) {
+    return local;
+  }
+
+  glm::vec3 center = glm::vec3(matrix * glm::vec4(local.GetCenter(), 1.0f));
+  glm::vec3 extents = local.GetExtents();
+  glm::vec3 worldExtents(0.0f);
+
+  for (int column = 0; column < 3; ++column) {
+    worldExtents += glm::abs(glm::vec3(matrix[column])) * extents[column];
+  }
+
+  return {center - worldExtents, center + worldExtents};
+}
+
+/**
+ * @struct Ray
+ * @brief Half-line starting at `origin`.
+ */
+struct Ray {
+  glm::vec3 origin{0.0f};
+  /**Need not be normalized; distances are measured in its length. */
+  glm::vec3 direction{0.0f, 0.0f, -1.0f};
+};
+
+/**
+ * @brief Slab test of a ray against a box.
+ *
+ * @param box The box to test.
+ * @param ray The ray.
+ * @param inverseDirection 1 / ray.direction, computed once per ray.
+ * @param maxDistance Hits further along the ray are ignored.
+ * @param[out] distance Where the ray enters the box, 0 if it starts inside.
+ * @return True on a hit within maxDistance.
+ */
+inline bool IntersectRay(const Aabb& box, const Ray& ray,
+                         const glm::vec3& inverseDirection, float maxDistance,
+                         float& distance) {
+  float entry = 0.0f;
+  float exit = maxDistance;
+
+  for (int axis = 0; axis < 3; ++axis) {
+    float slabEntry =
+        (box.min[axis] - ray.origin[axis]) * inverseDirection[axis];
+    float slabExit =
+        (box.max[axis] - ray.origin[axis]) * inverseDirection[axis];
+
+    if (slabEntry > slabExit) {
+      std::swap(slabEntry, slabExit);
+    }
+
+    // NaN, from a zero direction on a slab boundary, compares false and is
+    // ignored.
+    entry = slabEntry > entry ? slabEntry : entry;
+    exit = slabExit < exit ? slabExit : exit;
+
+    if (entry > exit) {
+      return false;
+    }
+  }
+
+  distance = entry;
+  return true;
+}
+
+/**
+ * @struct Sphere
+ * @brief Bounding sphere.
+ */
+struct Sphere {
+  glm::vec3 center{0.0f};
+  float radius{0.0f};
+
+  [[nodiscard]] bool Overlaps(const Aabb& box) const {
+    glm::vec3 closest = glm::clamp(center, box.min, box.max);
+    glm::vec3 offset = closest - center;
+    return glm::dot(offset, offset) <= radius * radius;
+  }
+};
+
+/**
+ * @enum Containment
+ * @brief How a box relates to a volume.
+ */
+enum class Containment { Outside, Intersecting, Inside };
+
+/**
+ * @struct Frustum
+ * @brief Six planes bounding the volume a camera sees.
+ *
+ * Each plane is (normal, distance) with the normal pointing inwards, so a
+ * point p is inside when dot(normal, p) + distance >= 0 for every plane.
+ */
+struct Frustum {
+  std::array<glm::vec4, 6> planes{};
+
+  /**
+   * @brief Extracts the planes of a projection * view matrix.
+   *
+   * Gribb and Hartmann's method, for OpenGL clip space (-w <= z <= w).
+   */
+  static Frustum FromMatrix(const glm::mat4& viewProjection) {
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i) {
+      row[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i],
+                         viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0];  // Left
+    frustum.planes[1] = row[3] - row[0];  // Right
+    frustum.planes[2] = row[3] + row[1];  // Bottom
+    frustum.planes[3] = row[3] - row[1];  // Top
+    frustum.planes[4] = row[3] + row[2];  // Near
+    frustum.planes[5] = row[3] - row[2];  // Far
+
+    for (glm::vec4& plane : frustum.planes) {
+      plane = plane * (1.0f / glm::length(glm::vec3(plane)));
+    }
+
+    return frustum;
+  }
+
+  /**
+   * @brief Classifies a box against the frustum.
+   *
+   * Conservative: a box near a corner of the frustum may be reported as
+   * Intersecting while it is actually outside.
+   */
+  [[nodiscard]] Containment Classify(const Aabb& box) const {
+    glm::vec3 center = box.GetCenter();
+    glm::vec3 extents = box.GetExtents();
+    Containment result = Containment::Inside;
+
+    for (const glm::vec4& plane : planes) {
+      glm::vec3 normal(plane);
+      float distance = glm::dot(normal, center) + plane.w;
+      float radius = glm::dot(glm::abs(normal), extents);
+
+      if (distance < -radius) {
+        return Containment::Outside;
+      }
+
+      if (distance < radius) {
+        result = Containment::Intersecting;
+      }
+    }
+
+    return result;
+  }
+
+  [[nodiscard]] bool Overlaps(const Aabb& box) const {
+    return Classify(box) != Containment::Outside;
+  }
+};
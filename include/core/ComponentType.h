@@ -0,0 +1,53 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+class Component;
+
+/**
+ * @enum ComponentType
+ * @brief Identifies every built-in component type at compile time.
+ *
+ * Each component class exposes its value as `StaticType`. The value is also
+ * the column index inside an archetype chunk, so the declaration order is the
+ * order in which components of one chunk are updated: scripts run before
+ * meshes and lights, which then see the transform the script just wrote.
+ */
+enum class ComponentType : std::uint8_t { Transform, Script, Mesh, Light, Count };
+
+constexpr std::size_t ComponentTypeCount =
+    static_cast<std::size_t>(ComponentType::Count);
+
+/** Set of component types owned by an entity (one bit per ComponentType). */
+using ComponentMask = std::bitset<ComponentTypeCount>;
+
+/**
+ * @struct ComponentTypeInfo
+ * @brief Type-erased operations the archetype storage needs for a column.
+ */
+struct ComponentTypeInfo {
+  std::size_t size;      /**sizeof() the concrete component. */
+  std::size_t alignment; /**alignof() the concrete component. */
+  /**Move-constructs into dst and destroys src. */
+  void (*relocate)(void* dst, void* src);
+  void (*destroy)(void* component);
+  Component* (*asComponent)(void* component);
+  /**Updates `count` contiguous components starting at `column`; nullptr
+   * when the type's Update() does nothing. */
+  void (*updateColumn)(void* column, std::uint32_t count, float deltaTime);
+  /**Renders `count` contiguous components starting at `column`; nullptr
+   * when the type's Render() does nothing. */
+  void (*renderColumn)(void* column, std::uint32_t count);
+  /**Updates must run on the main thread, outside the job system. */
+  bool mainThreadOnly;
+};
+
+/**
+ * @brief Retrieves the type-erased operations for a component type.
+ *
+ * @param type The component type to look up.
+ * @return The operations table, valid for the lifetime of the program.
+ */
+const ComponentTypeInfo& GetComponentTypeInfo(ComponentType type);
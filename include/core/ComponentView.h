@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/ArchetypeStorage.h"
+#include "core/ComponentType.h"
+
+class GameObject;
+
+/**
+ * @class ComponentView
+ * @brief Every entity of a scene owning all of the components Ts.
+ *
+ * A view walks the archetypes matching its component set, a list cached by
+ * the ArchetypeStorage and extended whenever a new archetype is created.
+ * Iteration therefore costs one pass over the matching rows, however many
+ * other entities the scene holds.
+ *
+ * Obtain views through Scene::View(). Structural changes must not happen
+ * while iterating; record them in the scene's command buffer instead.
+ *
+ * @tparam Ts Concrete component types, each listed once.
+ */
+template <typename... Ts>
+class ComponentView {
+ public:
+  explicit ComponentView(const std::vector<Archetype*>& archetypes)
+      : m_archetypes(&archetypes) {}
+
+  /**
+   * @brief Component set an archetype must contain to match the view.
+   */
+  [[nodiscard]] static ComponentMask GetMask() {
+    ComponentMask mask;
+    (mask.set(static_cast<std::size_t>(Ts::StaticType)), ...);
+    return mask;
+  }
+
+  /**
+   * @brief Calls `func(GameObject&, Ts&...)` for every matching entity.
+   *
+   * Entities are visited chunk by chunk in memory order.
+   */
+  template <typename Func>
+  void ForEach(Func&& func) const {
+    for (Archetype* archetype : *m_archetypes) {
+      for (std::size_t i = 0; i < archetype->GetChunkCount(); ++i) {
+        const Archetype::Chunk& chunk = archetype->GetChunk(i);
+        ForEachRow(chunk, func, archetype->template GetColumn<Ts>(chunk)...);
+      }
+    }
+  }
+
+  /**
+   * @brief Counts the matching entities.
+   */
+  [[nodiscard]] std::size_t Count() const {
+    std::size_t count = 0;
+
+    for (const Archetype* archetype : *m_archetypes) {
+      count += archetype->GetEntityCount();
+    }
+
+    return count;
+  }
+
+ private:
+  template <typename Func>
+  static void ForEachRow(const Archetype::Chunk& chunk, Func& func,
+                         Ts*... columns) {
+    for (std::uint32_t slot = 0; slot < chunk.count; ++slot) {
+      func(*chunk.owners[slot], columns[slot]...);
+    }
+  }
+
+  /**Matching archetypes, owned and kept current by the storage. */
+  const std::vector<Archetype*>* m_archetypes;
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "GameObject.h"
+#include "core/EntityHandle.h"
+
+class Scene;
+
+/**
+ * @struct PendingEntity
+ * @brief Refers to an object whose creation is queued in a command buffer.
+ *
+ * Only meaningful to the buffer that returned it, until its next flush: the
+ * id indexes the objects created by that flush, and `batch` tells which one.
+ * Commands recorded for a pending entity of an earlier batch are dropped,
+ * including those recorded by initializers while its own batch is applied.
+ * Keep the object's EntityHandle instead to refer to it later.
+ */
+struct PendingEntity {
+  std::uint32_t id{0};
+  /**Flush the entity belongs to; 0 is never a valid batch. */
+  std::uint32_t batch{0};
+};
+
+/**
+ * @class EntityCommandBuffer
+ * @brief Queues structural changes to a scene and applies them in one batch.
+ *
+ * Creating or destroying objects and adding or removing components moves data
+ * between archetypes and reorders the hierarchy, which would invalidate any
+ * iteration in progress. Code running during an update or while walking the
+ * scene records the change here instead; Scene::Update() flushes the buffer
+ * before touching any component.
+ *
+ * Recording is thread-safe. Flushing runs on the main thread: creations and
+ * component changes in recording order, then every destruction in a single
+ * bulk removal.
+ */
+class EntityCommandBuffer {
+ public:
+  EntityCommandBuffer() = default;
+
+  EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+  EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+  EntityCommandBuffer(EntityCommandBuffer&&) = delete;
+  EntityCommandBuffer& operator=(EntityCommandBuffer&&) = delete;
+
+  /**
+   * @brief Queues the creation of a GameObject.
+   *
+   * @param name The name of the new GameObject.
+   * @param initialize Called with the new object once it exists, may be empty.
+   * @return A reference usable with the other commands of this buffer.
+   */
+  PendingEntity Create(std::string name,
+                       std::function<void(GameObject&)> initialize = nullptr);
+
+  /**
+   * @brief Queues the destruction of a GameObject.
+   *
+   * Destructions are applied last, so other commands recorded for the same
+   * object in this batch still run.
+   */
+  void Destroy(EntityHandle handle);
+
+  /**
+   * @brief Queues adding a component, constructed from copies of `args`.
+   *
+   * @tparam T The component type, not TransformComponent.
+   */
+  template <typename T, typename... Args>
+  void AddComponent(EntityHandle handle, Args&&... args) {
+    Record(CommandType::AddComponent, handle, {NoPending},
+           MakeAddComponent<T>(std::forward<Args>(args)...));
+  }
+
+  /**
+   * @brief Queues adding a component to an object created in this batch.
+   *
+   * Dropped if `entity` comes from an earlier batch.
+   */
+  template <typename T, typename... Args>
+  void AddComponent(PendingEntity entity, Args&&... args) {
+    Record(CommandType::AddComponent, {}, entity,
+           MakeAddComponent<T>(std::forward<Args>(args)...));
+  }
+
+  /**
+   * @brief Queues removing a component.
+   *
+   * @tparam T The component type, not TransformComponent.
+   */
+  template <typename T>
+  void RemoveComponent(EntityHandle handle) {
+    static_assert(!std::is_same_v<T, TransformComponent>,
+                  "The TransformComponent cannot be removed");
+    Record(CommandType::RemoveComponent, handle, {NoPending},
+           [](GameObject& object) { object.RemoveComponent<T>(); });
+  }
+
+  /**
+   * @brief Applies and clears every queued command.
+   *
+   * Commands recorded while flushing are kept for the next flush. Commands
+   * whose target was already destroyed are dropped. Every PendingEntity
+   * returned so far expires.
+   *
+   * @param scene The scene the commands were recorded for.
+   */
+  void Flush(Scene& scene);
+
+  [[nodiscard]] bool IsEmpty() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_commands.empty();
+  }
+
+ private:
+  static constexpr std::uint32_t NoPending = UINT32_MAX;
+
+  enum class CommandType : std::uint8_t {
+    Create,
+    Destroy,
+    AddComponent,
+    RemoveComponent
+  };
+
+  struct Command {
+    CommandType type;
+    /**Target that already exists, when `pending` is NoPending. */
+    EntityHandle handle;
+    /**Target created earlier in the same batch. */
+    std::uint32_t pending{NoPending};
+    /**Name of the object to create. */
+    std::string name;
+    /**Component change, or the initializer of a created object. */
+    std::function<void(GameObject&)> apply;
+  };
+
+  template <typename T, typename... Args>
+  static std::function<void(GameObject&)> MakeAddComponent(Args&&... args) {
+    static_assert(!std::is_same_v<T, TransformComponent>,
+                  "Every GameObject already has a TransformComponent");
+    return [arguments = std::make_tuple(std::forward<Args>(args)...)](
+               GameObject& object) mutable {
+      std::apply(
+          [&object](auto&&... values) {
+            object.AddComponent<T>(std::move(values)...);
+          },
+          std::move(arguments));
+    };
+  }
+
+  /** Appends a command, or drops it if `pending` has expired. */
+  void Record(CommandType type, EntityHandle handle, PendingEntity pending,
+              std::function<void(GameObject&)> apply);
+
+  mutable std::mutex m_mutex;
+  std::vector<Command> m_commands;
+  std::uint32_t m_pendingCount{0};
+  /**Serial of the batch being recorded, stamped on its pending entities. */
+  std::uint32_t m_batch{1};
+
+  /**Commands being applied; kept to reuse its capacity. */
+  std::vector<Command> m_executing;
+  /**Handle of each pending entity of the batch being applied. */
+  std::vector<EntityHandle> m_created;
+  std::vector<EntityHandle> m_destroyed;
+};
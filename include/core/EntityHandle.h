@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @struct EntityHandle
+ * @brief Weak, trivially copyable reference to a GameObject.
+ *
+ * A handle is a slot index in the scene's EntityTable plus the generation
+ * the slot had when the object was created. Destroying the object bumps the
+ * generation, so handles kept around afterwards resolve to nullptr instead
+ * of dangling or aliasing the slot's next occupant.
+ *
+ * The default-constructed handle is null: generation 0 is never issued.
+ */
+struct EntityHandle {
+  std::uint32_t index{0};
+  std::uint32_t generation{0};
+
+  [[nodiscard]] bool IsNull() const { return generation == 0; }
+
+  friend bool operator==(EntityHandle a, EntityHandle b) {
+    return a.index == b.index && a.generation == b.generation;
+  }
+
+  friend bool operator!=(EntityHandle a, EntityHandle b) { return !(a == b); }
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "GameObject.h"
+#include "core/EntityHandle.h"
+#include "core/PoolAllocator.h"
+
+/**
+ * @class EntityTable
+ * @brief Owns the GameObjects of a scene and resolves EntityHandles to them.
+ *
+ * Slots are recycled through a free list; each reuse bumps the slot's
+ * generation. Resolving a handle is an index plus a compare, with no locks or
+ * atomics, so it is safe from worker threads as long as no object is created
+ * or destroyed meanwhile.
+ *
+ * The objects themselves come from an ObjectPool, so spawning and destroying
+ * at a steady rate reuses the same memory.
+ */
+class EntityTable {
+ public:
+  EntityTable() = default;
+
+  ~EntityTable() {
+    for (Slot& slot : m_slots) {
+      if (slot.object != nullptr) {
+        m_objects.Destroy(slot.object);
+      }
+    }
+  }
+
+  EntityTable(const EntityTable&) = delete;
+  EntityTable& operator=(const EntityTable&) = delete;
+  EntityTable(EntityTable&&) = delete;
+  EntityTable& operator=(EntityTable&&) = delete;
+
+  /**
+   * @brief Constructs a GameObject in a free slot.
+   *
+   * @param args Arguments forwarded to the GameObject constructor.
+   * @return The new object, which already knows its handle.
+   */
+  template <typename... Args>
+  GameObject& Create(Args&&... args) {
+    std::uint32_t index;
+
+    if (!m_freeSlots.empty()) {
+      index = m_freeSlots.back();
+      m_freeSlots.pop_back();
+    } else {
+      index = static_cast<std::uint32_t>(m_slots.size());
+      m_slots.emplace_back();
+    }
+
+    Slot& slot = m_slots[index];
+    slot.object = m_objects.Create(std::forward<Args>(args)...);
+    slot.object->m_handle = {index, slot.generation};
+    ++m_count;
+
+    return *slot.object;
+  }
+
+  /**
+   * @brief Destroys the object a handle refers to.
+   *
+   * @return false if the handle was already stale.
+   */
+  bool Destroy(EntityHandle handle) {
+    if (Get(handle) == nullptr) {
+      return false;
+    }
+
+    Slot& slot = m_slots[handle.index];
+    // Invalidate the handle first, so code run by the destructor sees the
+    // object as gone.
+    GameObject* object = slot.object;
+    slot.object = nullptr;
+    if (++slot.generation == 0) {
+      slot.generation = 1;
+    }
+    m_freeSlots.push_back(handle.index);
+    --m_count;
+
+    m_objects.Destroy(object);
+    return true;
+  }
+
+  /**
+   * @brief Resolves a handle.
+   *
+   * @return The object, or nullptr if the handle is null or stale.
+   */
+  [[nodiscard]] GameObject* Get(EntityHandle handle) const {
+    if (handle.index >= m_slots.size()) {
+      return nullptr;
+    }
+
+    const Slot& slot = m_slots[handle.index];
+    return slot.generation == handle.generation ? slot.object : nullptr;
+  }
+
+  [[nodiscard]] bool IsAlive(EntityHandle handle) const {
+    return Get(handle) != nullptr;
+  }
+
+  /**
+   * @brief Number of live objects.
+   */
+  [[nodiscard]] std::size_t GetCount() const { return m_count; }
+
+  /**
+   * @brief Usage of the pool the objects are allocated from.
+   */
+  [[nodiscard]] const PoolStats& GetStats() const {
+    return m_objects.GetStats();
+  }
+
+ private:
+  struct Slot {
+    GameObject* object{nullptr};
+    std::uint32_t generation{1};
+  };
+
+  ObjectPool<GameObject> m_objects;
+  std::vector<Slot> m_slots;
+  std::vector<std::uint32_t> m_freeSlots;
+  std::size_t m_count{0};
+};
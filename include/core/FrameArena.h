@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class LinearArena
+ * @brief Bump allocator over one block, released all at once by Reset().
+ *
+ * Allocating is an align and an add. Requests that do not fit fall back to
+ * the heap for the rest of the frame; the next Reset() then grows the block to
+ * the peak usage, so a steady workload stops touching the heap after one
+ * frame.
+ */
+class LinearArena {
+ public:
+  explicit LinearArena(std::size_t capacity);
+  ~LinearArena();
+
+  LinearArena(const LinearArena&) = delete;
+  LinearArena& operator=(const LinearArena&) = delete;
+  LinearArena(LinearArena&&) = delete;
+  LinearArena& operator=(LinearArena&&) = delete;
+
+  /**
+   * @brief Reserves uninitialized memory, valid until the next Reset().
+   *
+   * @param size Number of bytes.
+   * @param alignment Alignment of the result, a power of two.
+   */
+  void* Allocate(std::size_t size, std::size_t alignment);
+
+  /**
+   * @brief Releases every allocation, growing the block if it overflowed.
+   */
+  void Reset();
+
+  [[nodiscard]] std::size_t GetCapacity() const { return m_capacity; }
+
+  /**
+   * @brief Bytes handed out since the last Reset(), overflow included.
+   */
+  [[nodiscard]] std::size_t GetUsed() const {
+    return m_offset + m_overflowBytes;
+  }
+
+  /**
+   * @brief Heap allocations made by the arena since it was created.
+   */
+  [[nodiscard]] std::uint64_t GetHeapAllocationCount() const {
+    return m_heapAllocations;
+  }
+
+ private:
+  struct Overflow {
+    void* memory;
+    std::size_t alignment;
+  };
+
+  std::byte* m_buffer{nullptr};
+  std::size_t m_capacity{0};
+  std::size_t m_offset{0};
+  /**Allocations that did not fit in m_buffer this frame. */
+  std::vector<Overflow> m_overflow;
+  std::size_t m_overflowBytes{0};
+  std::uint64_t m_heapAllocations{0};
+};
+
+/**
+ * @class FrameArena
+ * @brief Two LinearArenas used on alternate frames.
+ *
+ * Memory allocated during a frame stays valid until the end of the next one,
+ * so data built for a frame can still be read while the following frame is
+ * being prepared. The arena is not thread-safe; it belongs to the main
+ * thread.
+ */
+class FrameArena {
+ public:
+  /** Capacity of each of the two arenas before any growth. */
+  static constexpr std::size_t DefaultCapacity = 256 * 1024;
+
+  explicit FrameArena(std::size_t capacity = DefaultCapacity);
+
+  /**
+   * @brief Switches to the other arena and releases what it held.
+   *
+   * Called once at the start of every frame.
+   */
+  void BeginFrame();
+
+  void* Allocate(std::size_t size, std::size_t alignment) {
+    return m_arenas[m_current].Allocate(size, alignment);
+  }
+
+  template <typename T>
+  T* AllocateArray(std::size_t count) {
+    return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  /**
+   * @brief printf-style formatting into arena memory.
+   *
+   * @return A null-terminated string valid until the next frame ends.
+   */
+  const char* Format(const char* format, ...)
+#if defined(__GNUC__)
+      __attribute__((format(printf, 2, 3)))
+#endif
+      ;
+
+  /**
+   * @brief Heap allocations made by both arenas since they were created.
+   */
+  [[nodiscard]] std::uint64_t GetHeapAllocationCount() const {
+    return m_arenas[0].GetHeapAllocationCount() +
+           m_arenas[1].GetHeapAllocationCount();
+  }
+
+  [[nodiscard]] const LinearArena& GetCurrentArena() const {
+    return m_arenas[m_current];
+  }
+
+ private:
+  LinearArena m_arenas[2];
+  std::size_t m_current{0};
+};
+
+/**
+ * @class ArenaAllocator
+ * @brief STL allocator drawing from a FrameArena.
+ *
+ * deallocate() is a no-op: memory comes back when the arena is reset, so
+ * containers using it must not outlive the frame after the one that built
+ * them. Reserve up front, since reallocations leave the old buffer unused.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(FrameArena& arena) noexcept : m_arena(&arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+      : m_arena(other.m_arena) {}
+
+  T* allocate(std::size_t count) { return m_arena->AllocateArray<T>(count); }
+
+  void deallocate(T* /*pointer*/, std::size_t /*count*/) noexcept {}
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const noexcept {
+    return m_arena == other.m_arena;
+  }
+
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+    return m_arena != other.m_arena;
+  }
+
+ private:
+  template <typename U>
+  friend class ArenaAllocator;
+
+  FrameArena* m_arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+using ArenaString =
+    std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
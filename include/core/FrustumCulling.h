@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "core/Bounds.h"
+
+/**
+ * @struct SphereSoA
+ * @brief Structure-of-arrays view over bounding spheres.
+ *
+ * Every pointer addresses `count` floats.
+ */
+struct SphereSoA {
+  const float* centerX;
+  const float* centerY;
+  const float* centerZ;
+  const float* radius;
+};
+
+/**
+ * @brief Tests `count` spheres against the six planes of a frustum.
+ *
+ * Four spheres are tested per iteration with SSE, one plane at a time,
+ * stopping early once all four are outside. Spheres crossing a plane count
+ * as visible.
+ *
+ * @param frustum Planes with normalized normals.
+ * @param spheres World-space spheres.
+ * @param count Number of spheres.
+ * @param visible Receives 1 for each sphere at least partly inside, 0
+ * otherwise.
+ * @return The number of visible spheres.
+ */
+std::size_t CullSpheres(const Frustum& frustum, const SphereSoA& spheres,
+                        std::size_t count, std::uint8_t* visible);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/**
+ * @class GLDeletionQueue
+ * @brief Defers deletion of OpenGL objects to the thread owning the context.
+ *
+ * With a dedicated render thread, meshes may be destroyed by the simulation
+ * thread, which has no current context. Their ids are queued here and deleted
+ * by Flush(), called by the renderer once per frame.
+ */
+class GLDeletionQueue {
+ public:
+  GLDeletionQueue() = delete;
+
+  /** Queues a vertex array object; safe to call from any thread. */
+  static void DeleteVertexArray(GLuint id);
+
+  /** Queues a buffer object; safe to call from any thread. */
+  static void DeleteBuffer(GLuint id);
+
+  /**
+   * @brief Deletes every queued object.
+   *
+   * Must run on the thread whose OpenGL context is current.
+   */
+  static void Flush();
+};
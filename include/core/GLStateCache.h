@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+/**
+ * @struct RenderStats
+ * @brief State changes and draws issued during a frame.
+ */
+struct RenderStats {
+  std::uint32_t drawCalls{0};
+  std::uint32_t programSwitches{0};
+  std::uint32_t vertexArraySwitches{0};
+};
+
+/**
+ * @class GLStateCache
+ * @brief Remembers the bound program and vertex array to skip redundant
+ * binds, and counts the ones that go through.
+ *
+ * Only sees the binds made through it. Code binding objects behind its back
+ * must restore them, as ImGui's backend does, or call Invalidate().
+ */
+class GLStateCache {
+ public:
+  /**
+   * @brief Binds a program unless it is already bound.
+   *
+   * @return True if the program changed.
+   */
+  bool UseProgram(GLuint program) {
+    if (program == m_program) {
+      return false;
+    }
+
+    glUseProgram(program);
+    m_program = program;
+    ++m_stats.programSwitches;
+    return true;
+  }
+
+  /**
+   * @brief Binds a vertex array unless it is already bound.
+   *
+   * @return True if the vertex array changed.
+   */
+  bool BindVertexArray(GLuint vertexArray) {
+    if (vertexArray == m_vertexArray) {
+      return false;
+    }
+
+    glBindVertexArray(vertexArray);
+    m_vertexArray = vertexArray;
+    ++m_stats.vertexArraySwitches;
+    return true;
+  }
+
+  void CountDraw() { ++m_stats.drawCalls; }
+
+  /**
+   * @brief Forgets the bound vertex array, so the next bind is issued.
+   */
+  void InvalidateVertexArray() { m_vertexArray = Unknown; }
+
+  /**
+   * @brief Forgets every binding.
+   */
+  void Invalidate() {
+    m_program = Unknown;
+    m_vertexArray = Unknown;
+  }
+
+  [[nodiscard]] const RenderStats& GetStats() const { return m_stats; }
+
+  void ResetStats() { m_stats = RenderStats(); }
+
+ private:
+  /**Never a valid object name, so the first bind always goes through. */
+  static constexpr GLuint Unknown = ~GLuint{0};
+
+  GLuint m_program{Unknown};
+  GLuint m_vertexArray{Unknown};
+  RenderStats m_stats;
+};
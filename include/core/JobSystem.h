@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "core/PoolAllocator.h"
+
+/**
+ * @class JobSystem
+ * @brief Engine-wide work-stealing job scheduler.
+ *
+ * Every worker owns a deque: it pushes and pops its own jobs at the back
+ * (LIFO, cache friendly) while idle workers steal from the front of the
+ * others. The thread that creates the JobSystem is worker 0 and executes jobs
+ * while it waits, so it is never idle either.
+ *
+ * Other threads, such as the render thread, own no deque: their jobs go to a
+ * shared submission queue that workers drain in FIFO order before stealing.
+ * Waiting on any thread runs queued jobs, and only sleeps when there is
+ * nothing left to help with.
+ *
+ * A job finishes once its task and all its children have run; at that point
+ * its continuations are scheduled and its parent is notified.
+ *
+ * Scheduling does not touch the heap once warmed up: jobs come from a pool,
+ * tasks are stored inside them, and the deques are ring buffers that only
+ * grow to the peak number of queued jobs.
+ */
+class JobSystem {
+ public:
+  struct Job;
+
+  /**
+   * @class JobHandle
+   * @brief Counted reference to a pooled Job.
+   *
+   * The job returns to its system's pool with the last handle, which must
+   * therefore not outlive the JobSystem.
+   */
+  class JobHandle {
+   public:
+    JobHandle() = default;
+    JobHandle(std::nullptr_t) {}
+    JobHandle(const JobHandle& other);
+    JobHandle(JobHandle&& other) noexcept
+        : m_job(std::exchange(other.m_job, nullptr)) {}
+    JobHandle& operator=(JobHandle other) noexcept {
+      std::swap(m_job, other.m_job);
+      return *this;
+    }
+    ~JobHandle();
+
+    Job* operator->() const { return m_job; }
+    explicit operator bool() const { return m_job != nullptr; }
+    bool operator==(std::nullptr_t) const { return m_job == nullptr; }
+    bool operator!=(std::nullptr_t) const { return m_job != nullptr; }
+
+   private:
+    friend class JobSystem;
+
+    /** Takes over a reference the caller already holds. */
+    static JobHandle Adopt(Job* job) {
+      JobHandle handle;
+      handle.m_job = job;
+      return handle;
+    }
+
+    /** Gives up the reference without releasing it. */
+    Job* Detach() { return std::exchange(m_job, nullptr); }
+
+    Job* m_job{nullptr};
+  };
+
+  /**
+   * @struct Job
+   * @brief A unit of work plus the bookkeeping needed to track completion.
+   */
+  struct Job {
+    /**Bytes a task may occupy; bigger callables do not compile, so capture
+     * large state by reference. */
+    static constexpr std::size_t TaskCapacity = 64;
+
+    /**The callable, constructed in place by CreateJob(). */
+    alignas(std::max_align_t) std::byte task[TaskCapacity];
+    void (*run)(void* task){nullptr};
+    void (*destroy)(void* task){nullptr};
+    JobSystem* owner{nullptr};
+    JobHandle parent;
+    /**The task itself plus every child that has not finished yet. */
+    std::atomic<int> unfinished{1};
+    std::atomic<bool> finished{false};
+    /**Handles to the job; it returns to the pool when this drops to 0. */
+    std::atomic<int> references{1};
+    std::mutex continuationsMutex;
+    /**Jobs run once this one finishes, linked through nextContinuation,
+     * each holding a reference. */
+    Job* continuations{nullptr};
+    Job* nextContinuation{nullptr};
+
+    template <typename Task>
+    [[nodiscard]] Task& GetTask() {
+      return *std::launder(reinterpret_cast<Task*>(task));
+    }
+  };
+
+  /**
+   * @brief Starts the worker threads.
+   *
+   * @param workerCount Number of background workers; 0 picks one per
+   * hardware thread, minus the calling thread.
+   */
+  explicit JobSystem(std::size_t workerCount = 0);
+
+  /**
+   * @brief Stops and joins the workers. Pending jobs are dropped; handles
+   * must not outlive the system.
+   */
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  JobSystem(JobSystem&&) = delete;
+  JobSystem& operator=(JobSystem&&) = delete;
+
+  /**
+   * @brief Creates a job without scheduling it.
+   *
+   * @param task Callable run as task(), stored inside the job, so at most
+   * Job::TaskCapacity bytes. It is destroyed with the job.
+   * @return Handle to the new job.
+   */
+  template <typename Func>
+  JobHandle CreateJob(Func&& task) {
+    using Task = std::decay_t<Func>;
+    static_assert(sizeof(Task) <= Job::TaskCapacity,
+                  "Job tasks are stored inline; capture by reference");
+    static_assert(alignof(Task) <= alignof(std::max_align_t),
+                  "Job tasks must not be over-aligned");
+
+    JobHandle job = AllocateJob();
+    new (job->task) Task(std::forward<Func>(task));
+    job->run = [](void* storage) {
+      (*std::launder(static_cast<Task*>(storage)))();
+    };
+    job->destroy = [](void* storage) {
+      std::launder(static_cast<Task*>(storage))->~Task();
+    };
+    return job;
+  }
+
+  /**
+   * @brief Creates a job with no task, e.g. a parent only grouping children.
+   */
+  JobHandle CreateJob() { return AllocateJob(); }
+
+  /**
+   * @brief Creates a job that `parent` waits for.
+   *
+   * Must be called before the parent is finished, typically before it is run
+   * or from inside its task.
+   *
+   * @param parent The job that completes only after this one.
+   * @param task The work to run, as for CreateJob().
+   * @return Handle to the new job.
+   */
+  template <typename Func>
+  JobHandle CreateChildJob(const JobHandle& parent, Func&& task) {
+    parent->unfinished.fetch_add(1);
+
+    JobHandle job = CreateJob(std::forward<Func>(task));
+    job->parent = parent;
+    return job;
+  }
+
+  /**
+   * @brief Schedules `continuation` to run once `job` has finished.
+   *
+   * If `job` is already finished the continuation is scheduled immediately.
+   * Continuations of the same job run in no particular order.
+   *
+   * @param job The antecedent job.
+   * @param continuation A job that has not been run yet, nor been made the
+   * continuation of another job.
+   */
+  void AddContinuation(const JobHandle& job, JobHandle continuation);
+
+  /**
+   * @brief Pushes a job on the calling worker's deque, or on the submission
+   * queue when called from a thread that is not a worker.
+   *
+   * @param job The job to schedule.
+   */
+  void Run(JobHandle job);
+
+  /**
+   * @brief Blocks until a job has finished, executing other jobs meanwhile.
+   *
+   * Sleeps while no job is queued anywhere, until one is or `job` finishes.
+   *
+   * @param job The job to wait for.
+   */
+  void Wait(const JobHandle& job);
+
+  /**
+   * @brief Splits [0, count) into batches run as children of one job.
+   *
+   * @param count Number of items.
+   * @param batchSize Items per job, at least 1.
+   * @param func Called as func(begin, end) for every batch. Kept in the
+   * parent job, so at most Job::TaskCapacity bytes.
+   * @return The scheduled parent job, so callers can wait on it or chain
+   * continuations.
+   */
+  template <typename Func>
+  JobHandle ParallelForAsync(std::size_t count, std::size_t batchSize,
+                             Func func) {
+    batchSize = std::max<std::size_t>(batchSize, 1);
+
+    // Every batch holds a reference to the root, so the function stored in
+    // it outlives them.
+    JobHandle root = CreateJob(BatchFunction<Func>{std::move(func)});
+    const Func* shared = &root->GetTask<BatchFunction<Func>>().func;
+
+    for (std::size_t begin = 0; begin < count; begin += batchSize) {
+      std::size_t end = std::min(begin + batchSize, count);
+      Run(CreateChildJob(root,
+                         [shared, begin, end]() { (*shared)(begin, end); }));
+    }
+
+    Run(root);
+    return root;
+  }
+
+  /**
+   * @brief Blocking variant of ParallelForAsync().
+   */
+  template <typename Func>
+  void ParallelFor(std::size_t count, std::size_t batchSize, Func func) {
+    if (count == 0) {
+      return;
+    }
+
+    // A single batch is not worth a trip through the deques.
+    if (count <= batchSize || m_workers.empty()) {
+      func(std::size_t{0}, count);
+      return;
+    }
+
+    // The batches may borrow `func`: Wait() returns after the last one.
+    Wait(ParallelForAsync(count, batchSize,
+                          [&func](std::size_t begin, std::size_t end) {
+                            func(begin, end);
+                          }));
+  }
+
+  /**
+   * @brief Number of threads executing jobs, including the owning thread.
+   */
+  [[nodiscard]] std::size_t GetThreadCount() const { return m_queues.size(); }
+
+ private:
+  /**Slots every queue starts with; it only grows past a deeper backlog. */
+  static constexpr std::size_t InitialQueueCapacity = 256;
+  /**Jobs the pool allocates at once when it runs dry. */
+  static constexpr std::size_t JobsPerPage = 256;
+
+  /**
+   * @struct WorkQueue
+   * @brief A worker's deque. The owner uses the back, thieves the front.
+   *
+   * A ring buffer of jobs, each slot holding a reference.
+   */
+  struct WorkQueue {
+    WorkQueue() : jobs(InitialQueueCapacity) {}
+
+    void PushBack(Job* job);
+    Job* PopBack();
+    Job* PopFront();
+
+    std::mutex mutex;
+    std::vector<Job*> jobs;
+    std::size_t head{0};
+    std::size_t count{0};
+  };
+
+  /**
+   * @struct BatchFunction
+   * @brief Task of a ParallelForAsync() parent: runs nothing, only keeps
+   * the function its batches call.
+   */
+  template <typename Func>
+  struct BatchFunction {
+    Func func;
+    void operator()() const {}
+  };
+
+  /** Takes a job from the pool, with one reference. */
+  JobHandle AllocateJob();
+
+  /** Destroys a job whose last reference was released. */
+  void DestroyJob(Job* job);
+
+  /**Queue index of threads that are not workers of this system. */
+  static constexpr std::size_t ExternalQueueIndex =
+      static_cast<std::size_t>(-1);
+
+  void WorkerLoop(std::size_t index);
+
+  /** Pops a job from the caller's deque, then from the submission queue,
+   * or steals one from another worker. */
+  JobHandle FetchJob(std::size_t index);
+
+  void Execute(const JobHandle& job);
+
+  /** Marks one unit of `job` done and propagates completion upwards. */
+  void Finish(const JobHandle& job);
+
+  /** Index of the calling thread's deque, or ExternalQueueIndex. */
+  [[nodiscard]] std::size_t GetQueueIndex() const;
+
+  /**Storage of every job; shared by all threads, hence the mutex. */
+  std::mutex m_jobPoolMutex;
+  PoolAllocator m_jobPool{sizeof(Job), alignof(Job), JobsPerPage};
+
+  std::vector<std::unique_ptr<WorkQueue>> m_queues;
+  /**Jobs run by threads that are not workers, oldest at the front. */
+  WorkQueue m_externalQueue;
+  std::vector<std::thread> m_workers;
+
+  /**Jobs pushed but not yet fetched; workers sleep while it is zero. */
+  std::atomic<std::size_t> m_pendingJobs{0};
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wakeCondition;
+  /**Threads sleeping in Wait(); finished jobs only notify while non-zero. */
+  std::atomic<std::size_t> m_waitingThreads{0};
+  std::atomic<bool> m_stopping{false};
+};
+
+inline JobSystem::JobHandle::JobHandle(const JobHandle& other)
+    : m_job(other.m_job) {
+  if (m_job != nullptr) {
+    m_job->references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+inline JobSystem::JobHandle::~JobHandle() {
+  if (m_job != nullptr &&
+      m_job->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    m_job->owner->DestroyJob(m_job);
+  }
+}
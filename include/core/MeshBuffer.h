@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include "core/Span.h"
+
+/**
+ * @struct DrawElementsIndirectCommand
+ * @brief One draw of glMultiDrawElementsIndirect(), in the layout GL reads.
+ */
+struct DrawElementsIndirectCommand {
+  GLuint count;
+  GLuint instanceCount;
+  GLuint firstIndex;
+  GLint baseVertex;
+  GLuint baseInstance;
+};
+
+/**
+ * @struct MeshAllocation
+ * @brief Where a mesh lives in the mesh buffer.
+ */
+struct MeshAllocation {
+  /**First vertex; the mesh's indices are relative to it. */
+  GLint baseVertex{0};
+  GLuint firstIndex{0};
+  GLuint vertexCount{0};
+  GLuint indexCount{0};
+
+  [[nodiscard]] bool IsValid() const { return indexCount != 0; }
+};
+
+/**
+ * @class MeshBuffer
+ * @brief One vertex buffer and one index buffer shared by every mesh.
+ *
+ * Meshes are suballocated into the two buffers, which are described by a
+ * single vertex array, so any number of meshes can be drawn with one
+ * glMultiDrawElementsIndirect() call. Vertices are stored in one format:
+ * position, normal and texture coordinates, zero when a mesh has none.
+ *
+ * The buffers double in size when a mesh does not fit; the old content is
+ * copied on the GPU.
+ *
+ * The vertex array also has one per-instance attribute, an unsigned integer
+ * at InstanceIndexLocation. An instanced draw reads it at baseInstance +
+ * gl_InstanceID, so every command of a multi-draw can name its own instances
+ * without gl_DrawID, which needs OpenGL 4.6.
+ */
+class MeshBuffer {
+ public:
+  /**Floats per vertex in the shared vertex buffer. */
+  static constexpr int VertexStride = 8;
+  /**Attribute location of the per-instance index. */
+  static constexpr GLuint InstanceIndexLocation = 3;
+
+  MeshBuffer() = delete;
+
+  /**
+   * @brief Copies a mesh into the buffers.
+   *
+   * Must run on the thread whose OpenGL context is current.
+   *
+   * @param vertices Interleaved vertices: position, normal, then optional
+   * texture coordinates.
+   * @param stride Floats per vertex in `vertices`, 6 or 8.
+   * @param indices Triangle list, relative to the mesh's first vertex.
+   * @return The ranges of the mesh, invalid if it has no triangles.
+   */
+  static MeshAllocation Allocate(Span<const float> vertices, int stride,
+                                 Span<const unsigned int> indices);
+
+  /**
+   * @brief Returns the ranges of a mesh; safe to call from any thread.
+   */
+  static void Free(const MeshAllocation& allocation);
+
+  /**
+   * @brief The vertex array reading both buffers, created on first use.
+   *
+   * Must run on the thread whose OpenGL context is current.
+   */
+  static GLuint GetVertexArray();
+
+  /**
+   * @brief Sources the per-instance index from `buffer`, one GLuint per
+   * instance starting at `offset`.
+   *
+   * Must run on the thread whose OpenGL context is current.
+   */
+  static void BindInstanceIndices(GLuint buffer, GLintptr offset);
+
+  /**
+   * @brief Bytes of both buffers in use by meshes.
+   */
+  static std::size_t GetUsedBytes();
+
+  /**
+   * @brief Bytes of both buffers, used or not.
+   */
+  static std::size_t GetCapacityBytes();
+
+  /**
+   * @brief Deletes the OpenGL objects. Meshes may still free their ranges.
+   *
+   * Must run on the thread whose OpenGL context is current.
+   */
+  static void Shutdown();
+};
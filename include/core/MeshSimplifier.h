@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "core/Span.h"
+
+/**
+ * @brief Reduces a triangle list with quadric error metric edge collapses.
+ *
+ * Garland and Heckbert's method, restricted to collapsing a vertex onto one
+ * of its neighbours: the result only references existing vertices, so every
+ * level of detail can share one vertex buffer. Vertices sharing a position,
+ * such as the copies along a normal or UV seam, are simplified together.
+ * Vertices on open borders never move, and collapses that would flip a
+ * triangle are rejected.
+ *
+ * @param vertices Interleaved vertices, position first.
+ * @param stride Floats per vertex.
+ * @param indices Triangle list to simplify.
+ * @param targetIndexCount Stop once at most this many indices remain.
+ * @param maxError Largest deviation allowed, as a fraction of the diagonal
+ * of the mesh's bounding box; collapsing stops before exceeding it.
+ * @return The simplified triangle list, possibly larger than the target.
+ */
+std::vector<unsigned int> SimplifyMesh(const std::vector<float>& vertices,
+                                       int stride,
+                                       Span<const unsigned int> indices,
+                                       std::size_t targetIndexCount,
+                                       float maxError);
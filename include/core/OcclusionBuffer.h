@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "core/Bounds.h"
+
+class JobSystem;
+
+/**
+ * @class OcclusionBuffer
+ * @brief Low-resolution software depth buffer for occlusion culling.
+ *
+ * Each frame a few large occluders are rasterized on the CPU, their depth
+ * reduced into a hierarchical-Z pyramid whose texels hold the farthest depth
+ * below them, and the screen rectangle of each candidate box is compared
+ * against the level where it covers at most 2x2 texels. A box whose nearest
+ * point is behind everything drawn there is hidden.
+ *
+ * Depth is window depth in [0, 1], 1 being the far plane. Triangles crossing
+ * the near plane are dropped, which only makes occluders smaller, and boxes
+ * crossing it are always visible, so the test never hides a visible object.
+ */
+class OcclusionBuffer {
+ public:
+  static constexpr int Width = 256;
+  static constexpr int Height = 128;
+  /**Rows rasterized by one job. */
+  static constexpr int BandHeight = 16;
+
+  OcclusionBuffer();
+
+  OcclusionBuffer(const OcclusionBuffer&) = delete;
+  OcclusionBuffer& operator=(const OcclusionBuffer&) = delete;
+  OcclusionBuffer(OcclusionBuffer&&) = delete;
+  OcclusionBuffer& operator=(OcclusionBuffer&&) = delete;
+
+  /**
+   * @brief Clears the depth buffer and the queued occluders.
+   */
+  void Clear();
+
+  /**
+   * @brief Queues the triangles of an indexed mesh as an occluder.
+   *
+   * @param vertices Interleaved vertices, position first.
+   * @param stride Floats per vertex.
+   * @param indices Triangle list.
+   * @param modelViewProjection Transform from the mesh to clip space.
+   */
+  void AddOccluder(const std::vector<float>& vertices, int stride,
+                   const std::vector<unsigned int>& indices,
+                   const glm::mat4& modelViewProjection);
+
+  /**
+   * @brief Rasterizes the queued occluders and builds the depth pyramid.
+   *
+   * @param jobSystem Workers to rasterize bands of rows on, or nullptr to
+   * run serially.
+   */
+  void Rasterize(JobSystem* jobSystem);
+
+  /**
+   * @brief Tests a world-space box against the depth pyramid.
+   *
+   * Safe to call from several threads once Rasterize() returned.
+   *
+   * @param box The box to test.
+   * @param viewProjection Transform from world to clip space.
+   * @return False only if the box is entirely behind the occluders.
+   */
+  [[nodiscard]] bool IsVisible(const Aabb& box,
+                               const glm::mat4& viewProjection) const;
+
+  [[nodiscard]] std::size_t GetTriangleCount() const {
+    return m_triangles.size();
+  }
+
+ private:
+  /**
+   * @struct Triangle
+   * @brief A screen-space triangle set up for edge-function rasterization.
+   *
+   * Edge i is positive inside: A[i] * x + B[i] * y + C[i] >= 0, and depth is
+   * the plane depthA * x + depthB * y + depthC.
+   */
+  struct Triangle {
+    float edgeA[3];
+    float edgeB[3];
+    float edgeC[3];
+    float depthA;
+    float depthB;
+    float depthC;
+    /**Inclusive pixel bounds, clamped to the buffer. */
+    int minX;
+    int maxX;
+    int minY;
+    int maxY;
+  };
+
+  /** Rasterizes every triangle over the rows [firstRow, lastRow). */
+  void RasterizeRows(int firstRow, int lastRow);
+
+  /** Reduces each pyramid level from the one below it. */
+  void BuildPyramid();
+
+  std::vector<Triangle> m_triangles;
+  /**Scratch screen-space positions of the occluder being added. */
+  std::vector<glm::vec4> m_screenVertices;
+  /**Depth pyramid; level 0 is the full-resolution buffer. */
+  std::vector<std::vector<float>> m_levels;
+  std::vector<int> m_levelWidths;
+  std::vector<int> m_levelHeights;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct PoolStats
+ * @brief Usage counters of a pool.
+ */
+struct PoolStats {
+  /**Blocks allocated from the system. */
+  std::size_t capacity{0};
+  /**Blocks currently handed out. */
+  std::size_t liveCount{0};
+  /**Largest liveCount seen so far. */
+  std::size_t highWaterMark{0};
+};
+
+/**
+ * @class PoolAllocator
+ * @brief Hands out fixed-size blocks carved from larger pages.
+ *
+ * Freed blocks go on an intrusive free list and are reused before a new page
+ * is requested, so spawning and destroying objects at a steady rate does not
+ * touch the system allocator. Pages are only released with the pool.
+ */
+class PoolAllocator {
+ public:
+  /**
+   * @param blockSize Size of every block in bytes.
+   * @param alignment Alignment of every block, a power of two.
+   * @param blocksPerPage Blocks allocated at once when the free list is empty.
+   */
+  PoolAllocator(std::size_t blockSize, std::size_t alignment,
+                std::size_t blocksPerPage);
+
+  /**
+   * @brief Releases every page. Blocks still in use are not destroyed.
+   */
+  ~PoolAllocator();
+
+  PoolAllocator(const PoolAllocator&) = delete;
+  PoolAllocator& operator=(const PoolAllocator&) = delete;
+  PoolAllocator(PoolAllocator&&) = delete;
+  PoolAllocator& operator=(PoolAllocator&&) = delete;
+
+  /**
+   * @brief Takes a block from the free list, adding a page if it is empty.
+   *
+   * @return Uninitialized storage of the pool's block size.
+   */
+  void* Allocate();
+
+  /**
+   * @brief Returns a block obtained from Allocate() to the free list.
+   */
+  void Deallocate(void* block);
+
+  [[nodiscard]] const PoolStats& GetStats() const { return m_stats; }
+
+  [[nodiscard]] std::size_t GetBlockSize() const { return m_blockSize; }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  void AddPage();
+
+  std::size_t m_blockSize;
+  std::size_t m_alignment;
+  std::size_t m_blocksPerPage;
+  std::vector<void*> m_pages;
+  FreeBlock* m_freeList{nullptr};
+  PoolStats m_stats;
+};
+
+/**
+ * @class ObjectPool
+ * @brief Typed front end of PoolAllocator that constructs and destroys T.
+ */
+template <typename T>
+class ObjectPool {
+ public:
+  explicit ObjectPool(std::size_t objectsPerPage = 256)
+      : m_allocator(sizeof(T), alignof(T), objectsPerPage) {}
+
+  template <typename... Args>
+  T* Create(Args&&... args) {
+    void* block = m_allocator.Allocate();
+
+    try {
+      return new (block) T(std::forward<Args>(args)...);
+    } catch (...) {
+      m_allocator.Deallocate(block);
+      throw;
+    }
+  }
+
+  void Destroy(T* object) {
+    object->~T();
+    m_allocator.Deallocate(object);
+  }
+
+  [[nodiscard]] const PoolStats& GetStats() const {
+    return m_allocator.GetStats();
+  }
+
+ private:
+  PoolAllocator m_allocator;
+};
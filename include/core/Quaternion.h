@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cmath>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Quaternion helpers shared by the engine and by scripts. Everything is
+// inline, since scripts are compiled separately and cannot link against the
+// engine executable.
+
+/**
+ * @brief Builds a rotation from Euler angles in degrees.
+ *
+ * Uses the engine's convention: rotate around x, then y, then z, which is
+ * the matrix Rx * Ry * Rz.
+ *
+ * @param degrees Rotation around the x, y and z axes.
+ * @return The equivalent unit quaternion.
+ */
+inline glm::quat QuatFromEuler(const glm::vec3& degrees) {
+  glm::vec3 halfAngles = glm::radians(degrees) * 0.5f;
+  glm::quat qx(std::cos(halfAngles.x), std::sin(halfAngles.x), 0.0f, 0.0f);
+  glm::quat qy(std::cos(halfAngles.y), 0.0f, std::sin(halfAngles.y), 0.0f);
+  glm::quat qz(std::cos(halfAngles.z), 0.0f, 0.0f, std::sin(halfAngles.z));
+
+  return qx * qy * qz;
+}
+
+/**
+ * @brief Extracts Euler angles in degrees, inverse of QuatFromEuler().
+ *
+ * At +-90 degrees around y the x and z axes line up; the whole rotation is
+ * then reported around x.
+ *
+ * @param rotation A unit quaternion.
+ * @return Rotation around the x, y and z axes.
+ */
+inline glm::vec3 EulerFromQuat(const glm::quat& rotation) {
+  const float x = rotation.x;
+  const float y = rotation.y;
+  const float z = rotation.z;
+  const float w = rotation.w;
+
+  // Entries of the rotation matrix, named m<row><column>.
+  float m02 = 2.0f * (x * z + w * y);
+  glm::vec3 radians;
+  radians.y = std::asin(glm::clamp(m02, -1.0f, 1.0f));
+
+  if (std::abs(m02) < 0.9999f) {
+    float m00 = 1.0f - 2.0f * (y * y + z * z);
+    float m01 = 2.0f * (x * y - w * z);
+    float m12 = 2.0f * (y * z - w * x);
+    float m22 = 1.0f - 2.0f * (x * x + y * y);
+    radians.x = std::atan2(-m12, m22);
+    radians.z = std::atan2(-m01, m00);
+  } else {
+    float m11 = 1.0f - 2.0f * (x * x + z * z);
+    float m21 = 2.0f * (y * z + w * x);
+    radians.x = std::atan2(m21, m11);
+    radians.z = 0.0f;
+  }
+
+  return glm::degrees(radians);
+}
+
+/**
+ * @brief Normalized linear interpolation along the shortest arc.
+ *
+ * Cheaper than Slerp(): no trigonometry, at the cost of a non-constant
+ * angular speed, which is invisible for small steps such as per-frame
+ * smoothing.
+ *
+ * @param from Rotation at t = 0.
+ * @param to Rotation at t = 1.
+ * @param t Interpolation factor in [0, 1].
+ * @return The interpolated unit quaternion.
+ */
+inline glm::quat Nlerp(const glm::quat& from, const glm::quat& to, float t) {
+  glm::quat target = glm::dot(from, to) < 0.0f ? -to : to;
+  return glm::normalize(from * (1.0f - t) + target * t);
+}
+
+/**
+ * @brief Spherical linear interpolation along the shortest arc.
+ *
+ * Moves at constant angular speed. Nearly parallel inputs fall back to
+ * Nlerp(), which is cheaper and avoids dividing by a vanishing sine.
+ *
+ * @param from Rotation at t = 0.
+ * @param to Rotation at t = 1.
+ * @param t Interpolation factor in [0, 1].
+ * @return The interpolated unit quaternion.
+ */
+inline glm::quat Slerp(const glm::quat& from, const glm::quat& to, float t) {
+  float cosine = glm::dot(from, to);
+  glm::quat target = to;
+
+  if (cosine < 0.0f) {
+    cosine = -cosine;
+    target = -to;
+  }
+
+  if (cosine > 0.9995f) {
+    return glm::normalize(from * (1.0f - t) + target * t);
+  }
+
+  float angle = std::acos(cosine);
+  float inverseSine = 1.0f / std::sin(angle);
+
+  return from * (std::sin((1.0f - t) * angle) * inverseSine) +
+         target * (std::sin(t * angle) * inverseSine);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class RangeAllocator
+ * @brief Hands out ranges of a linear resource, such as elements of a GPU
+ * buffer, without owning any memory itself.
+ *
+ * Free ranges are kept sorted by offset and merged with their neighbours on
+ * release. Allocation is first fit, which keeps long-lived ranges packed at
+ * the start when most of them are allocated up front, as meshes are.
+ */
+class RangeAllocator {
+ public:
+  /**Offset returned when no free range is large enough. */
+  static constexpr std::uint32_t NoRange = ~std::uint32_t{0};
+
+  RangeAllocator() = default;
+
+  /**
+   * @param capacity Size of the managed resource, all of it free.
+   */
+  explicit RangeAllocator(std::uint32_t capacity) { Grow(capacity); }
+
+  /**
+   * @brief Takes `size` units from the first free range that fits.
+   *
+   * @return The offset of the range, or NoRange; a size of 0 always fails.
+   */
+  std::uint32_t Allocate(std::uint32_t size);
+
+  /**
+   * @brief Returns a range obtained from Allocate().
+   */
+  void Free(std::uint32_t offset, std::uint32_t size);
+
+  /**
+   * @brief Extends the resource; the new units are free.
+   *
+   * @param capacity The new size, at least the current one.
+   */
+  void Grow(std::uint32_t capacity);
+
+  [[nodiscard]] std::uint32_t GetCapacity() const { return m_capacity; }
+
+  /**
+   * @brief Units currently handed out.
+   */
+  [[nodiscard]] std::uint32_t GetUsed() const { return m_used; }
+
+ private:
+  /**
+   * @struct Range
+   * @brief A free range.
+   */
+  struct Range {
+    std::uint32_t offset;
+    std::uint32_t size;
+  };
+
+  /**Free ranges by increasing offset, never adjacent. */
+  std::vector<Range> m_free;
+  std::uint32_t m_capacity{0};
+  std::uint32_t m_used{0};
+};
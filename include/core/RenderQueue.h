@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class RenderQueue
+ * @brief Draws of a frame ordered by 64-bit sort keys.
+ *
+ * A key packs, from the most significant bits down, everything that costs a
+ * state change to switch: the pass, the shader, the material, the mesh and
+ * its level of detail, then the view depth. Sorting by key puts draws that
+ * share state next to each other, and draws of the same state front to back
+ * so early depth testing rejects hidden fragments.
+ *
+ * Keys are sorted with a stable LSD radix sort, 8 bits per pass. Passes over
+ * a byte every key shares are skipped, which is most of them when a field is
+ * unused, so a typical frame takes four or five linear passes.
+ */
+class RenderQueue {
+ public:
+  /**
+   * @struct Entry
+   * @brief A sort key and the index of the draw it orders.
+   */
+  struct Entry {
+    std::uint64_t key;
+    std::uint32_t item;
+  };
+
+  static constexpr unsigned DepthBits = 16;
+  static constexpr unsigned LodBits = 4;
+  static constexpr unsigned MeshBits = 24;
+  static constexpr unsigned MaterialBits = 12;
+  static constexpr unsigned ShaderBits = 6;
+  static constexpr unsigned PassBits = 2;
+
+  /**Every field but the depth: draws with equal state bits share a batch. */
+  static constexpr std::uint64_t StateMask =
+      ~((std::uint64_t{1} << DepthBits) - 1);
+
+  /**
+   * @brief Packs the fields of a draw into a key.
+   *
+   * Each field is truncated to its width; a truncated mesh id may make two
+   * meshes compare equal, which only costs batching.
+   */
+  static std::uint64_t MakeKey(std::uint32_t pass, std::uint32_t shader,
+                               std::uint32_t material, std::uint32_t mesh,
+                               std::uint32_t lod, std::uint32_t depth);
+
+  /**
+   * @brief Maps a view depth to the key's depth field, nearest first.
+   *
+   * @param depth Distance along the view direction.
+   * @param nearPlane Depths up to this map to 0.
+   * @param farPlane Depths from this on map to the largest value.
+   */
+  static std::uint32_t QuantizeDepth(float depth, float nearPlane,
+                                     float farPlane);
+
+  RenderQueue() = default;
+
+  RenderQueue(const RenderQueue&) = delete;
+  RenderQueue& operator=(const RenderQueue&) = delete;
+
+  /**
+   * @brief Empties the queue, keeping its storage.
+   */
+  void Clear() { m_entries.clear(); }
+
+  void Reserve(std::size_t count) { m_entries.reserve(count); }
+
+  void Push(std::uint64_t key, std::uint32_t item) {
+    m_entries.push_back({key, item});
+  }
+
+  /**
+   * @brief Sorts the entries by key; equal keys keep their push order.
+   */
+  void Sort();
+
+  [[nodiscard]] const std::vector<Entry>& GetEntries() const {
+    return m_entries;
+  }
+
+ private:
+  std::vector<Entry> m_entries;
+  /**Second buffer of the radix sort, reused every frame. */
+  std::vector<Entry> m_scratch;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class Span
+ * @brief Non-owning view over a contiguous sequence, a minimal std::span.
+ *
+ * The view is invalidated by anything that reallocates or resizes the
+ * underlying storage.
+ */
+template <typename T>
+class Span {
+ public:
+  Span() = default;
+
+  Span(T* data, std::size_t size) : m_data(data), m_size(size) {}
+
+  template <typename U, typename Alloc>
+  Span(const std::vector<U, Alloc>& values)
+      : m_data(values.data()), m_size(values.size()) {}
+
+  template <typename U, typename Alloc>
+  Span(std::vector<U, Alloc>& values)
+      : m_data(values.data()), m_size(values.size()) {}
+
+  [[nodiscard]] T* begin() const { return m_data; }
+  [[nodiscard]] T* end() const { return m_data + m_size; }
+  [[nodiscard]] T* data() const { return m_data; }
+  [[nodiscard]] std::size_t size() const { return m_size; }
+  [[nodiscard]] bool empty() const { return m_size == 0; }
+
+  T& operator[](std::size_t index) const { return m_data[index]; }
+
+ private:
+  T* m_data{nullptr};
+  std::size_t m_size{0};
+};
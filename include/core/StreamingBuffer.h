@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+/**
+ * @struct StreamAllocation
+ * @brief A range of the streaming buffer, written by the CPU this frame.
+ */
+struct StreamAllocation {
+  GLuint buffer{0};
+  /**Offset of the range in `buffer`, in bytes. */
+  GLintptr offset{0};
+  GLsizeiptr size{0};
+  /**Where the CPU writes the range; valid until the end of the frame. */
+  void* data{nullptr};
+
+  [[nodiscard]] bool IsValid() const { return data != nullptr; }
+};
+
+/**
+ * @class StreamingBuffer
+ * @brief Ring buffer for data the GPU reads once, shared by every renderer.
+ *
+ * One buffer is created with glBufferStorage() and stays mapped, persistent
+ * and coherent, for its whole life. It is split into RegionCount regions
+ * used by successive frames: a frame suballocates linearly from its region
+ * and EndFrame() fences it, so BeginFrame() only waits when the GPU is still
+ * reading the region RegionCount frames back. Nothing is orphaned, copied by
+ * the driver or synchronized on upload.
+ *
+ * A frame that outgrows its region gets a larger buffer on the spot; the old
+ * one is deleted once the frame is submitted.
+ *
+ * Must be used on the thread whose OpenGL context is current.
+ */
+class StreamingBuffer {
+ public:
+  /**Frames the CPU may write ahead of the GPU. */
+  static constexpr std::size_t RegionCount = 3;
+  /**Alignment of allocations that do not ask for more. */
+  static constexpr std::size_t DefaultAlignment = 16;
+
+  StreamingBuffer() = delete;
+
+  /**
+   * @brief Creates and maps the buffer.
+   *
+   * @param regionSize Bytes available to each frame before the buffer grows.
+   */
+  static void Initialize(std::size_t regionSize);
+
+  /**
+   * @brief Waits for the GPU, then unmaps and deletes the buffer.
+   */
+  static void Shutdown();
+
+  /**
+   * @brief Starts a frame in the next region, waiting for its fence.
+   */
+  static void BeginFrame();
+
+  /**
+   * @brief Fences the frame's region once its last command is issued.
+   */
+  static void EndFrame();
+
+  /**
+   * @brief Reserves a range of the current frame's region.
+   *
+   * @param size Bytes to reserve; may be 0.
+   * @param alignment Alignment of the offset, any positive number.
+   * @return An invalid allocation if the buffer was never initialized.
+   */
+  static StreamAllocation Allocate(std::size_t size,
+                                   std::size_t alignment = DefaultAlignment);
+
+  /**
+   * @brief Allocate() followed by a copy of `data`.
+   */
+  static StreamAllocation Upload(const void* data, std::size_t size,
+                                 std::size_t alignment = DefaultAlignment);
+
+  /**
+   * @brief Binds an allocation to an indexed target, such as
+   * GL_SHADER_STORAGE_BUFFER. Empty ranges, which GL rejects, are skipped.
+   */
+  static void BindRange(GLenum target, GLuint index,
+                        const StreamAllocation& allocation);
+
+  /**
+   * @brief GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, for storage ranges.
+   */
+  [[nodiscard]] static std::size_t GetStorageAlignment();
+
+  /**Bytes each frame may use before the buffer grows. */
+  [[nodiscard]] static std::size_t GetRegionSize();
+
+  /**Bytes used by the last completed frame. */
+  [[nodiscard]] static std::size_t GetLastFrameBytes();
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+#include "core/Span.h"
+
+class GameObject;
+class TransformComponent;
+
+/**
+ * @class TransformHierarchy
+ * @brief Parent/child relations and cached world matrices of a scene.
+ *
+ * Nodes are stored in depth-first order: a node is always followed by its
+ * whole subtree, and a parent always comes before its children. World
+ * matrices are kept in the same order, so refreshing a subtree is one linear
+ * pass where the parent's matrix is already up to date.
+ *
+ * TransformComponents report local changes through MarkDirty(); Update() then
+ * only visits the subtrees below dirty nodes, so static objects cost nothing.
+ *
+ * Update() runs once per fixed simulation step. The hierarchy also keeps each
+ * node's world matrix from the step before, so Interpolate() can produce
+ * render matrices between the last two steps when frames come faster than
+ * steps.
+ */
+class TransformHierarchy {
+ public:
+  /**Index stored by nodes without a parent. */
+  static constexpr std::int32_t NoParent = -1;
+
+  TransformHierarchy() = default;
+
+  TransformHierarchy(const TransformHierarchy&) = delete;
+  TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+  TransformHierarchy(TransformHierarchy&&) = delete;
+  TransformHierarchy& operator=(TransformHierarchy&&) = delete;
+
+  /**
+   * @brief Adds an object as a new root node.
+   *
+   * @param object An initialized object, so it has a TransformComponent.
+   */
+  void Add(GameObject& object);
+
+  /**
+   * @brief Removes an object. Its children are attached to its parent.
+   *
+   * @param object An object previously added to this hierarchy.
+   */
+  void Remove(GameObject& object);
+
+  /**
+   * @brief Removes several objects with a single compaction of the arrays.
+   *
+   * Children of removed objects are attached to their closest ancestor that
+   * is kept.
+   *
+   * @param objects Distinct objects previously added to this hierarchy.
+   */
+  void Remove(Span<GameObject* const> objects);
+
+  /**
+   * @brief Reserves room for `count` nodes in total.
+   */
+  void Reserve(std::size_t count);
+
+  /**
+   * @brief Moves an object, with its subtree, under a new parent.
+   *
+   * The local transform is kept, so the object moves with its new parent.
+   *
+   * @param child The object to move.
+   * @param parent The new parent, or nullptr to make `child` a root.
+   * @return false if `parent` is `child` or one of its descendants.
+   */
+  bool SetParent(GameObject& child, GameObject* parent);
+
+  /**
+   * @brief Retrieves the parent of an object.
+   *
+   * @return The parent, or nullptr for roots.
+   */
+  [[nodiscard]] GameObject* GetParent(GameObject& object) const;
+
+  /**
+   * @brief Recomputes the world matrices of every dirty subtree.
+   *
+   * Called once per simulation step; the matrices it replaces become the
+   * previous state used by Interpolate().
+   */
+  void Update();
+
+  /**
+   * @brief Blends the last two simulation states into the render matrices.
+   *
+   * Only nodes that moved during the last step are blended; the others
+   * already hold their world matrix.
+   *
+   * @param alpha Position between the previous step (0) and the last one (1).
+   */
+  void Interpolate(float alpha);
+
+  /**
+   * @brief Queues a node whose local transform changed.
+   *
+   * Called by TransformComponent; each node is queued at most once per update.
+   */
+  void MarkDirty(std::uint32_t index) { m_dirtyNodes.push_back(index); }
+
+  [[nodiscard]] const glm::mat4& GetWorldMatrix(std::uint32_t index) const {
+    return m_worldMatrices[index];
+  }
+
+  /**
+   * @brief World matrices in the same depth-first order as GetNodes().
+   */
+  [[nodiscard]] const std::vector<glm::mat4>& GetWorldMatrices() const {
+    return m_worldMatrices;
+  }
+
+  /**
+   * @brief Matrices to draw with, as blended by the last Interpolate().
+   *
+   * Same depth-first order as GetNodes().
+   */
+  [[nodiscard]] const std::vector<glm::mat4>& GetRenderMatrices() const {
+    return m_renderMatrices;
+  }
+
+  /**
+   * @brief Nodes whose world matrix the last Update() recomputed, new nodes
+   * included, in increasing order.
+   *
+   * Valid until the hierarchy changes structure.
+   */
+  [[nodiscard]] const std::vector<std::uint32_t>& GetChangedNodes() const {
+    return m_changedNodes;
+  }
+
+  /**
+   * @brief Objects in depth-first order.
+   */
+  [[nodiscard]] const std::vector<GameObject*>& GetNodes() const {
+    return m_nodes;
+  }
+
+  /**
+   * @brief Parent index of every node, NoParent for roots.
+   */
+  [[nodiscard]] const std::vector<std::int32_t>& GetParents() const {
+    return m_parents;
+  }
+
+ private:
+  /** Moves the block [first, first + count) of every array so it starts
+   * right before `position`, an index outside the block. */
+  void MoveBlock(std::uint32_t first, std::uint32_t count,
+                 std::uint32_t position);
+
+  /** Rebuilds parent indices from subtree sizes, then refreshes the index
+   * every TransformComponent keeps and the dirty queue. */
+  void Reindex();
+
+  /** Rebuilds the stale local matrices of the dirty subtrees in one batch. */
+  void UpdateLocalMatrices();
+
+  /**
+   * @enum MotionState
+   * @brief What Interpolate() must do with a node.
+   */
+  enum class MotionState : std::uint8_t {
+    /**Previous and current world matrices are equal. */
+    Static,
+    /**Moved during the last step; blended by Interpolate(). */
+    Moved,
+    /**Just added; its first world matrix is not blended from anything. */
+    Snap
+  };
+
+  std::vector<GameObject*> m_nodes;
+  std::vector<std::int32_t> m_parents;
+  /**Number of nodes in each subtree, the node included. */
+  std::vector<std::uint32_t> m_subtreeSizes;
+  std::vector<glm::mat4> m_worldMatrices;
+  /**World matrices before the last step. */
+  std::vector<glm::mat4> m_previousWorldMatrices;
+  std::vector<glm::mat4> m_renderMatrices;
+  std::vector<MotionState> m_motion;
+  /**Number of nodes in the Moved state. */
+  std::uint32_t m_movedCount{0};
+  /**Nodes whose world matrix, and their subtree's, is stale. */
+  std::vector<std::uint32_t> m_dirtyNodes;
+  /**Nodes recomputed by the last Update(). */
+  std::vector<std::uint32_t> m_changedNodes;
+
+  /**
+   * @struct LocalBatch
+   * @brief Scratch SoA input of the transform kernel, reused every update.
+   */
+  struct LocalBatch {
+    std::vector<TransformComponent*> transforms;
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<glm::mat4> matrices;
+  };
+  LocalBatch m_localBatch;
+};
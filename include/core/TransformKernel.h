@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+/**
+ * @struct TransformSoA
+ * @brief Structure-of-arrays view over local position, rotation and scale.
+ *
+ * Every pointer addresses `count` floats. Rotations are unit quaternions.
+ */
+struct TransformSoA {
+  const float* positionX;
+  const float* positionY;
+  const float* positionZ;
+  const float* rotationX;
+  const float* rotationY;
+  const float* rotationZ;
+  const float* rotationW;
+  const float* scaleX;
+  const float* scaleY;
+  const float* scaleZ;
+};
+
+/**
+ * @enum TransformKernelLevel
+ * @brief Instruction set used by ComputeTransformMatrices().
+ */
+enum class TransformKernelLevel { Scalar, Sse42, Avx2 };
+
+/** Signature shared by every implementation of the kernel. */
+using TransformKernelFn = void (*)(const TransformSoA& input, std::size_t count,
+                                   glm::mat4* output);
+
+/**
+ * @brief Builds translate * rotate * scale matrices for `count` transforms.
+ *
+ * Processes 8 (AVX2) or 4 (SSE4.2) transforms per iteration when the CPU
+ * supports it, and falls back to scalar code otherwise. The result matches
+ * TransformComponent::GetLocalMatrix() up to float rounding.
+ *
+ * @param input Source arrays.
+ * @param count Number of transforms.
+ * @param output Receives `count` matrices.
+ */
+void ComputeTransformMatrices(const TransformSoA& input, std::size_t count,
+                              glm::mat4* output);
+
+/**
+ * @brief Reports which implementation ComputeTransformMatrices() runs.
+ */
+TransformKernelLevel GetTransformKernelLevel();
+
+/** Per instruction set entry points; nullptr when not compiled in. The
+ * scalar one is always available. */
+TransformKernelFn GetTransformKernelScalar();
+TransformKernelFn GetTransformKernelSse42();
+TransformKernelFn GetTransformKernelAvx2();
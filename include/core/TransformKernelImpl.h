@@ -0,0 +1,110 @@
+#pragma once
+
+// Shared body of the transform kernels. Included by one translation unit per
+// instruction set, each compiled with its own flags, so everything here has
+// internal linkage: the linker must never merge an AVX2 instantiation into
+// the scalar build.
+
+#include <cstddef>
+
+#include "core/TransformKernel.h"
+
+namespace {
+
+/**
+ * @brief Computes V::Width matrices starting at `first`.
+ *
+ * The 16 matrix entries are computed as registers, then spilled and
+ * scattered to the column-major glm::mat4 outputs.
+ */
+template <typename V>
+void ComputeBatch(const TransformSoA& in, std::size_t first,
+                  glm::mat4* output) {
+  using Reg = typename V::Reg;
+
+  Reg x = V::Load(in.rotationX + first);
+  Reg y = V::Load(in.rotationY + first);
+  Reg z = V::Load(in.rotationZ + first);
+  Reg w = V::Load(in.rotationW + first);
+
+  Reg x2 = V::Add(x, x);
+  Reg y2 = V::Add(y, y);
+  Reg z2 = V::Add(z, z);
+  Reg xx = V::Mul(x, x2);
+  Reg yy = V::Mul(y, y2);
+  Reg zz = V::Mul(z, z2);
+  Reg xy = V::Mul(x, y2);
+  Reg xz = V::Mul(x, z2);
+  Reg yz = V::Mul(y, z2);
+  Reg wx = V::Mul(w, x2);
+  Reg wy = V::Mul(w, y2);
+  Reg wz = V::Mul(w, z2);
+
+  const Reg one = V::Set(1.0f);
+  const Reg zero = V::Set(0.0f);
+  Reg scaleX = V::Load(in.scaleX + first);
+  Reg scaleY = V::Load(in.scaleY + first);
+  Reg scaleZ = V::Load(in.scaleZ + first);
+
+  // Rotation matrix of the quaternion, columns scaled, as in
+  // TransformComponent::GetLocalMatrix().
+  alignas(32) float columns[16][V::Width];
+  V::Store(columns[0], V::Mul(V::Sub(one, V::Add(yy, zz)), scaleX));
+  V::Store(columns[1], V::Mul(V::Add(xy, wz), scaleX));
+  V::Store(columns[2], V::Mul(V::Sub(xz, wy), scaleX));
+  V::Store(columns[3], zero);
+
+  V::Store(columns[4], V::Mul(V::Sub(xy, wz), scaleY));
+  V::Store(columns[5], V::Mul(V::Sub(one, V::Add(xx, zz)), scaleY));
+  V::Store(columns[6], V::Mul(V::Add(yz, wx), scaleY));
+  V::Store(columns[7], zero);
+
+  V::Store(columns[8], V::Mul(V::Add(xz, wy), scaleZ));
+  V::Store(columns[9], V::Mul(V::Sub(yz, wx), scaleZ));
+  V::Store(columns[10], V::Mul(V::Sub(one, V::Add(xx, yy)), scaleZ));
+  V::Store(columns[11], zero);
+
+  V::Store(columns[12], V::Load(in.positionX + first));
+  V::Store(columns[13], V::Load(in.positionY + first));
+  V::Store(columns[14], V::Load(in.positionZ + first));
+  V::Store(columns[15], V::Set(1.0f));
+
+  for (std::size_t lane = 0; lane < V::Width; ++lane) {
+    glm::mat4& matrix = output[first + lane];
+    for (int entry = 0; entry < 16; ++entry) {
+      matrix[entry / 4][entry % 4] = columns[entry][lane];
+    }
+  }
+}
+
+/**
+ * @struct ScalarLanes
+ * @brief One transform at a time; also handles the tail of wider kernels.
+ */
+struct ScalarLanes {
+  using Reg = float;
+  static constexpr std::size_t Width = 1;
+
+  static Reg Load(const float* p) { return *p; }
+  static void Store(float* p, Reg v) { *p = v; }
+  static Reg Set(float v) { return v; }
+  static Reg Add(Reg a, Reg b) { return a + b; }
+  static Reg Sub(Reg a, Reg b) { return a - b; }
+  static Reg Mul(Reg a, Reg b) { return a * b; }
+};
+
+template <typename V>
+void ComputeTransformMatricesWith(const TransformSoA& input, std::size_t count,
+                                  glm::mat4* output) {
+  std::size_t i = 0;
+
+  for (; i + V::Width <= count; i += V::Width) {
+    ComputeBatch<V>(input, i, output);
+  }
+
+  for (; i < count; ++i) {
+    ComputeBatch<ScalarLanes>(input, i, output);
+  }
+}
+
+}  // namespace
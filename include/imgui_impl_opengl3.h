@@ -42,6 +42,17 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// [1158Engine] (Optional) Upload vertices and indices into ranges of an application buffer instead of glBufferData().
+// The allocator returns false to fall back to the backend's own buffers. Ranges must stay valid until the frame is drawn.
+struct ImGui_ImplOpenGL3_StreamAllocation
+{
+    unsigned int    Buffer;     // Buffer object holding the range
+    size_t          Offset;     // Offset of the range in Buffer, in bytes; a multiple of sizeof(ImDrawIdx)
+    void*           Data;       // Where the CPU writes the range
+};
+typedef bool (*ImGui_ImplOpenGL3_StreamAllocator)(size_t size, ImGui_ImplOpenGL3_StreamAllocation* out_allocation);
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetStreamAllocator(ImGui_ImplOpenGL3_StreamAllocator allocator);
+
 // Configuration flags to add in your imconfig file:
 //#define IMGUI_IMPL_OPENGL_ES2     // Enable ES 2 (Auto-detected on Emscripten)
 //#define IMGUI_IMPL_OPENGL_ES3     // Enable ES 3 (Auto-detected on iOS/Android)
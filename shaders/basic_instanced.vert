@@ -0,0 +1,42 @@
+#version 430 core
+
+// Vertex attributes, read from the shared mesh buffer
+layout (location = 0) in vec3 aPos;		// Vertex position
+layout (location = 1) in vec3 aNormal;	// Vertex normal
+
+// Index into instances[], read per instance from the visible-instance list
+// at baseInstance + gl_InstanceID, see MeshBuffer::InstanceIndexLocation
+layout (location = 3) in uint aInstance;
+
+// Per-instance data, see MeshInstance
+struct Instance {
+	mat4 model;			// Model matrix
+	mat3 normalMatrix;	// Inverse transpose of the model matrix
+};
+
+layout (std430, binding = 1) readonly buffer InstanceBuffer {
+	Instance instances[];
+};
+
+// Outputs to fragment shader
+out vec3 FragPos;	// Position of the fragment in world space
+out vec3 Normal;	// Normal vector of the fragment
+
+// Transformation matrices
+uniform mat4 view;			// View matrix
+uniform mat4 projection;	// Projection matrix
+
+void main()
+{
+	Instance instance = instances[aInstance];
+
+	// Calculate the fragment position in world space
+	vec4 worldPos = instance.model * vec4(aPos, 1.0);
+	FragPos = vec3(worldPos);
+
+    // The normal matrix is computed once per instance on the CPU
+	Normal = instance.normalMatrix * aNormal;
+
+    // Compute the final position of the vertex in clip space
+	gl_Position = projection * view * worldPos;
+}
@@ -0,0 +1,358 @@
+#include "core/AabbTree.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace {
+
+/**Number of buckets candidate split planes are evaluated between. */
+constexpr std::size_t SahBinCount = 12;
+
+}  // namespace
+
+std::int32_t AabbTree::CreateProxy(const Aabb& bounds, void* userData) {
+  std::int32_t proxy = AllocateNode();
+  Node& node = m_nodes[proxy];
+  node.bounds = bounds;
+  node.bounds.Inflate(FatMargin);
+  node.userData = userData;
+  node.height = 0;
+
+  InsertLeaf(proxy);
+  ++m_proxyCount;
+
+  return proxy;
+}
+
+void AabbTree::DestroyProxy(std::int32_t proxy) {
+  RemoveLeaf(proxy);
+  FreeNode(proxy);
+  --m_proxyCount;
+}
+
+bool AabbTree::MoveProxy(std::int32_t proxy, const Aabb& bounds) {
+  if (m_nodes[proxy].bounds.Contains(bounds)) {
+    return false;
+  }
+
+  RemoveLeaf(proxy);
+  m_nodes[proxy].bounds = bounds;
+  m_nodes[proxy].bounds.Inflate(FatMargin);
+  InsertLeaf(proxy);
+
+  return true;
+}
+
+void AabbTree::Rebuild() {
+  m_insertionsSinceRebuild = 0;
+
+  if (m_root == NullNode) {
+    return;
+  }
+
+  m_buildLeaves.clear();
+  m_buildLeaves.reserve(m_proxyCount);
+
+  for (std::size_t i = 0; i < m_nodes.size(); ++i) {
+    const Node& node = m_nodes[i];
+
+    if (node.height < 0) {
+      continue;
+    }
+
+    if (node.IsLeaf()) {
+      m_buildLeaves.push_back(static_cast<std::int32_t>(i));
+    } else {
+      FreeNode(static_cast<std::int32_t>(i));
+    }
+  }
+
+  m_root = BuildRange(0, m_buildLeaves.size());
+  m_nodes[m_root].parent = NullNode;
+}
+
+std::int32_t AabbTree::AllocateNode() {
+  if (m_freeList == NullNode) {
+    m_nodes.emplace_back();
+    return static_cast<std::int32_t>(m_nodes.size() - 1);
+  }
+
+  std::int32_t node = m_freeList;
+  m_freeList = m_nodes[node].parent;
+  m_nodes[node] = Node{};
+  return node;
+}
+
+void AabbTree::FreeNode(std::int32_t node) {
+  m_nodes[node].parent = m_freeList;
+  m_nodes[node].child1 = NullNode;
+  m_nodes[node].child2 = NullNode;
+  m_nodes[node].height = -1;
+  m_nodes[node].userData = nullptr;
+  m_freeList = node;
+}
+
+void AabbTree::InsertLeaf(std::int32_t leaf) {
+  ++m_insertionsSinceRebuild;
+
+  if (m_root == NullNode) {
+    m_root = leaf;
+    m_nodes[leaf].parent = NullNode;
+    return;
+  }
+
+  // Descend towards the sibling whose union with the leaf costs the least
+  // surface area, counting the growth inherited by every ancestor.
+  const Aabb leafBounds = m_nodes[leaf].bounds;
+  std::int32_t index = m_root;
+
+  while (!m_nodes[index].IsLeaf()) {
+    const Node& node = m_nodes[index];
+    float area = node.bounds.GetSurfaceArea();
+    float combinedArea = Union(node.bounds, leafBounds).GetSurfaceArea();
+
+    // Cost of pairing the leaf with this node, and of pushing it further.
+    float cost = 2.0f * combinedArea;
+    float inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto descendCost = [&](std::int32_t child) {
+      const Aabb& childBounds = m_nodes[child].bounds;
+      float unionArea = Union(childBounds, leafBounds).GetSurfaceArea();
+      float growth = m_nodes[child].IsLeaf()
+                         ? unionArea
+                         : unionArea - childBounds.GetSurfaceArea();
+      return growth + inheritanceCost;
+    };
+
+    float cost1 = descendCost(node.child1);
+    float cost2 = descendCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  const std::int32_t sibling = index;
+  const std::int32_t oldParent = m_nodes[sibling].parent;
+  const std::int32_t newParent = AllocateNode();
+
+  Node& parent = m_nodes[newParent];
+  parent.parent = oldParent;
+  parent.bounds = Union(leafBounds, m_nodes[sibling].bounds);
+  parent.height = m_nodes[sibling].height + 1;
+  parent.child1 = sibling;
+  parent.child2 = leaf;
+
+  if (oldParent != NullNode) {
+    Node& grandParent = m_nodes[oldParent];
+    (grandParent.child1 == sibling ? grandParent.child1 : grandParent.child2) =
+        newParent;
+  } else {
+    m_root = newParent;
+  }
+
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+
+  RefitAncestors(m_nodes[leaf].parent);
+}
+
+void AabbTree::RemoveLeaf(std::int32_t leaf) {
+  if (leaf == m_root) {
+    m_root = NullNode;
+    return;
+  }
+
+  const std::int32_t parent = m_nodes[leaf].parent;
+  const std::int32_t grandParent = m_nodes[parent].parent;
+  const std::int32_t sibling = m_nodes[parent].child1 == leaf
+                                   ? m_nodes[parent].child2
+                                   : m_nodes[parent].child1;
+
+  FreeNode(parent);
+  m_nodes[sibling].parent = grandParent;
+
+  if (grandParent == NullNode) {
+    m_root = sibling;
+    return;
+  }
+
+  Node& node = m_nodes[grandParent];
+  (node.child1 == parent ? node.child1 : node.child2) = sibling;
+
+  RefitAncestors(grandParent);
+}
+
+void AabbTree::RefitAncestors(std::int32_t node) {
+  while (node != NullNode) {
+    node = Balance(node);
+
+    Node& current = m_nodes[node];
+    const Node& child1 = m_nodes[current.child1];
+    const Node& child2 = m_nodes[current.child2];
+    current.bounds = Union(child1.bounds, child2.bounds);
+    current.height = 1 + std::max(child1.height, child2.height);
+
+    node = current.parent;
+  }
+}
+
+std::int32_t AabbTree::Balance(std::int32_t indexA) {
+  Node& a = m_nodes[indexA];
+
+  if (a.IsLeaf() || a.height < 2) {
+    return indexA;
+  }
+
+  const std::int32_t indexB = a.child1;
+  const std::int32_t indexC = a.child2;
+  Node& b = m_nodes[indexB];
+  Node& c = m_nodes[indexC];
+  const std::int32_t balance = c.height - b.height;
+
+  // Rotates `up` (a child of A) into A's place. A keeps `keep` and adopts the
+  // shorter child of `up`; `up` keeps the taller one.
+  auto rotate = [&](std::int32_t indexUp, Node& up, Node& keep,
+                    std::int32_t& slotOfUpInA) {
+    const std::int32_t indexF = up.child1;
+    const std::int32_t indexG = up.child2;
+    Node& f = m_nodes[indexF];
+    Node& g = m_nodes[indexG];
+
+    up.child1 = indexA;
+    up.parent = a.parent;
+    a.parent = indexUp;
+
+    if (up.parent != NullNode) {
+      Node& parent = m_nodes[up.parent];
+      (parent.child1 == indexA ? parent.child1 : parent.child2) = indexUp;
+    } else {
+      m_root = indexUp;
+    }
+
+    const bool fIsTaller = f.height > g.height;
+    const std::int32_t indexTall = fIsTaller ? indexF : indexG;
+    const std::int32_t indexShort = fIsTaller ? indexG : indexF;
+    Node& tall = m_nodes[indexTall];
+    Node& shorter = m_nodes[indexShort];
+
+    up.child2 = indexTall;
+    slotOfUpInA = indexShort;
+    shorter.parent = indexA;
+
+    a.bounds = Union(keep.bounds, shorter.bounds);
+    up.bounds = Union(a.bounds, tall.bounds);
+    a.height = 1 + std::max(keep.height, shorter.height);
+    up.height = 1 + std::max(a.height, tall.height);
+  };
+
+  if (balance > 1) {
+    rotate(indexC, c, b, a.child2);
+    return indexC;
+  }
+
+  if (balance < -1) {
+    rotate(indexB, b, c, a.child1);
+    return indexB;
+  }
+
+  return indexA;
+}
+
+std::int32_t AabbTree::BuildRange(std::size_t first, std::size_t last) {
+  if (last - first == 1) {
+    return m_buildLeaves[first];
+  }
+
+  Aabb centroidBounds;
+  for (std::size_t i = first; i < last; ++i) {
+    centroidBounds.Expand(m_nodes[m_buildLeaves[i]].bounds.GetCenter());
+  }
+
+  glm::vec3 size = centroidBounds.max - centroidBounds.min;
+  int axis = 0;
+  if (size.y > size[axis]) axis = 1;
+  if (size.z > size[axis]) axis = 2;
+
+  auto begin = m_buildLeaves.begin() + static_cast<std::ptrdiff_t>(first);
+  auto end = m_buildLeaves.begin() + static_cast<std::ptrdiff_t>(last);
+  auto middle = begin + static_cast<std::ptrdiff_t>((last - first) / 2);
+
+  if (size[axis] > 0.0f) {
+    // Bin the centroids along the widest axis and split where
+    // area(left) * count(left) + area(right) * count(right) is smallest.
+    const float origin = centroidBounds.min[axis];
+    const float scale = static_cast<float>(SahBinCount) / size[axis];
+    auto binOf = [&](std::int32_t leaf) {
+      float center = m_nodes[leaf].bounds.GetCenter()[axis];
+      auto bin = static_cast<std::size_t>((center - origin) * scale);
+      return std::min(bin, SahBinCount - 1);
+    };
+
+    std::array<Aabb, SahBinCount> binBounds{};
+    std::array<std::size_t, SahBinCount> binCounts{};
+    for (auto it = begin; it != end; ++it) {
+      std::size_t bin = binOf(*it);
+      binBounds[bin] = Union(binBounds[bin], m_nodes[*it].bounds);
+      ++binCounts[bin];
+    }
+
+    std::array<float, SahBinCount - 1> leftCosts{};
+    Aabb left;
+    std::size_t leftCount = 0;
+    for (std::size_t split = 0; split + 1 < SahBinCount; ++split) {
+      left = Union(left, binBounds[split]);
+      leftCount += binCounts[split];
+      leftCosts[split] =
+          leftCount != 0 ? left.GetSurfaceArea() * leftCount : 0.0f;
+    }
+
+    float bestCost = std::numeric_limits<float>::max();
+    std::size_t bestSplit = 0;
+    Aabb right;
+    std::size_t rightCount = 0;
+    for (std::size_t split = SahBinCount - 1; split > 0; --split) {
+      right = Union(right, binBounds[split]);
+      rightCount += binCounts[split];
+      float cost = leftCosts[split - 1] +
+                   (rightCount != 0 ? right.GetSurfaceArea() * rightCount
+                                    : 0.0f);
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestSplit = split;
+      }
+    }
+
+    middle = std::partition(begin, end, [&](std::int32_t leaf) {
+      return binOf(leaf) < bestSplit;
+    });
+  }
+
+  // Coincident centroids, or every centroid in one bin: split in half.
+  if (middle == begin || middle == end) {
+    middle = begin + static_cast<std::ptrdiff_t>((last - first) / 2);
+    std::nth_element(begin, middle, end,
+                     [&](std::int32_t lhs, std::int32_t rhs) {
+                       return m_nodes[lhs].bounds.GetCenter()[axis] <
+                              m_nodes[rhs].bounds.GetCenter()[axis];
+                     });
+  }
+
+  const auto split = static_cast<std::size_t>(middle - m_buildLeaves.begin());
+  const std::int32_t child1 = BuildRange(first, split);
+  const std::int32_t child2 = BuildRange(split, last);
+  const std::int32_t index = AllocateNode();
+
+  Node& node = m_nodes[index];
+  node.child1 = child1;
+  node.child2 = child2;
+  node.bounds = Union(m_nodes[child1].bounds, m_nodes[child2].bounds);
+  node.height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+  m_nodes[child1].parent = index;
+  m_nodes[child2].parent = index;
+
+  return index;
+}
@@ -0,0 +1,84 @@
+#include "core/AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replacements of the global allocation functions. The array and nothrow
+// forms are implemented by the standard library on top of these, so they are
+// counted too.
+
+namespace {
+
+std::atomic<std::uint64_t> heapAllocationCount{0};
+
+/** Allocates with malloc, or with an aligned allocation if `alignment` is
+ * not 0, so the matching operator delete knows how to free it. */
+void* AllocateCounted(std::size_t size, std::size_t alignment) {
+  heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+  if (size == 0) {
+    size = 1;
+  }
+
+  for (;;) {
+    void* memory = nullptr;
+
+    if (alignment == 0) {
+      memory = std::malloc(size);
+    } else {
+#if defined(_WIN32)
+      memory = _aligned_malloc(size, alignment);
+#else
+      // aligned_alloc requires the size to be a multiple of the alignment.
+      memory = std::aligned_alloc(alignment,
+                                  (size + alignment - 1) & ~(alignment - 1));
+#endif
+    }
+
+    if (memory != nullptr) {
+      return memory;
+    }
+
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+}  // namespace
+
+std::uint64_t GetHeapAllocationCount() {
+  return heapAllocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+  return AllocateCounted(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateCounted(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t /*alignment*/) noexcept {
+#if defined(_WIN32)
+  _aligned_free(memory);
+#else
+  std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, std::size_t /*size*/) noexcept {
+  operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t /*size*/,
+                     std::align_val_t alignment) noexcept {
+  operator delete(memory, alignment);
+}
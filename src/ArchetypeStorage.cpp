@@ -0,0 +1,448 @@
+#include "core/ArchetypeStorage.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "GameObject.h"
+#include "MeshComponent.h"
+#include "core/JobSystem.h"
+
+namespace {
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+void RegisterComponentType(
+    std::array<ComponentTypeInfo, ComponentTypeCount>& table) {
+  static_assert(alignof(T) <= Archetype::ChunkAlignment,
+                "Component alignment exceeds the chunk alignment");
+  static_assert(std::is_nothrow_move_constructible_v<T>,
+                "Components are relocated between chunks");
+
+  ComponentTypeInfo& info = table[static_cast<std::size_t>(T::StaticType)];
+  info.size = sizeof(T);
+  info.alignment = alignof(T);
+  info.mainThreadOnly = T::MainThreadOnly;
+  info.relocate = [](void* dst, void* src) {
+    auto* source = static_cast<T*>(src);
+    new (dst) T(std::move(*source));
+    source->~T();
+  };
+  info.destroy = [](void* component) { static_cast<T*>(component)->~T(); };
+  info.asComponent = [](void* component) -> Component* {
+    return static_cast<T*>(component);
+  };
+
+  // Qualified calls: the concrete type is known, so no virtual dispatch.
+  if constexpr (T::HasUpdate) {
+    info.updateColumn = [](void* column, std::uint32_t count,
+                           float deltaTime) {
+      auto* components = static_cast<T*>(column);
+      for (std::uint32_t i = 0; i < count; ++i) {
+        components[i].T::Update(deltaTime);
+      }
+    };
+  }
+
+  if constexpr (T::HasRender) {
+    info.renderColumn = [](void* column, std::uint32_t count) {
+      auto* components = static_cast<T*>(column);
+      for (std::uint32_t i = 0; i < count; ++i) {
+        components[i].T::Render();
+      }
+    };
+  }
+}
+
+/** Mask holding the single bit of `type`. */
+ComponentMask MaskOf(std::size_t type) {
+  ComponentMask mask;
+  mask.set(type);
+  return mask;
+}
+
+std::array<ComponentTypeInfo, ComponentTypeCount> BuildComponentTypeInfos() {
+  std::array<ComponentTypeInfo, ComponentTypeCount> table{};
+  RegisterComponentType<TransformComponent>(table);
+  RegisterComponentType<ScriptComponent>(table);
+  RegisterComponentType<MeshComponent>(table);
+  RegisterComponentType<LightComponent>(table);
+  return table;
+}
+
+const std::array<ComponentTypeInfo, ComponentTypeCount> ComponentTypeInfos =
+    BuildComponentTypeInfos();
+
+}  // namespace
+
+const ComponentTypeInfo& GetComponentTypeInfo(ComponentType type) {
+  return ComponentTypeInfos[static_cast<std::size_t>(type)];
+}
+
+Archetype::Archetype(ComponentMask mask) : m_mask(mask) {
+  std::size_t rowBytes = sizeof(GameObject*);
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    if (m_mask.test(i)) {
+      rowBytes += ComponentTypeInfos[i].size;
+    }
+  }
+
+  // Leave room for the chunk header and the padding inserted in front of
+  // every column.
+  const std::size_t headerBytes = AlignUp(sizeof(Chunk), ChunkAlignment);
+  std::size_t padding = headerBytes + (m_mask.count() + 1) * ChunkAlignment;
+  m_chunkCapacity = static_cast<std::uint32_t>(
+      std::max<std::size_t>(1, (ChunkBytes - padding) / rowBytes));
+
+  std::size_t offset = AlignUp(
+      headerBytes + sizeof(GameObject*) * m_chunkCapacity, ChunkAlignment);
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    if (m_mask.test(i)) {
+      m_columnOffsets[i] = offset;
+      offset = AlignUp(offset + ComponentTypeInfos[i].size * m_chunkCapacity,
+                       ChunkAlignment);
+    }
+  }
+  m_chunkSize = offset;
+  m_chunkPool = std::make_unique<PoolAllocator>(m_chunkSize, ChunkAlignment,
+                                                ChunksPerPage);
+}
+
+Archetype::~Archetype() {
+  for (Chunk* chunk : m_chunks) {
+    for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+      if (!m_mask.test(i)) {
+        continue;
+      }
+
+      const ComponentTypeInfo& info = ComponentTypeInfos[i];
+      for (std::uint32_t slot = 0; slot < chunk->count; ++slot) {
+        info.destroy(chunk->columns[i] + slot * info.size);
+      }
+    }
+
+    chunk->~Chunk();
+    m_chunkPool->Deallocate(chunk);
+  }
+}
+
+std::size_t Archetype::GetEntityCount() const {
+  std::size_t count = 0;
+  for (const Chunk* chunk : m_chunks) {
+    count += chunk->count;
+  }
+  return count;
+}
+
+void* Archetype::GetRaw(ComponentType type,
+                        const EntityLocation& location) const {
+  auto index = static_cast<std::size_t>(type);
+  std::byte* column = m_chunks[location.chunk]->columns[index];
+
+  if (column == nullptr) {
+    return nullptr;
+  }
+
+  return column + location.slot * ComponentTypeInfos[index].size;
+}
+
+EntityLocation Archetype::AllocateRow(GameObject* owner) {
+  if (m_chunks.empty() || m_chunks.back()->count == m_chunkCapacity) {
+    auto* memory = static_cast<std::byte*>(m_chunkPool->Allocate());
+    auto* chunk = new (memory) Chunk();
+    chunk->owners = reinterpret_cast<GameObject**>(
+        memory + AlignUp(sizeof(Chunk), ChunkAlignment));
+
+    for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+      if (m_mask.test(i)) {
+        chunk->columns[i] = memory + m_columnOffsets[i];
+      }
+    }
+
+    m_chunks.push_back(chunk);
+  }
+
+  Chunk& chunk = *m_chunks.back();
+  EntityLocation location{this, static_cast<std::uint32_t>(m_chunks.size() - 1),
+                          chunk.count};
+  chunk.owners[chunk.count++] = owner;
+
+  return location;
+}
+
+GameObject* Archetype::ReleaseRow(const EntityLocation& location) {
+  Chunk& last = *m_chunks.back();
+  auto lastChunk = static_cast<std::uint32_t>(m_chunks.size() - 1);
+  std::uint32_t lastSlot = last.count - 1;
+  GameObject* moved = nullptr;
+
+  // Keep rows packed by filling the hole with the last row.
+  if (location.chunk != lastChunk || location.slot != lastSlot) {
+    Chunk& hole = *m_chunks[location.chunk];
+
+    for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+      if (m_mask.test(i)) {
+        const ComponentTypeInfo& info = ComponentTypeInfos[i];
+        info.relocate(hole.columns[i] + location.slot * info.size,
+                      last.columns[i] + lastSlot * info.size);
+      }
+    }
+
+    moved = last.owners[lastSlot];
+    hole.owners[location.slot] = moved;
+  }
+
+  if (--last.count == 0) {
+    last.~Chunk();
+    m_chunkPool->Deallocate(&last);
+    m_chunks.pop_back();
+  }
+
+  return moved;
+}
+
+void* ArchetypeStorage::AddComponentSlot(GameObject& object,
+                                         ComponentType type) {
+  ComponentMask mask;
+  if (object.m_location.archetype != nullptr) {
+    mask = object.m_location.archetype->GetMask();
+  }
+  mask.set(static_cast<std::size_t>(type));
+
+  Archetype& target = GetOrCreateArchetype(mask);
+  SetLocation(object, MoveEntity(object, target));
+
+  ComponentMask added;
+  added.set(static_cast<std::size_t>(type));
+  TrackComponents(added, true);
+
+  return target.GetRaw(type, object.m_location);
+}
+
+void ArchetypeStorage::RemoveComponent(GameObject& object, ComponentType type) {
+  Archetype* source = object.m_location.archetype;
+
+  if (source == nullptr || !source->Has(type)) {
+    return;
+  }
+
+  ComponentMask mask = source->GetMask();
+  mask.reset(static_cast<std::size_t>(type));
+
+  if (mask.none()) {
+    RemoveEntity(object);
+    return;
+  }
+
+  GetComponentTypeInfo(type).destroy(source->GetRaw(type, object.m_location));
+  ComponentMask removed;
+  removed.set(static_cast<std::size_t>(type));
+  TrackComponents(removed, false);
+  SetLocation(object, MoveEntity(object, GetOrCreateArchetype(mask)));
+}
+
+void ArchetypeStorage::RemoveEntity(GameObject& object) {
+  EntityLocation location = object.m_location;
+
+  if (location.archetype == nullptr) {
+    return;
+  }
+
+  SetLocation(object, {});
+  Archetype& archetype = *location.archetype;
+
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    if (archetype.GetMask().test(i)) {
+      ComponentTypeInfos[i].destroy(
+          archetype.GetRaw(static_cast<ComponentType>(i), location));
+    }
+  }
+  TrackComponents(archetype.GetMask(), false);
+
+  if (GameObject* moved = archetype.ReleaseRow(location)) {
+    SetLocation(*moved, location);
+  }
+}
+
+void ArchetypeStorage::UpdateMainThread(float deltaTime) {
+  // One type at a time, visiting only the archetypes that store it; types
+  // without work are skipped entirely.
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    const ComponentTypeInfo& info = ComponentTypeInfos[i];
+    if (info.updateColumn == nullptr || !info.mainThreadOnly) {
+      continue;
+    }
+
+    for (Archetype* archetype : GetMatchingArchetypes(MaskOf(i))) {
+      for (std::size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+        const Archetype::Chunk& chunk = archetype->GetChunk(c);
+        info.updateColumn(chunk.columns[i], chunk.count, deltaTime);
+      }
+    }
+  }
+}
+
+void ArchetypeStorage::UpdateParallel(float deltaTime, JobSystem* jobSystem) {
+  m_updateBatches.clear();
+
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    const ComponentTypeInfo& info = ComponentTypeInfos[i];
+    if (info.updateColumn == nullptr || info.mainThreadOnly) {
+      continue;
+    }
+
+    for (Archetype* archetype : GetMatchingArchetypes(MaskOf(i))) {
+      for (std::size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+        const Archetype::Chunk& chunk = archetype->GetChunk(c);
+
+        if (jobSystem == nullptr) {
+          info.updateColumn(chunk.columns[i], chunk.count, deltaTime);
+        } else {
+          m_updateBatches.push_back(
+              {info.updateColumn, chunk.columns[i], chunk.count});
+        }
+      }
+    }
+  }
+
+  if (jobSystem == nullptr) {
+    return;
+  }
+
+  // One batch per chunk column: a few hundred contiguous components.
+  jobSystem->ParallelFor(
+      m_updateBatches.size(), 1,
+      [this, deltaTime](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          const UpdateBatch& batch = m_updateBatches[i];
+          batch.updateColumn(batch.column, batch.count, deltaTime);
+        }
+      });
+}
+
+void ArchetypeStorage::Render() {
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    const ComponentTypeInfo& info = ComponentTypeInfos[i];
+    if (info.renderColumn == nullptr) {
+      continue;
+    }
+
+    for (Archetype* archetype : GetMatchingArchetypes(MaskOf(i))) {
+      for (std::size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+        const Archetype::Chunk& chunk = archetype->GetChunk(c);
+        info.renderColumn(chunk.columns[i], chunk.count);
+      }
+    }
+  }
+}
+
+PoolStats ArchetypeStorage::GetComponentStats(ComponentType type) const {
+  PoolStats stats = m_componentStats[static_cast<std::size_t>(type)];
+
+  for (const auto& archetype : m_archetypes) {
+    if (archetype->Has(type)) {
+      stats.capacity +=
+          archetype->GetChunkCount() * archetype->GetChunkCapacity();
+    }
+  }
+
+  return stats;
+}
+
+void ArchetypeStorage::TrackComponents(ComponentMask mask, bool constructed) {
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    if (!mask.test(i)) {
+      continue;
+    }
+
+    PoolStats& stats = m_componentStats[i];
+    if (constructed) {
+      ++stats.liveCount;
+      stats.highWaterMark = std::max(stats.highWaterMark, stats.liveCount);
+    } else {
+      --stats.liveCount;
+    }
+  }
+}
+
+Archetype& ArchetypeStorage::GetOrCreateArchetype(ComponentMask mask) {
+  for (const auto& archetype : m_archetypes) {
+    if (archetype->GetMask() == mask) {
+      return *archetype;
+    }
+  }
+
+  m_archetypes.push_back(std::make_unique<Archetype>(mask));
+  Archetype& archetype = *m_archetypes.back();
+
+  // Archetypes are never destroyed, so cached queries only ever grow.
+  for (const auto& query : m_queries) {
+    if ((mask & query->mask) == query->mask) {
+      query->archetypes.push_back(&archetype);
+    }
+  }
+
+  return archetype;
+}
+
+const std::vector<Archetype*>& ArchetypeStorage::GetMatchingArchetypes(
+    ComponentMask mask) {
+  for (const auto& query : m_queries) {
+    if (query->mask == mask) {
+      return query->archetypes;
+    }
+  }
+
+  auto query = std::make_unique<Query>();
+  query->mask = mask;
+
+  for (const auto& archetype : m_archetypes) {
+    if ((archetype->GetMask() & mask) == mask) {
+      query->archetypes.push_back(archetype.get());
+    }
+  }
+
+  m_queries.push_back(std::move(query));
+  return m_queries.back()->archetypes;
+}
+
+void ArchetypeStorage::SetLocation(GameObject& object,
+                                   const EntityLocation& location) {
+  object.m_location = location;
+
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    object.m_componentSlots[i] =
+        location.archetype != nullptr
+            ? location.archetype->GetRaw(static_cast<ComponentType>(i),
+                                         location)
+            : nullptr;
+  }
+}
+
+EntityLocation ArchetypeStorage::MoveEntity(GameObject& object,
+                                            Archetype& target) {
+  EntityLocation from = object.m_location;
+  EntityLocation to = target.AllocateRow(&object);
+
+  if (from.archetype == nullptr) {
+    return to;
+  }
+
+  // Components missing from the target were destroyed by the caller.
+  ComponentMask shared = from.archetype->GetMask() & target.GetMask();
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    if (shared.test(i)) {
+      auto type = static_cast<ComponentType>(i);
+      ComponentTypeInfos[i].relocate(target.GetRaw(type, to),
+                                     from.archetype->GetRaw(type, from));
+    }
+  }
+
+  if (GameObject* moved = from.archetype->ReleaseRow(from)) {
+    SetLocation(*moved, from);
+  }
+
+  return to;
+}
@@ -52,41 +52,43 @@ void Camera::ProcessMouseMovement(float xOffset, float yOffset,
 }
 
 // Move camera forward
-void Camera::MoveForward() {
-  m_position += m_front * m_speed;
+void Camera::MoveForward(float deltaTime) {
+  m_position += m_front * (m_speed * deltaTime);
 }
 
 // Move camera backward
-void Camera::MoveBackward() {
-  m_position -= m_front * m_speed;
+void Camera::MoveBackward(float deltaTime) {
+  m_position -= m_front * (m_speed * deltaTime);
 }
 
 // Move camera left
-void Camera::MoveLeft() {
-  m_position -= glm::normalize(glm::cross(m_front, m_up)) * m_speed;
+void Camera::MoveLeft(float deltaTime) {
+  m_position -=
+      glm::normalize(glm::cross(m_front, m_up)) * (m_speed * deltaTime);
 }
 
 // Move camera right
-void Camera::MoveRight() {
-  m_position += glm::normalize(glm::cross(m_front, m_up)) * m_speed;
+void Camera::MoveRight(float deltaTime) {
+  m_position +=
+      glm::normalize(glm::cross(m_front, m_up)) * (m_speed * deltaTime);
 }
 
-void Camera::RotateLeft() {
-  m_yaw -= 0.5f * 10.0f;
+void Camera::RotateLeft(float deltaTime) {
+  m_yaw -= m_turnSpeed * deltaTime;
   UpdateCameraVectors();
 }
 
-void Camera::RotateRight() {
-  m_yaw += 0.5f * 10.0f;
+void Camera::RotateRight(float deltaTime) {
+  m_yaw += m_turnSpeed * deltaTime;
   UpdateCameraVectors();
 }
 
-void Camera::MoveUp() {
-  m_position.y += m_speed;
+void Camera::MoveUp(float deltaTime) {
+  m_position.y += m_speed * deltaTime;
 }
 
-void Camera::MoveDown() {
-  m_position.y -= m_speed;
+void Camera::MoveDown(float deltaTime) {
+  m_position.y -= m_speed * deltaTime;
 }
 
 // Rotate camera based on input deltas
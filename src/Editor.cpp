@@ -10,7 +10,9 @@
 
 #include "IconsLucide.h"
 #include "MeshComponent.h"
+#include "Renderer.h"
 #include "ScriptBase.h"
+#include "core/StreamingBuffer.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include "imgui_internal.h"
@@ -22,6 +24,23 @@
 #endif
 #include <array>
 #include <string>
+#include <string_view>
+
+namespace {
+
+/**
+ * @brief The extension of a file name, dot included, like
+ * std::filesystem::path::extension() but without allocating.
+ */
+std::string_view GetExtension(std::string_view name) {
+  const std::size_t dot = name.rfind('.');
+  if (dot == std::string_view::npos || dot == 0) {
+    return {};
+  }
+  return name.substr(dot);
+}
+
+}  // namespace
 
 Editor::Editor()
     : m_framebuffer(0),
@@ -29,7 +48,7 @@ Editor::Editor()
       m_depthStencilRBO(0),
       m_viewportSize(800, 600),
       m_viewportFocused(false),
-      m_selectedObject(nullptr) {}
+      m_selectedObject() {}
 
 Editor::~Editor() {
   Shutdown();
@@ -58,6 +77,18 @@ bool Editor::Initialize(GLFWwindow* window,
 
   ImGui_ImplGlfw_InitForOpenGL(window, true);
   ImGui_ImplOpenGL3_Init("#version 460");
+  // Created now rather than by the first ImGui_ImplOpenGL3_NewFrame(), so
+  // building the UI never needs the OpenGL context.
+  ImGui_ImplOpenGL3_CreateDeviceObjects();
+  // UI vertices and indices go through the renderer's streaming buffer.
+  ImGui_ImplOpenGL3_SetStreamAllocator(
+      [](size_t size, ImGui_ImplOpenGL3_StreamAllocation* allocation) {
+        const StreamAllocation range = StreamingBuffer::Allocate(size);
+        allocation->Buffer = range.buffer;
+        allocation->Offset = static_cast<size_t>(range.offset);
+        allocation->Data = range.data;
+        return range.IsValid();
+      });
 
   ImGui::StyleColorsDark();
   ImGuiStyle& style = ImGui::GetStyle();
@@ -94,7 +125,6 @@ void Editor::Shutdown() const {
 }
 
 void Editor::Begin() {
-  ImGui_ImplOpenGL3_NewFrame();
   ImGui_ImplGlfw_NewFrame();
   ImGui::NewFrame();
   Editor::SetupDockspace();
@@ -102,7 +132,20 @@ void Editor::Begin() {
 
 void Editor::End() {
   ImGui::Render();
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
+
+void Editor::RenderDrawData(const ImDrawData* drawData) {
+  if (drawData != nullptr) {
+    // The backend takes a mutable pointer but only reads the draw data.
+    ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData*>(drawData));
+  }
+}
+
+void Editor::SyncFramebuffer(ImVec2 size) {
+  if (size.x != m_framebufferSize.x || size.y != m_framebufferSize.y) {
+    m_framebufferSize = size;
+    UpdateFramebuffer();
+  }
 }
 
 void Editor::Render(const std::shared_ptr<Scene>& scene) {
@@ -120,12 +163,20 @@ void Editor::Render(const std::shared_ptr<Scene>& scene) {
 
   ImGui::SetNextWindowDockID(ImGui::GetID("MyDockSpace"),
                              ImGuiCond_FirstUseEver);
-  RenderPropertiesPanel();
+  RenderPropertiesPanel(scene);
 
   ImGui::SetNextWindowDockID(ImGui::GetID("MyDockSpace"),
                              ImGuiCond_FirstUseEver);
   RenderAssetsPanel();
 
+  ImGui::SetNextWindowDockID(ImGui::GetID("MyDockSpace"),
+                             ImGuiCond_FirstUseEver);
+  RenderMeshLibraryPanel();
+
+  ImGui::SetNextWindowDockID(ImGui::GetID("MyDockSpace"),
+                             ImGuiCond_FirstUseEver);
+  RenderSettingsPanel();
+
   m_notificationManager->RenderNotifications();
 
   ImGui::End();
@@ -197,13 +248,15 @@ void Editor::SetupDockspace() {
 }
 
 void Editor::SetupFramebuffer() {
+  m_framebufferSize = m_viewportSize;
+
   glGenFramebuffers(1, &m_framebuffer);
   glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
 
   glGenTextures(1, &m_viewportColorTexture);
   glBindTexture(GL_TEXTURE_2D, m_viewportColorTexture);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(m_viewportSize.x),
-               static_cast<GLsizei>(m_viewportSize.y), 0, GL_RGB,
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(m_framebufferSize.x),
+               static_cast<GLsizei>(m_framebufferSize.y), 0, GL_RGB,
                GL_UNSIGNED_BYTE, nullptr);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -213,8 +266,8 @@ void Editor::SetupFramebuffer() {
   glGenRenderbuffers(1, &m_depthStencilRBO);
   glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilRBO);
   glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8,
-                        static_cast<GLsizei>(m_viewportSize.x),
-                        static_cast<GLsizei>(m_viewportSize.y));
+                        static_cast<GLsizei>(m_framebufferSize.x),
+                        static_cast<GLsizei>(m_framebufferSize.y));
   glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
                             GL_RENDERBUFFER, m_depthStencilRBO);
 
@@ -227,17 +280,17 @@ void Editor::SetupFramebuffer() {
 
 void Editor::UpdateFramebuffer() const {
   glBindTexture(GL_TEXTURE_2D, m_viewportColorTexture);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(m_viewportSize.x),
-               static_cast<GLsizei>(m_viewportSize.y), 0, GL_RGB,
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(m_framebufferSize.x),
+               static_cast<GLsizei>(m_framebufferSize.y), 0, GL_RGB,
                GL_UNSIGNED_BYTE, nullptr);
 
   glBindRenderbuffer(GL_RENDERBUFFER, m_depthStencilRBO);
   glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8,
-                        static_cast<GLsizei>(m_viewportSize.x),
-                        static_cast<GLsizei>(m_viewportSize.y));
+                        static_cast<GLsizei>(m_framebufferSize.x),
+                        static_cast<GLsizei>(m_framebufferSize.y));
 }
 
-void Editor::RenderViewport(const std::shared_ptr<Scene>& scene) {
+void Editor::RenderViewport(const std::shared_ptr<Scene>& /*scene*/) {
   ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
   ImGui::Begin("Viewport");
 
@@ -253,10 +306,8 @@ void Editor::RenderViewport(const std::shared_ptr<Scene>& scene) {
     newHeight = newWidth / desiredAspectRatio;
   }
 
-  if (newWidth != m_viewportSize.x || newHeight != m_viewportSize.y) {
-    m_viewportSize = ImVec2(newWidth, newHeight);
-    UpdateFramebuffer();
-  }
+  // The framebuffer follows on the render thread, see SyncFramebuffer().
+  m_viewportSize = ImVec2(newWidth, newHeight);
 
   // Use this instead if you want to fill the dock
   /* if (viewportPanelSize.x > 0 && viewportPanelSize.y > 0 &&
@@ -276,30 +327,36 @@ void Editor::RenderViewport(const std::shared_ptr<Scene>& scene) {
 void Editor::RenderSceneHierarchy(const std::shared_ptr<Scene>& scene) {
   ImGui::Begin("Scene Hierarchy");
 
-  for (auto& object : scene->GetGameObjects()) {
+  // Removing while iterating would invalidate the view, so the removal is
+  // recorded and applied by the next scene update.
+  EntityCommandBuffer& commands = scene->GetCommandBuffer();
+
+  for (GameObject* object : scene->GetGameObjects()) {
     ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow;
 
-    if (m_selectedObject == object) {
+    if (m_selectedObject == object->GetHandle()) {
       flags |= ImGuiTreeNodeFlags_Selected;
     }
 
     bool opened = ImGui::TreeNodeEx(
-        (object->GetName() + "##" + std::to_string(object->GetID())).c_str(),
+        m_frameArena->Format("%s##%u", object->GetName().c_str(),
+                             object->GetID()),
         flags);
-    std::string popupId = "item context menu" + std::to_string(object->GetID());
+    const char* popupId =
+        m_frameArena->Format("item context menu%u", object->GetID());
 
     if (ImGui::IsItemClicked(0) || ImGui::IsItemClicked(1)) {
-      m_selectedObject = object;
+      m_selectedObject = object->GetHandle();
     }
 
     if (ImGui::IsItemClicked(1)) {
-      ImGui::OpenPopup(popupId.c_str());
+      ImGui::OpenPopup(popupId);
     }
 
-    if (ImGui::BeginPopup(popupId.c_str())) {
+    if (ImGui::BeginPopup(popupId)) {
       if (ImGui::MenuItem("Delete")) {
-        scene->RemoveGameObject(object);
-        m_selectedObject = nullptr;
+        commands.Destroy(object->GetHandle());
+        m_selectedObject = {};
       }
       ImGui::EndPopup();
     }
@@ -311,30 +368,35 @@ void Editor::RenderSceneHierarchy(const std::shared_ptr<Scene>& scene) {
   ImGui::End();
 }
 
-void Editor::RenderPropertiesPanel() const {
+void Editor::RenderPropertiesPanel(const std::shared_ptr<Scene>& scene) const {
   ImGui::Begin("Properties");
 
-  if (m_selectedObject != nullptr) {
-    std::string popupId =
-        "add component menu" + std::to_string(m_selectedObject->GetID());
+  // A stale handle simply resolves to nothing selected.
+  GameObject* selectedObject = scene->GetGameObject(m_selectedObject);
+
+  if (selectedObject != nullptr) {
+    const char* popupId = m_frameArena->Format("add component menu%u",
+                                               selectedObject->GetID());
 
-    //ImGui::Text("Selected: %s", m_selectedObject->GetName().c_str());
+    //ImGui::Text("Selected: %s", selectedObject->GetName().c_str());
 
-    std::string strName = m_selectedObject->GetName();
+    const std::string& strName = selectedObject->GetName();
     constexpr size_t bufferSize = 256;
     std::array<char, bufferSize> buffer = {};
 
     strName.copy(buffer.data(), bufferSize - 1);
     buffer[std::min(strName.length(), bufferSize - 1)] = '\0';  // Ensure null-termination
 
-    if (ImGui::InputText((" Name##" + std::to_string(m_selectedObject->GetID())).c_str(), buffer.data(), bufferSize)) {
-      m_selectedObject->SetName(buffer.data());
+    if (ImGui::InputText(
+            m_frameArena->Format(" Name##%u", selectedObject->GetID()),
+            buffer.data(), bufferSize)) {
+      selectedObject->SetName(buffer.data());
     }
 
     std::string errorMessage;
 
     if (auto* transform =
-            m_selectedObject->GetComponent<TransformComponent>()) {
+            selectedObject->GetComponent<TransformComponent>()) {
       if (ImGui::CollapsingHeader("Transform Component")) {
         glm::vec3 position = transform->GetPosition();
         glm::vec3 rotation = transform->GetRotation();
@@ -352,7 +414,7 @@ void Editor::RenderPropertiesPanel() const {
       }
     }
 
-    if (auto* mesh = m_selectedObject->GetComponent<MeshComponent>()) {
+    if (auto* mesh = selectedObject->GetComponent<MeshComponent>()) {
       if (ImGui::CollapsingHeader("Mesh Component")) {
         MeshType currentMeshType = mesh->GetMeshType();
         const char* currentMeshName =
@@ -363,8 +425,7 @@ void Editor::RenderPropertiesPanel() const {
             bool isSelected = (meshType == currentMeshType);
 
             if (ImGui::Selectable(MeshTypeNames[i].data(), isSelected)) {
-              mesh->ClearMesh();
-              mesh->SetMesh(std::make_shared<Mesh>(meshType));
+              mesh->SetMesh(MeshLibrary::Get(meshType));
             }
 
             if (isSelected) {
@@ -377,7 +438,7 @@ void Editor::RenderPropertiesPanel() const {
       }
     }
 
-    if (auto* light = m_selectedObject->GetComponent<LightComponent>()) {
+    if (auto* light = selectedObject->GetComponent<LightComponent>()) {
       if (ImGui::CollapsingHeader("Light Component")) {
         glm::vec3 color = light->GetColor();
         float intensity = light->GetIntensity();
@@ -395,9 +456,9 @@ void Editor::RenderPropertiesPanel() const {
       }
     }
 
-    if (auto* script = m_selectedObject->GetComponent<ScriptComponent>()) {
-      std::string headerName = "Script Component (" + script->GetName() + ")";
-      if (ImGui::CollapsingHeader(headerName.c_str())) {
+    if (auto* script = selectedObject->GetComponent<ScriptComponent>()) {
+      if (ImGui::CollapsingHeader(m_frameArena->Format(
+              "Script Component (%s)", script->GetName().c_str()))) {
         auto* instance = script->GetScriptInstance();
 
         if (instance) {
@@ -441,7 +502,7 @@ void Editor::RenderPropertiesPanel() const {
             }
           }
         } else {
-          ImGui::Text(("Script " + script->GetName() + " is not compiled.").c_str());
+          ImGui::Text("Script %s is not compiled.", script->GetName().c_str());
         }
 
 
@@ -455,16 +516,18 @@ void Editor::RenderPropertiesPanel() const {
     }
 
     if (ImGui::Button("Add Component")) {
-      ImGui::OpenPopup(popupId.c_str());
+      ImGui::OpenPopup(popupId);
     }
 
-    if (ImGui::BeginPopup(popupId.c_str())) {
+    if (ImGui::BeginPopup(popupId)) {
+      EntityCommandBuffer& commands = scene->GetCommandBuffer();
+
       if (ImGui::MenuItem("LightComponent")) {
-        m_selectedObject->AddComponent<LightComponent>();
+        commands.AddComponent<LightComponent>(m_selectedObject);
       }
       if (ImGui::MenuItem("MeshComponent")) {
-        m_selectedObject->AddComponent<MeshComponent>(
-            std::make_shared<Mesh>(MeshType::Cube));
+        commands.AddComponent<MeshComponent>(
+            m_selectedObject, MeshLibrary::Get(MeshType::Cube));
       }
       ImGui::EndPopup();
     }
@@ -479,6 +542,8 @@ void Editor::RenderMenuBar(const std::shared_ptr<Scene>& scene) {
       if (ImGui::MenuItem("New Scene")) {
         m_sceneManager->DestroyScene();
         m_sceneManager->CreateScene();
+        // Handles are per scene, so the selection must not leak into the new one.
+        m_selectedObject = {};
       }
       if (ImGui::MenuItem("Open Scene...")) {
         // TODO: Implement scene loading.
@@ -508,53 +573,43 @@ void Editor::RenderMenuBar(const std::shared_ptr<Scene>& scene) {
     }
 
     if (ImGui::BeginMenu("Add")) {
+      // New objects are created by the next scene update, and selected then.
+      EntityCommandBuffer& commands = scene->GetCommandBuffer();
+      auto select = [this](GameObject& gameObject) {
+        m_selectedObject = gameObject.GetHandle();
+      };
+
       if (ImGui::MenuItem("Empty GameObject")) {
-        auto gameObject = std::make_shared<GameObject>(
-            scene->GenerateUniqueName("EmptyGameObject"));
-        gameObject->Initialize();
-        scene->AddGameObject(gameObject);
-        m_selectedObject = gameObject;
+        commands.Create(scene->GenerateUniqueName("EmptyGameObject"), select);
       }
 
       ImGui::Separator();
 
       if (ImGui::MenuItem("Cube")) {
-        auto gameObject =
-            std::make_shared<GameObject>(scene->GenerateUniqueName("Cube"));
-        gameObject->Initialize();
-        gameObject->AddComponent<MeshComponent>(
-            std::make_shared<Mesh>(MeshType::Cube));
-        scene->AddGameObject(gameObject);
-        m_selectedObject = gameObject;
+        PendingEntity cube =
+            commands.Create(scene->GenerateUniqueName("Cube"), select);
+        commands.AddComponent<MeshComponent>(
+            cube, MeshLibrary::Get(MeshType::Cube));
       }
       if (ImGui::MenuItem("Plane")) {
-        auto gameObject =
-            std::make_shared<GameObject>(scene->GenerateUniqueName("Plane"));
-        gameObject->Initialize();
-        gameObject->AddComponent<MeshComponent>(
-            std::make_shared<Mesh>(MeshType::Plane));
-        scene->AddGameObject(gameObject);
-        m_selectedObject = gameObject;
+        PendingEntity plane =
+            commands.Create(scene->GenerateUniqueName("Plane"), select);
+        commands.AddComponent<MeshComponent>(
+            plane, MeshLibrary::Get(MeshType::Plane));
       }
       if (ImGui::MenuItem("Capsule")) {
-        auto gameObject =
-            std::make_shared<GameObject>(scene->GenerateUniqueName("Capsule"));
-        gameObject->Initialize();
-        gameObject->AddComponent<MeshComponent>(
-            std::make_shared<Mesh>(MeshType::Capsule));
-        scene->AddGameObject(gameObject);
-        m_selectedObject = gameObject;
+        PendingEntity capsule =
+            commands.Create(scene->GenerateUniqueName("Capsule"), select);
+        commands.AddComponent<MeshComponent>(
+            capsule, MeshLibrary::Get(MeshType::Capsule));
       }
 
       ImGui::Separator();
 
       if (ImGui::MenuItem("Point Light")) {
-        auto gameObject = std::make_shared<GameObject>(
-            scene->GenerateUniqueName("PointLight"));
-        gameObject->Initialize();
-        gameObject->AddComponent<LightComponent>();
-        scene->AddGameObject(gameObject);
-        m_selectedObject = gameObject;
+        PendingEntity light =
+            commands.Create(scene->GenerateUniqueName("PointLight"), select);
+        commands.AddComponent<LightComponent>(light);
       }
 
       ImGui::EndMenu();
@@ -594,9 +649,7 @@ void Editor::RenderAssetsPanel() {
 
   ImGui::SameLine();
 
-  std::string displayPath = m_currentPath;
-
-  ImGui::Text("%s", displayPath.c_str());
+  ImGui::Text("%s", m_currentPath.c_str());
 
   ImGui::PopStyleVar();
   ImGui::Separator();
@@ -629,7 +682,7 @@ void Editor::RenderAssetsPanel() {
         UpdateDirectoryContents();
       }
     } else {
-      std::string ext = std::filesystem::path(entry.name).extension().string();
+      const std::string_view ext = GetExtension(entry.name);
       const char* icon = ICON_LC_FILE;  // Default
 
       if (ext == ".png" || ext == ".jpg" || ext == ".jpeg")
@@ -659,8 +712,7 @@ void Editor::RenderAssetsPanel() {
     if (labelSize.x > labelWidth) {
       if (!isSelected) {
         if (entry.name.size() > 14) {
-          std::string truncated = entry.name.substr(0, 14) + "...";
-          ImGui::TextWrapped("%s", truncated.c_str());
+          ImGui::TextWrapped("%.14s...", entry.name.c_str());
         } else {
           ImGui::TextWrapped("%s", entry.name.c_str());
         }
@@ -685,6 +737,88 @@ void Editor::RenderAssetsPanel() {
   ImGui::End();
 }
 
+void Editor::RenderMeshLibraryPanel() {
+  ImGui::Begin("Meshes");
+
+  MeshLibrary::GetStats(m_meshStats);
+  std::size_t totalCpuBytes = 0;
+  std::size_t totalGpuBytes = 0;
+  for (const MeshLibrary::MeshStats& mesh : m_meshStats) {
+    totalCpuBytes += mesh.cpuBytes;
+    totalGpuBytes += mesh.gpuBytes;
+  }
+
+  ImGui::Text("%zu unique meshes, %.1f KiB CPU, %.1f KiB GPU",
+              m_meshStats.size(), totalCpuBytes / 1024.0,
+              totalGpuBytes / 1024.0);
+  ImGui::Text("Mesh buffer: %.1f of %.1f KiB used",
+              MeshBuffer::GetUsedBytes() / 1024.0,
+              MeshBuffer::GetCapacityBytes() / 1024.0);
+
+  // Released once the table is drawn: the keys point into the library.
+  const bool releaseUnused = ImGui::Button("Release unused");
+
+  constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders |
+                                         ImGuiTableFlags_RowBg |
+                                         ImGuiTableFlags_SizingStretchProp;
+  if (ImGui::BeginTable("MeshLibrary", 6, tableFlags)) {
+    ImGui::TableSetupColumn("Mesh");
+    ImGui::TableSetupColumn("Users");
+    ImGui::TableSetupColumn("Vertices");
+    ImGui::TableSetupColumn("Indices");
+    ImGui::TableSetupColumn("CPU KiB");
+    ImGui::TableSetupColumn("GPU KiB");
+    ImGui::TableHeadersRow();
+
+    for (const MeshLibrary::MeshStats& mesh : m_meshStats) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(mesh.key->c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%ld", mesh.users);
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", mesh.vertexCount);
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", mesh.indexCount);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", mesh.cpuBytes / 1024.0);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.1f", mesh.gpuBytes / 1024.0);
+    }
+
+    ImGui::EndTable();
+  }
+
+  if (releaseUnused) {
+    MeshLibrary::ReleaseUnused();
+  }
+
+  ImGui::End();
+}
+
+void Editor::RenderSettingsPanel() const {
+  ImGui::Begin("Render");
+
+  const std::shared_ptr<Renderer> renderer = m_renderer.lock();
+  if (renderer) {
+    // Unavailable where the culling compute shaders could not be built.
+    bool gpuCulling = renderer->IsGpuCulling();
+    ImGui::BeginDisabled(!renderer->IsGpuCullingAvailable());
+    if (ImGui::Checkbox("GPU culling", &gpuCulling)) {
+      renderer->SetGpuCulling(gpuCulling);
+    }
+    ImGui::EndDisabled();
+
+    // Positive values pick coarser levels of detail.
+    float lodBias = renderer->GetLodBias();
+    if (ImGui::SliderFloat("LOD bias", &lodBias, -2.0f, 4.0f, "%.2f")) {
+      renderer->SetLodBias(lodBias);
+    }
+  }
+
+  ImGui::End();
+}
+
 void Editor::UpdateDirectoryContents() {
   m_currentDirectoryContents.clear();
 
@@ -1,5 +1,8 @@
 #include "Engine.h"
 
+#include <chrono>
+#include <cmath>
+
 #include "MeshComponent.h"
 
 // Initialize engine variables
@@ -13,7 +16,11 @@ Engine::~Engine() {
 // Set up renderer, scene manager, and demo GameObjects
 bool Engine::Initialize() {
   m_renderer = std::make_shared<Renderer>();
+  m_jobSystem = std::make_shared<JobSystem>();
+  m_frameArena = std::make_shared<FrameArena>();
   m_sceneManager = std::make_shared<SceneManager>();
+  m_sceneManager->SetJobSystem(m_jobSystem);
+  m_renderer->SetJobSystem(m_jobSystem);
 
   if (!m_renderer->Initialize()) {
     std::cerr << "renderer\n";
@@ -26,54 +33,102 @@ bool Engine::Initialize() {
     return false;
   }
 
+  m_editor->SetFrameArena(m_frameArena);
+  m_editor->SetRenderer(m_renderer);
   m_renderer->SetEditor(m_editor);
 
   m_sceneManager->CreateScene();
 
   // Add cube object to the scene
-  auto cube = std::make_shared<GameObject>("Cube");
-  cube->Initialize();
+  auto cube = m_sceneManager->CreateObjectInCurrentScene("Cube");
   cube->GetComponent<TransformComponent>()->SetPosition(
       glm::vec3(2.5f, 0.0f, 5.0f));
-  auto scriptComponent = cube->AddComponent<ScriptComponent>();
-  cube->GetComponent<ScriptComponent>()->LoadScript("PlayerController");
+  cube->AddComponent<ScriptComponent>()->LoadScript("PlayerController");
   // This is, of course, just for the demo scene. Will need to implement a way
   // to scan the scripts in the assets and use a selector.
   cube->AddComponent<MeshComponent>();
-  m_sceneManager->AddObjectToCurrentScene(cube);
 
   // Add plane object to the scene
-  auto plane = std::make_shared<GameObject>("Plane");
-  plane->Initialize();
+  auto plane = m_sceneManager->CreateObjectInCurrentScene("Plane");
   plane->GetComponent<TransformComponent>()->SetPosition(
       glm::vec3(0.0f, -2.0f, 0.0f));
   plane->GetComponent<TransformComponent>()->SetScale(
       glm::vec3(25.0f, 1.0f, 25.0f));
-  plane->AddComponent<MeshComponent>(std::make_shared<Mesh>(MeshType::Plane));
-  m_sceneManager->AddObjectToCurrentScene(plane);
+  plane->AddComponent<MeshComponent>(MeshLibrary::Get(MeshType::Plane));
 
-  auto light = std::make_shared<GameObject>("Light");
-  light->Initialize();
+  auto light = m_sceneManager->CreateObjectInCurrentScene("Light");
   light->AddComponent<LightComponent>();
-  m_sceneManager->AddObjectToCurrentScene(light);
 
   m_isRunning = true;
 
   return true;
 }
 
-// Main engine loop for updating and rendering the scene
+// Main engine loop: simulate in fixed steps, render as often as possible
 void Engine::Run() {
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point previousTime = Clock::now();
+  double accumulator = 0.0;
+
+  if (m_pipelined) {
+    m_renderThread = std::make_unique<RenderThread>(m_renderer);
+    m_renderThread->Start();
+  }
+
   while (m_isRunning) {
-    // Update with a fixed time step
-    m_sceneManager->UpdateCurrentScene(0.016f);
-    m_renderer->Render(m_sceneManager->GetScene());  // Render current scene
+    // Scratch data of the frame before last is no longer referenced.
+    m_frameArena->BeginFrame();
+
+    Clock::time_point currentTime = Clock::now();
+    double frameTime =
+        std::chrono::duration<double>(currentTime - previousTime).count();
+    previousTime = currentTime;
+    accumulator += frameTime;
+
+    int steps = 0;
+    while (accumulator >= m_fixedTimeStep && steps < MaxStepsPerFrame) {
+      m_sceneManager->UpdateCurrentScene(static_cast<float>(m_fixedTimeStep));
+      accumulator -= m_fixedTimeStep;
+      ++steps;
+    }
+
+    // Simulation cannot keep up: drop the backlog rather than spending every
+    // following frame catching up (the spiral of death).
+    if (accumulator >= m_fixedTimeStep) {
+      accumulator = std::fmod(accumulator, m_fixedTimeStep);
+    }
+
+    const auto interpolation =
+        static_cast<float>(accumulator / m_fixedTimeStep);
+
+    if (m_renderThread != nullptr) {
+      // Extract this frame while the render thread still draws the last one.
+      m_renderer->BuildSnapshot(m_sceneManager->GetScene(),
+                                static_cast<float>(frameTime), interpolation,
+                                m_renderThread->GetWriteSnapshot());
+      m_renderThread->Publish();
+    } else {
+      m_renderer->Render(m_sceneManager->GetScene(),
+                         static_cast<float>(frameTime), interpolation);
+    }
+
+    // Asset meshes uploaded by an earlier frame no longer need their CPU copy;
+    // this thread is the only one that reads it.
+    MeshLibrary::ReleaseUploadedCpuData();
+
     m_isRunning = !m_renderer->ShouldClose();
   }
+
+  // Hands the OpenGL context back to this thread for shutdown.
+  m_renderThread = nullptr;
 }
 
 // Clean up renderer and scene manager
 void Engine::Shutdown() {
+  m_renderThread = nullptr;
+  // Library meshes must not outlive the GLDeletionQueue in static teardown.
+  MeshLibrary::Clear();
   if (m_editor) {
     // m_editor->Shutdown();
     // delete m_editor;
@@ -89,4 +144,6 @@ void Engine::Shutdown() {
     // delete m_sceneManager;
     m_sceneManager = nullptr;
   }
+  m_jobSystem = nullptr;
+  m_frameArena = nullptr;
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "core/EntityCommandBuffer.h"
+
+#include "Scene.h"
+
+PendingEntity EntityCommandBuffer::Create(
+    std::string name, std::function<void(GameObject&)> initialize) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::uint32_t id = m_pendingCount++;
+  Command& command = m_commands.emplace_back();
+  command.type = CommandType::Create;
+  command.pending = id;
+  command.name = std::move(name);
+  command.apply = std::move(initialize);
+
+  return {id, m_batch};
+}
+
+void EntityCommandBuffer::Destroy(EntityHandle handle) {
+  Record(CommandType::Destroy, handle, {NoPending}, nullptr);
+}
+
+void EntityCommandBuffer::Record(CommandType type, EntityHandle handle,
+                                 PendingEntity pending,
+                                 std::function<void(GameObject&)> apply) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // An expired id would index another batch's objects.
+  if (pending.id != NoPending && pending.batch != m_batch) {
+    return;
+  }
+
+  Command& command = m_commands.emplace_back();
+  command.type = type;
+  command.handle = handle;
+  command.pending = pending.id;
+  command.apply = std::move(apply);
+}
+
+void EntityCommandBuffer::Flush(Scene& scene) {
+  std::uint32_t pendingCount;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_executing.swap(m_commands);
+    pendingCount = m_pendingCount;
+    m_pendingCount = 0;
+    // Skip 0 on wrap-around, which default-constructed entities carry.
+    m_batch = m_batch == UINT32_MAX ? 1 : m_batch + 1;
+  }
+
+  if (m_executing.empty()) {
+    return;
+  }
+
+  // Grow the scene's arrays once for the whole batch.
+  scene.ReserveGameObjects(pendingCount);
+  m_created.assign(pendingCount, EntityHandle{});
+
+  for (Command& command : m_executing) {
+    if (command.type == CommandType::Create) {
+      GameObject* object = scene.CreateGameObject(command.name);
+      m_created[command.pending] = object->GetHandle();
+
+      if (command.apply) {
+        command.apply(*object);
+      }
+      continue;
+    }
+
+    EntityHandle handle = command.pending != NoPending
+                              ? m_created[command.pending]
+                              : command.handle;
+
+    if (command.type == CommandType::Destroy) {
+      m_destroyed.push_back(handle);
+    } else if (GameObject* object = scene.GetGameObject(handle)) {
+      command.apply(*object);
+    }
+  }
+
+  scene.RemoveGameObjects(m_destroyed);
+
+  m_executing.clear();
+  m_destroyed.clear();
+}
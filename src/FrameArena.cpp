@@ -0,0 +1,97 @@
+#include "core/FrameArena.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <new>
+
+namespace {
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/** Alignment of the arena block; covers every fundamental type. */
+constexpr std::size_t BlockAlignment = alignof(std::max_align_t);
+
+}  // namespace
+
+LinearArena::LinearArena(std::size_t capacity) : m_capacity(capacity) {
+  m_buffer = static_cast<std::byte*>(
+      ::operator new(m_capacity, std::align_val_t{BlockAlignment}));
+  ++m_heapAllocations;
+}
+
+LinearArena::~LinearArena() {
+  Reset();
+  ::operator delete(m_buffer, std::align_val_t{BlockAlignment});
+}
+
+void* LinearArena::Allocate(std::size_t size, std::size_t alignment) {
+  // Offsets are relative to a block aligned to BlockAlignment, so stricter
+  // alignments are applied to the address itself.
+  auto base = reinterpret_cast<std::uintptr_t>(m_buffer);
+  std::size_t offset = AlignUp(base + m_offset, alignment) - base;
+
+  if (offset + size <= m_capacity) {
+    m_offset = offset + size;
+    return m_buffer + offset;
+  }
+
+  alignment = std::max(alignment, alignof(std::max_align_t));
+  void* memory = ::operator new(size, std::align_val_t{alignment});
+  m_overflow.push_back({memory, alignment});
+  m_overflowBytes += size + alignment;
+  ++m_heapAllocations;
+
+  return memory;
+}
+
+void LinearArena::Reset() {
+  if (!m_overflow.empty()) {
+    for (const Overflow& overflow : m_overflow) {
+      ::operator delete(overflow.memory, std::align_val_t{overflow.alignment});
+    }
+
+    // Grow to the peak so the same workload fits next time.
+    std::size_t capacity = std::max(m_capacity * 2, GetUsed());
+    ::operator delete(m_buffer, std::align_val_t{BlockAlignment});
+    m_buffer = static_cast<std::byte*>(
+        ::operator new(capacity, std::align_val_t{BlockAlignment}));
+    m_capacity = capacity;
+    ++m_heapAllocations;
+
+    m_overflow.clear();
+    m_overflowBytes = 0;
+  }
+
+  m_offset = 0;
+}
+
+FrameArena::FrameArena(std::size_t capacity)
+    : m_arenas{LinearArena(capacity), LinearArena(capacity)} {}
+
+void FrameArena::BeginFrame() {
+  m_current ^= 1;
+  m_arenas[m_current].Reset();
+}
+
+const char* FrameArena::Format(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  va_list argsCopy;
+  va_copy(argsCopy, args);
+  int length = std::vsnprintf(nullptr, 0, format, args);
+  va_end(args);
+
+  if (length < 0) {
+    va_end(argsCopy);
+    return "";
+  }
+
+  auto* text = AllocateArray<char>(static_cast<std::size_t>(length) + 1);
+  std::vsnprintf(text, static_cast<std::size_t>(length) + 1, format, argsCopy);
+  va_end(argsCopy);
+
+  return text;
+}
@@ -0,0 +1,75 @@
+#include "core/FrustumCulling.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FRUSTUM_CULLING_SSE 1
+#endif
+
+namespace {
+
+bool IsSphereVisible(const Frustum& frustum, float x, float y, float z,
+                     float radius) {
+  for (const glm::vec4& plane : frustum.planes) {
+    if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+std::size_t CullSpheres(const Frustum& frustum, const SphereSoA& spheres,
+                        std::size_t count, std::uint8_t* visible) {
+  std::size_t visibleCount = 0;
+  std::size_t i = 0;
+
+#if defined(FRUSTUM_CULLING_SSE)
+  // SSE2 is part of x86-64, so unlike the transform kernels this needs no
+  // CPUID check or dedicated compile flags.
+  __m128 planeX[6];
+  __m128 planeY[6];
+  __m128 planeZ[6];
+  __m128 planeW[6];
+  for (int p = 0; p < 6; ++p) {
+    planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+    planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+    planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+    planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+  }
+
+  for (; i + 4 <= count; i += 4) {
+    const __m128 x = _mm_loadu_ps(spheres.centerX + i);
+    const __m128 y = _mm_loadu_ps(spheres.centerY + i);
+    const __m128 z = _mm_loadu_ps(spheres.centerZ + i);
+    const __m128 negativeRadius =
+        _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + i));
+
+    // Lanes stay set while their sphere is not entirely behind any plane.
+    int mask = 0xF;
+    for (int p = 0; p < 6 && mask != 0; ++p) {
+      __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+          _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+      mask &= _mm_movemask_ps(_mm_cmpge_ps(distance, negativeRadius));
+    }
+
+    for (int lane = 0; lane < 4; ++lane) {
+      const auto laneVisible = static_cast<std::uint8_t>((mask >> lane) & 1);
+      visible[i + lane] = laneVisible;
+      visibleCount += laneVisible;
+    }
+  }
+#endif
+
+  for (; i < count; ++i) {
+    const bool sphereVisible =
+        IsSphereVisible(frustum, spheres.centerX[i], spheres.centerY[i],
+                        spheres.centerZ[i], spheres.radius[i]);
+    visible[i] = sphereVisible ? 1 : 0;
+    visibleCount += sphereVisible ? 1 : 0;
+  }
+
+  return visibleCount;
+}
@@ -0,0 +1,52 @@
+#include "core/GLDeletionQueue.h"
+
+#include <mutex>
+#include <vector>
+
+namespace {
+
+std::mutex queueMutex;
+std::vector<GLuint> vertexArrays;
+std::vector<GLuint> buffers;
+
+// Swapped with the queues under the lock, so the GL calls run unlocked and
+// the storage of both sides is reused from frame to frame.
+std::vector<GLuint> pendingVertexArrays;
+std::vector<GLuint> pendingBuffers;
+
+}  // namespace
+
+void GLDeletionQueue::DeleteVertexArray(GLuint id) {
+  std::lock_guard<std::mutex> lock(queueMutex);
+  vertexArrays.push_back(id);
+}
+
+void GLDeletionQueue::DeleteBuffer(GLuint id) {
+  std::lock_guard<std::mutex> lock(queueMutex);
+  buffers.push_back(id);
+}
+
+void GLDeletionQueue::Flush() {
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    if (vertexArrays.empty() && buffers.empty()) {
+      return;
+    }
+
+    pendingVertexArrays.swap(vertexArrays);
+    pendingBuffers.swap(buffers);
+  }
+
+  if (!pendingVertexArrays.empty()) {
+    glDeleteVertexArrays(static_cast<GLsizei>(pendingVertexArrays.size()),
+                         pendingVertexArrays.data());
+    pendingVertexArrays.clear();
+  }
+
+  if (!pendingBuffers.empty()) {
+    glDeleteBuffers(static_cast<GLsizei>(pendingBuffers.size()),
+                    pendingBuffers.data());
+    pendingBuffers.clear();
+  }
+}
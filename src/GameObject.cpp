@@ -1,3 +1,34 @@
 #include "GameObject.h"
 
-unsigned int GameObject::nextID = 1;
\ No newline at end of file
+unsigned int GameObject::nextID = 1;
+
+Component* GameObject::GetComponent(ComponentType type) {
+  void* component = m_componentSlots[static_cast<std::size_t>(type)];
+  return component != nullptr
+             ? GetComponentTypeInfo(type).asComponent(component)
+             : nullptr;
+}
+
+void GameObject::Update(float deltaTime) {
+  //std::cout << "\tUpdating " << m_name << "." << std::endl; Will reuse this in the Log Dock
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    const ComponentTypeInfo& info =
+        GetComponentTypeInfo(static_cast<ComponentType>(i));
+
+    if (m_componentSlots[i] != nullptr && info.updateColumn != nullptr) {
+      info.updateColumn(m_componentSlots[i], 1, deltaTime);
+    }
+  }
+}
+
+void GameObject::Render() {
+  //std::cout << "\tRendering " << m_name << ".\n";
+  for (std::size_t i = 0; i < ComponentTypeCount; ++i) {
+    const ComponentTypeInfo& info =
+        GetComponentTypeInfo(static_cast<ComponentType>(i));
+
+    if (m_componentSlots[i] != nullptr && info.renderColumn != nullptr) {
+      info.renderColumn(m_componentSlots[i], 1);
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "GpuCuller.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include "core/Bounds.h"
+
+GpuCuller::GpuCuller(std::shared_ptr<ShaderManager> shaderManager)
+    : m_shaderManager(std::move(shaderManager)) {}
+
+GpuCuller::~GpuCuller() {
+  Shutdown();
+}
+
+bool GpuCuller::Initialize() {
+  m_available =
+      m_shaderManager->LoadComputeShader("cull", "shaders/cull.comp") &&
+      m_shaderManager->LoadComputeShader("hiz", "shaders/hiz.comp");
+
+  if (!m_available) {
+    std::cerr << "GPU culling unavailable, culling on the CPU\n";
+    return false;
+  }
+
+  glCreateFramebuffers(1, &m_depthFramebuffer);
+  return true;
+}
+
+void GpuCuller::Shutdown() {
+  glDeleteFramebuffers(1, &m_depthFramebuffer);
+  glDeleteTextures(1, &m_depthTexture);
+  glDeleteTextures(1, &m_pyramidTexture);
+  m_depthFramebuffer = 0;
+  m_depthTexture = 0;
+  m_pyramidTexture = 0;
+  m_depthWidth = 0;
+  m_depthHeight = 0;
+  m_pyramidValid = false;
+  m_available = false;
+}
+
+void GpuCuller::Cull(const glm::mat4& viewProjection,
+                     const InstanceBounds* bounds, std::size_t count,
+                     const StreamAllocation& commands,
+                     const StreamAllocation& visible) {
+  if (count == 0) {
+    return;
+  }
+
+  const StreamAllocation boundsRange =
+      StreamingBuffer::Upload(bounds, count * sizeof(InstanceBounds),
+                              StreamingBuffer::GetStorageAlignment());
+
+  StreamingBuffer::BindRange(GL_SHADER_STORAGE_BUFFER, VisibleBinding,
+                             visible);
+  StreamingBuffer::BindRange(GL_SHADER_STORAGE_BUFFER, BoundsBinding,
+                             boundsRange);
+  StreamingBuffer::BindRange(GL_SHADER_STORAGE_BUFFER, CommandBinding,
+                             commands);
+
+  m_shaderManager->UseShader("cull");
+
+  const Frustum frustum = Frustum::FromMatrix(viewProjection);
+  char uniformName[32];
+  for (std::size_t i = 0; i < frustum.planes.size(); ++i) {
+    std::snprintf(uniformName, sizeof(uniformName), "frustumPlanes[%zu]", i);
+    m_shaderManager->SetVector4(uniformName, frustum.planes[i]);
+  }
+
+  m_shaderManager->SetInt("instanceCount", static_cast<int>(count));
+  m_shaderManager->SetBool("occlusion", m_pyramidValid);
+  m_shaderManager->SetInt("depthPyramid", 0);
+  if (m_pyramidValid) {
+    m_shaderManager->SetMatrix4("pyramidViewProjection",
+                                m_pyramidViewProjection);
+    glBindTextureUnit(0, m_pyramidTexture);
+  }
+
+  // Large frames are split so no dispatch exceeds the guaranteed group count.
+  const std::size_t groupCount = (count + CullGroupSize - 1) / CullGroupSize;
+  for (std::size_t first = 0; first < groupCount; first += MaxGroupCount) {
+    m_shaderManager->SetInt("firstInstance",
+                            static_cast<int>(first * CullGroupSize));
+    glDispatchCompute(
+        static_cast<GLuint>(std::min(groupCount - first, MaxGroupCount)), 1,
+        1);
+  }
+
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                  GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuCuller::UpdateDepthPyramid(GLuint framebuffer, int width, int height,
+                                   const glm::mat4& viewProjection) {
+  if (!m_available || width < 2 || height < 2) {
+    m_pyramidValid = false;
+    return;
+  }
+
+  if (width != m_depthWidth || height != m_depthHeight) {
+    ResizeDepthPyramid(width, height);
+  }
+
+  glBlitNamedFramebuffer(framebuffer, m_depthFramebuffer, 0, 0, width, height,
+                         0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+  // Level 0 reduces the depth texture; every other level the one above it.
+  m_shaderManager->UseShader("hiz");
+  m_shaderManager->SetInt("depth", 0);
+  glBindTextureUnit(0, m_depthTexture);
+
+  int levelWidth = std::max(width / 2, 1);
+  int levelHeight = std::max(height / 2, 1);
+
+  for (int level = 0; level < m_pyramidLevels; ++level) {
+    m_shaderManager->SetBool("fromDepth", level == 0);
+    if (level > 0) {
+      glBindImageTexture(0, m_pyramidTexture, level - 1, GL_FALSE, 0,
+                         GL_READ_ONLY, GL_R32F);
+    }
+    glBindImageTexture(1, m_pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY,
+                       GL_R32F);
+
+    glDispatchCompute(
+        static_cast<GLuint>((levelWidth + PyramidGroupSize - 1) /
+                            PyramidGroupSize),
+        static_cast<GLuint>((levelHeight + PyramidGroupSize - 1) /
+                            PyramidGroupSize),
+        1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                    GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    levelWidth = std::max(levelWidth / 2, 1);
+    levelHeight = std::max(levelHeight / 2, 1);
+  }
+
+  m_pyramidViewProjection = viewProjection;
+  m_pyramidValid = true;
+}
+
+void GpuCuller::ResizeDepthPyramid(int width, int height) {
+  glDeleteTextures(1, &m_depthTexture);
+  glDeleteTextures(1, &m_pyramidTexture);
+
+  m_depthWidth = width;
+  m_depthHeight = height;
+  m_pyramidValid = false;
+
+  glCreateTextures(GL_TEXTURE_2D, 1, &m_depthTexture);
+  glTextureStorage2D(m_depthTexture, 1, GL_DEPTH24_STENCIL8, width, height);
+  glTextureParameteri(m_depthTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTextureParameteri(m_depthTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glNamedFramebufferTexture(m_depthFramebuffer, GL_DEPTH_STENCIL_ATTACHMENT,
+                            m_depthTexture, 0);
+
+  const int pyramidWidth = std::max(width / 2, 1);
+  const int pyramidHeight = std::max(height / 2, 1);
+  m_pyramidLevels = 1;
+  while ((std::max(pyramidWidth, pyramidHeight) >> m_pyramidLevels) > 0) {
+    ++m_pyramidLevels;
+  }
+
+  glCreateTextures(GL_TEXTURE_2D, 1, &m_pyramidTexture);
+  glTextureStorage2D(m_pyramidTexture, m_pyramidLevels, GL_R32F, pyramidWidth,
+                     pyramidHeight);
+  glTextureParameteri(m_pyramidTexture, GL_TEXTURE_MIN_FILTER,
+                      GL_NEAREST_MIPMAP_NEAREST);
+  glTextureParameteri(m_pyramidTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
@@ -0,0 +1,266 @@
+#include "core/JobSystem.h"
+
+namespace {
+
+// Lets Run() and Wait() find the deque of the calling worker.
+thread_local const JobSystem* tlsJobSystem = nullptr;
+thread_local std::size_t tlsQueueIndex = 0;
+
+}  // namespace
+
+JobSystem::JobSystem(std::size_t workerCount) {
+  if (workerCount == 0) {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+  }
+
+  for (std::size_t i = 0; i <= workerCount; ++i) {
+    m_queues.push_back(std::make_unique<WorkQueue>());
+  }
+
+  tlsJobSystem = this;
+  tlsQueueIndex = 0;
+
+  for (std::size_t i = 1; i <= workerCount; ++i) {
+    m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  m_stopping = true;
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+  }
+  m_wakeCondition.notify_all();
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+
+  // Dropped jobs go back to the pool before it is released.
+  for (auto& queue : m_queues) {
+    while (Job* job = queue->PopBack()) {
+      JobHandle::Adopt(job);
+    }
+  }
+  while (Job* job = m_externalQueue.PopBack()) {
+    JobHandle::Adopt(job);
+  }
+
+  if (tlsJobSystem == this) {
+    tlsJobSystem = nullptr;
+  }
+}
+
+JobSystem::JobHandle JobSystem::AllocateJob() {
+  void* block = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_jobPoolMutex);
+    block = m_jobPool.Allocate();
+  }
+
+  Job* job = new (block) Job();
+  job->owner = this;
+  return JobHandle::Adopt(job);
+}
+
+void JobSystem::DestroyJob(Job* job) {
+  if (job->destroy != nullptr) {
+    job->destroy(job->task);
+  }
+
+  // Continuations of a job that never finished are dropped with it.
+  for (Job* continuation = job->continuations; continuation != nullptr;) {
+    Job* next = continuation->nextContinuation;
+    JobHandle::Adopt(continuation);
+    continuation = next;
+  }
+
+  // Releases the parent, outside of the pool's lock.
+  job->~Job();
+
+  std::lock_guard<std::mutex> lock(m_jobPoolMutex);
+  m_jobPool.Deallocate(job);
+}
+
+void JobSystem::AddContinuation(const JobHandle& job, JobHandle continuation) {
+  {
+    std::lock_guard<std::mutex> lock(job->continuationsMutex);
+    if (!job->finished.load()) {
+      Job* pending = continuation.Detach();
+      pending->nextContinuation = job->continuations;
+      job->continuations = pending;
+      return;
+    }
+  }
+
+  Run(std::move(continuation));
+}
+
+void JobSystem::Run(JobHandle job) {
+  const std::size_t index = GetQueueIndex();
+  WorkQueue& queue =
+      index != ExternalQueueIndex ? *m_queues[index] : m_externalQueue;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.PushBack(job.Detach());
+  }
+
+  m_pendingJobs.fetch_add(1);
+
+  // Taking the mutex orders the increment with a worker checking the
+  // predicate, so the notification cannot be lost.
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+  }
+  m_wakeCondition.notify_one();
+}
+
+void JobSystem::Wait(const JobHandle& job) {
+  const std::size_t index = GetQueueIndex();
+
+  while (!job->finished.load()) {
+    if (JobHandle next = FetchJob(index)) {
+      Execute(next);
+      continue;
+    }
+
+    // The remaining work runs on other threads; sleep until it finishes or
+    // a new job can be helped with. Finish() reads the counter after setting
+    // the flag, so one of the two sides sees the other.
+    m_waitingThreads.fetch_add(1);
+    {
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wakeCondition.wait(lock, [this, &job]() {
+        return job->finished.load() || m_pendingJobs.load() > 0;
+      });
+    }
+    m_waitingThreads.fetch_sub(1);
+  }
+}
+
+void JobSystem::WorkerLoop(std::size_t index) {
+  tlsJobSystem = this;
+  tlsQueueIndex = index;
+
+  while (!m_stopping.load()) {
+    if (JobHandle job = FetchJob(index)) {
+      Execute(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wakeCondition.wait(lock, [this]() {
+      return m_pendingJobs.load() > 0 || m_stopping.load();
+    });
+  }
+}
+
+JobSystem::JobHandle JobSystem::FetchJob(std::size_t index) {
+  Job* job = nullptr;
+  const bool isWorker = index != ExternalQueueIndex;
+
+  if (isWorker) {
+    WorkQueue& own = *m_queues[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    job = own.PopBack();
+  }
+
+  if (job == nullptr) {
+    std::lock_guard<std::mutex> lock(m_externalQueue.mutex);
+    job = m_externalQueue.PopFront();
+  }
+
+  // Workers start stealing from their neighbour, other threads from worker 0.
+  const std::size_t first = isWorker ? index + 1 : 0;
+  const std::size_t victimCount = m_queues.size() - (isWorker ? 1 : 0);
+  for (std::size_t i = 0; job == nullptr && i < victimCount; ++i) {
+    WorkQueue& victim = *m_queues[(first + i) % m_queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    job = victim.PopFront();
+  }
+
+  if (job != nullptr) {
+    m_pendingJobs.fetch_sub(1);
+  }
+
+  return JobHandle::Adopt(job);
+}
+
+void JobSystem::Execute(const JobHandle& job) {
+  if (job->run != nullptr) {
+    job->run(job->task);
+  }
+
+  Finish(job);
+}
+
+void JobSystem::Finish(const JobHandle& job) {
+  if (job->unfinished.fetch_sub(1) != 1) {
+    return;
+  }
+
+  Job* continuations = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(job->continuationsMutex);
+    job->finished = true;
+    continuations = std::exchange(job->continuations, nullptr);
+  }
+
+  if (m_waitingThreads.load() > 0) {
+    {
+      std::lock_guard<std::mutex> lock(m_wakeMutex);
+    }
+    m_wakeCondition.notify_all();
+  }
+
+  while (continuations != nullptr) {
+    JobHandle continuation = JobHandle::Adopt(continuations);
+    continuations = std::exchange(continuation->nextContinuation, nullptr);
+    Run(std::move(continuation));
+  }
+
+  if (job->parent != nullptr) {
+    JobHandle parent = std::move(job->parent);
+    Finish(parent);
+  }
+}
+
+std::size_t JobSystem::GetQueueIndex() const {
+  return tlsJobSystem == this ? tlsQueueIndex : ExternalQueueIndex;
+}
+
+void JobSystem::WorkQueue::PushBack(Job* job) {
+  // Full: unroll the ring into a buffer twice as large.
+  if (count == jobs.size()) {
+    std::vector<Job*> grown(jobs.size() * 2);
+    for (std::size_t i = 0; i < count; ++i) {
+      grown[i] = jobs[(head + i) % jobs.size()];
+    }
+    jobs.swap(grown);
+    head = 0;
+  }
+
+  jobs[(head + count) % jobs.size()] = job;
+  ++count;
+}
+
+JobSystem::Job* JobSystem::WorkQueue::PopBack() {
+  if (count == 0) {
+    return nullptr;
+  }
+
+  --count;
+  return jobs[(head + count) % jobs.size()];
+}
+
+JobSystem::Job* JobSystem::WorkQueue::PopFront() {
+  if (count == 0) {
+    return nullptr;
+  }
+
+  Job* job = jobs[head];
+  head = (head + 1) % jobs.size();
+  --count;
+  return job;
+}
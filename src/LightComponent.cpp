@@ -2,20 +2,18 @@
 
 #include "GameObject.h"
 
-LightComponent::LightComponent(const std::shared_ptr<GameObject>& owner)
+LightComponent::LightComponent(GameObject* owner)
     : Component(owner),
       m_color(1.0f, 1.0f, 1.0f),
       m_intensity(1.0f),
       m_range(10.0f) {}
 
-void LightComponent::Update(float deltaTime) {
+void LightComponent::Update(float /*deltaTime*/) {
   // Sync light's position and direction with the owner's transform
-  if (auto owner = m_owner.lock()) {
-    auto* transform = owner->GetComponent<TransformComponent>();
+  auto* transform = m_owner->GetComponent<TransformComponent>();
 
-    if (transform != nullptr) {
-      m_position = transform->GetPosition();
-      m_direction = transform->GetForward();
-    }
+  if (transform != nullptr) {
+    m_position = transform->GetWorldPosition();
+    m_direction = transform->GetForward();
   }
 }
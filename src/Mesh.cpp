@@ -1,25 +1,37 @@
 #include "Mesh.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+
+#include "core/MeshSimplifier.h"
+
+namespace {
+
+/**Deviation allowed for generated levels of detail, as a fraction of the
+ * mesh's bounding box diagonal. */
+constexpr float LodMaxError = 0.02f;
+
+/**Last identifier handed to a mesh. */
+std::atomic<std::uint32_t> lastMeshId{0};
+
+}  // namespace
 
 // #include <iostream> // Unused, can be removed
 
-Mesh::Mesh() : m_VAO(0), m_VBO(0), m_EBO(0) {
+Mesh::Mesh()
+    : m_id(lastMeshId.fetch_add(1, std::memory_order_relaxed) + 1) {
   m_meshType = MeshType::Custom;
 }
 
 Mesh::~Mesh() {
-  // Delete GPU resources
-  glDeleteVertexArrays(1, &m_VAO);
-  glDeleteBuffers(1, &m_VBO);
-  glDeleteBuffers(1, &m_EBO);
+  // The last reference may be dropped on any thread; freeing the ranges makes
+  // no OpenGL call.
+  ReleaseBuffers();
 }
 
 Mesh::Mesh(MeshType type)
-    : m_VAO(0),
-      m_VBO(0),
-      m_EBO(0)  // Delegating constructor
-{
+    : m_id(lastMeshId.fetch_add(1, std::memory_order_relaxed) + 1) {
   if (type == MeshType::Cube) {
     CreateCube();
     m_meshType = MeshType::Cube;
@@ -77,34 +89,10 @@ void Mesh::CreateCube() {
 		20, 21, 22, 22, 23, 20
 	};
 
-  // Setup VAO, VBO, and EBO for the cube
-  glGenVertexArrays(1, &m_VAO);
-  glGenBuffers(1, &m_VBO);
-  glGenBuffers(1, &m_EBO);
-
-  glBindVertexArray(m_VAO);
-
-  // Vertex buffer setup
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(float),
-               m_vertices.data(), GL_STATIC_DRAW);
-
-  // Index buffer setup
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
-               m_indices.data(), GL_STATIC_DRAW);
-
-  // Position attribute
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  // Normal attribute
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-                        (void*)(3 * sizeof(float)));
-  glEnableVertexAttribArray(1);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  m_vertexStride = 6;
+  m_lods.clear();
+  AddLod(0);
+  ComputeBounds();
 }
 
 void Mesh::CreatePlane() {
@@ -123,44 +111,40 @@ void Mesh::CreatePlane() {
       2, 3, 0   // Second triangle
   };
 
-  // Setup VAO, VBO, and EBO for the plane
-  glGenVertexArrays(1, &m_VAO);
-  glGenBuffers(1, &m_VBO);
-  glGenBuffers(1, &m_EBO);
-
-  glBindVertexArray(m_VAO);
-
-  // Vertex buffer setup
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(float),
-               m_vertices.data(), GL_STATIC_DRAW);
-
-  // Index buffer setup
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
-               m_indices.data(), GL_STATIC_DRAW);
-
-  // Position attribute
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  // Normal attribute
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
-                        (void*)(3 * sizeof(float)));
-  glEnableVertexAttribArray(1);
-
-  // Texture coordinate attribute
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
-                        (void*)(6 * sizeof(float)));
-  glEnableVertexAttribArray(2);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  m_vertexStride = 8;
+  m_lods.clear();
+  AddLod(0);
+  ComputeBounds();
 }
 
 void Mesh::CreateCapsule(float radius, float height, int segments, int rings) {
+  m_meshType = MeshType::Capsule;
   m_vertices.clear();
   m_indices.clear();
+  m_lods.clear();
+  m_vertexStride = 6;
+
+  // Coarser levels halve both subdivisions; rings stay even so the two
+  // hemispheres keep the same number of rings.
+  while (true) {
+    const std::size_t firstIndex = m_indices.size();
+    AppendCapsule(radius, height, segments, rings);
+    AddLod(firstIndex);
+
+    if (m_lods.size() == MaxLodCount || segments / 2 < 8 || rings / 2 < 4) {
+      break;
+    }
+
+    segments /= 2;
+    rings = rings / 4 * 2;
+  }
+
+  ComputeBounds();
+}
+
+void Mesh::AppendCapsule(float radius, float height, int segments,
+                         int rings) {
+  const int baseVertex = static_cast<int>(m_vertices.size() / 6);
 
   constexpr float PI = 3.14159265359f;
   const int verticalSegments = segments;
@@ -238,13 +222,13 @@ void Mesh::CreateCapsule(float radius, float height, int segments, int rings) {
       int current = ring * (verticalSegments + 1) + segment;
       int next = current + (verticalSegments + 1);
 
-      m_indices.push_back(topOffset + current);
-      m_indices.push_back(topOffset + next);
-      m_indices.push_back(topOffset + current + 1);
+      m_indices.push_back(baseVertex + topOffset + current);
+      m_indices.push_back(baseVertex + topOffset + next);
+      m_indices.push_back(baseVertex + topOffset + current + 1);
 
-      m_indices.push_back(topOffset + current + 1);
-      m_indices.push_back(topOffset + next);
-      m_indices.push_back(topOffset + next + 1);
+      m_indices.push_back(baseVertex + topOffset + current + 1);
+      m_indices.push_back(baseVertex + topOffset + next);
+      m_indices.push_back(baseVertex + topOffset + next + 1);
     }
   }
 
@@ -253,13 +237,13 @@ void Mesh::CreateCapsule(float radius, float height, int segments, int rings) {
     int current = segment;
     int next = current + (verticalSegments + 1);
 
-    m_indices.push_back(cylinderOffset + current);
-    m_indices.push_back(cylinderOffset + next);
-    m_indices.push_back(cylinderOffset + current + 1);
+    m_indices.push_back(baseVertex + cylinderOffset + current);
+    m_indices.push_back(baseVertex + cylinderOffset + next);
+    m_indices.push_back(baseVertex + cylinderOffset + current + 1);
 
-    m_indices.push_back(cylinderOffset + current + 1);
-    m_indices.push_back(cylinderOffset + next);
-    m_indices.push_back(cylinderOffset + next + 1);
+    m_indices.push_back(baseVertex + cylinderOffset + current + 1);
+    m_indices.push_back(baseVertex + cylinderOffset + next);
+    m_indices.push_back(baseVertex + cylinderOffset + next + 1);
   }
 
   int bottomOffset = cylinderOffset + 2 * (verticalSegments + 1);
@@ -268,68 +252,152 @@ void Mesh::CreateCapsule(float radius, float height, int segments, int rings) {
       int current = ring * (verticalSegments + 1) + segment;
       int next = current + (verticalSegments + 1);
 
-      m_indices.push_back(bottomOffset + current);
-      m_indices.push_back(bottomOffset + next);
-      m_indices.push_back(bottomOffset + current + 1);
+      m_indices.push_back(baseVertex + bottomOffset + current);
+      m_indices.push_back(baseVertex + bottomOffset + next);
+      m_indices.push_back(baseVertex + bottomOffset + current + 1);
 
-      m_indices.push_back(bottomOffset + current + 1);
-      m_indices.push_back(bottomOffset + next);
-      m_indices.push_back(bottomOffset + next + 1);
+      m_indices.push_back(baseVertex + bottomOffset + current + 1);
+      m_indices.push_back(baseVertex + bottomOffset + next);
+      m_indices.push_back(baseVertex + bottomOffset + next + 1);
     }
   }
 
-  glGenVertexArrays(1, &m_VAO);
-  glGenBuffers(1, &m_VBO);
-  glGenBuffers(1, &m_EBO);
+}
 
-  glBindVertexArray(m_VAO);
+void Mesh::SetGeometry(std::vector<float> vertices,
+                       std::vector<unsigned int> indices, int stride) {
+  ReleaseBuffers();
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(float),
-               m_vertices.data(), GL_STATIC_DRAW);
+  m_vertices = std::move(vertices);
+  m_indices = std::move(indices);
+  m_vertexStride = stride;
+  m_meshType = MeshType::Custom;
+  m_lods.clear();
+  AddLod(0);
+  ComputeBounds();
+
+  while (m_lods.size() < MaxLodCount) {
+    const MeshLod previous = m_lods.back();
+    const std::size_t target = previous.indexCount / 6 * 3;
+    std::vector<unsigned int> simplified =
+        SimplifyMesh(m_vertices, m_vertexStride,
+                     GetLodIndices(m_lods.size() - 1), target, LodMaxError);
+
+    // A level saving less than a quarter of the triangles is not worth it.
+    if (simplified.empty() ||
+        simplified.size() * 4 > std::size_t{previous.indexCount} * 3) {
+      break;
+    }
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
-               m_indices.data(), GL_STATIC_DRAW);
+    const std::size_t firstIndex = m_indices.size();
+    m_indices.insert(m_indices.end(), simplified.begin(), simplified.end());
+    AddLod(firstIndex);
+  }
+}
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
+bool Mesh::GetDrawCommand(std::size_t lod, std::uint32_t instanceCount,
+                          DrawElementsIndirectCommand& command) const {
+  if (!IsUploaded()) {
+    Upload();
+  }
+
+  if (m_lods.empty() || !m_allocation.IsValid()) {
+    return false;
+  }
+
+  // LOD ranges index the mesh's own indices, which start at firstIndex.
+  const MeshLod& range = m_lods[std::min(lod, m_lods.size() - 1)];
+  command.count = range.indexCount;
+  command.instanceCount = instanceCount;
+  command.firstIndex = m_allocation.firstIndex + range.firstIndex;
+  command.baseVertex = m_allocation.baseVertex;
+  command.baseInstance = 0;
+  return true;
+}
+
+void Mesh::Clear() {
+  ReleaseBuffers();
 
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-                        (void*)(3 * sizeof(float)));
-  glEnableVertexAttribArray(1);
+  // Clear vertex and index data
+  m_vertices.clear();
+  m_indices.clear();
+  m_lods.clear();
+  m_vertexCount = 0;
+  m_bounds = Aabb();
+  m_boundingSphere = Sphere();
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+bool Mesh::ReleaseCpuData() {
+  if (!IsUploaded()) {
+    return false;
+  }
+
+  // Swapping with empty vectors frees the storage, clear() would keep it.
+  std::vector<float>().swap(m_vertices);
+  std::vector<unsigned int>().swap(m_indices);
+  return true;
 }
 
-void Mesh::Draw() {
-  // Bind VAO and draw the mesh
-  glBindVertexArray(m_VAO);
-  glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+std::size_t Mesh::GetCpuMemoryUsage() const {
+  return m_vertices.capacity() * sizeof(float) +
+         m_indices.capacity() * sizeof(unsigned int) +
+         m_lods.capacity() * sizeof(MeshLod);
 }
 
-void Mesh::Clear() {
-  // Delete VAO, VBO, and EBO from GPU
-  if (m_VAO) {
-    glDeleteVertexArrays(1, &m_VAO);
-    m_VAO = 0;
+std::size_t Mesh::GetGpuMemoryUsage() const {
+  if (!IsUploaded()) {
+    return 0;
   }
 
-  if (m_VBO) {
-    glDeleteBuffers(1, &m_VBO);
-    m_VBO = 0;
+  // Written before m_uploaded was set, so reading it here is safe.
+  return std::size_t{m_allocation.vertexCount} * MeshBuffer::VertexStride *
+             sizeof(float) +
+         std::size_t{m_allocation.indexCount} * sizeof(unsigned int);
+}
+
+void Mesh::Upload() const {
+  m_allocation = MeshBuffer::Allocate(m_vertices, m_vertexStride, m_indices);
+
+  // Publishes the upload to threads that may release the CPU copy.
+  m_uploaded.store(true, std::memory_order_release);
+}
+
+void Mesh::AddLod(std::size_t firstIndex) {
+  m_lods.push_back({static_cast<unsigned int>(firstIndex),
+                    static_cast<unsigned int>(m_indices.size() - firstIndex)});
+}
+
+void Mesh::ComputeBounds() {
+  m_bounds = Aabb();
+  m_boundingSphere = Sphere();
+  m_vertexCount = m_vertices.size() / m_vertexStride;
+
+  for (std::size_t i = 0; i + 2 < m_vertices.size(); i += m_vertexStride) {
+    m_bounds.Expand(glm::vec3(m_vertices[i], m_vertices[i + 1],
+                              m_vertices[i + 2]));
   }
 
-  if (m_EBO) {
-    glDeleteBuffers(1, &m_EBO);
-    m_EBO = 0;
+  if (m_bounds.IsEmpty()) {
+    return;
   }
 
-  // Clear vertex and index data
-  m_vertices.clear();
-  m_indices.clear();
+  // Tighter than the box's circumscribed sphere for round meshes such as
+  // the capsule.
+  m_boundingSphere.center = m_bounds.GetCenter();
+  float radiusSquared = 0.0f;
+  for (std::size_t i = 0; i + 2 < m_vertices.size(); i += m_vertexStride) {
+    glm::vec3 offset = glm::vec3(m_vertices[i], m_vertices[i + 1],
+                                 m_vertices[i + 2]) -
+                       m_boundingSphere.center;
+    radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+  }
+  m_boundingSphere.radius = std::sqrt(radiusSquared);
+}
+
+void Mesh::ReleaseBuffers() {
+  m_uploaded.store(false, std::memory_order_release);
+  MeshBuffer::Free(m_allocation);
+  m_allocation = MeshAllocation();
 }
 
 MeshType Mesh::GetType() const {
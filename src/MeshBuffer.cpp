@@ -0,0 +1,193 @@
+#include "core/MeshBuffer.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "core/RangeAllocator.h"
+
+namespace {
+
+constexpr std::size_t VertexBytes = MeshBuffer::VertexStride * sizeof(float);
+constexpr std::size_t IndexBytes = sizeof(unsigned int);
+constexpr std::uint32_t InitialVertexCapacity = 1 << 16;
+constexpr std::uint32_t InitialIndexCapacity = 1 << 18;
+/**Vertex buffer binding points of the vertex array. */
+constexpr GLuint VertexBinding = 0;
+constexpr GLuint InstanceIndexBinding = 1;
+
+std::mutex bufferMutex;
+RangeAllocator vertexRanges;
+RangeAllocator indexRanges;
+GLuint vertexArray = 0;
+GLuint vertexBuffer = 0;
+GLuint indexBuffer = 0;
+/**Vertices converted to the shared format, reused between uploads. */
+std::vector<float> convertedVertices;
+
+/** Replaces `buffer` with one of `capacity` elements, keeping its content. */
+void Reallocate(GLuint& buffer, std::size_t elementBytes,
+                std::uint32_t oldCapacity, std::uint32_t capacity) {
+  GLuint grown = 0;
+  glCreateBuffers(1, &grown);
+  glNamedBufferStorage(grown,
+                       static_cast<GLsizeiptr>(capacity * elementBytes),
+                       nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+  if (buffer != 0) {
+    glCopyNamedBufferSubData(
+        buffer, grown, 0, 0,
+        static_cast<GLsizeiptr>(oldCapacity * elementBytes));
+    glDeleteBuffers(1, &buffer);
+  }
+
+  buffer = grown;
+}
+
+/** Allocates `size` elements, doubling the buffer until they fit. */
+std::uint32_t AllocateRange(RangeAllocator& ranges, GLuint& buffer,
+                            std::size_t elementBytes,
+                            std::uint32_t initialCapacity,
+                            std::uint32_t size) {
+  std::uint32_t offset = ranges.Allocate(size);
+
+  while (offset == RangeAllocator::NoRange) {
+    const std::uint32_t oldCapacity = ranges.GetCapacity();
+    const std::uint32_t capacity =
+        std::max({initialCapacity, oldCapacity * 2, oldCapacity + size});
+    Reallocate(buffer, elementBytes, oldCapacity, capacity);
+    ranges.Grow(capacity);
+    offset = ranges.Allocate(size);
+  }
+
+  return offset;
+}
+
+/** Creates the vertex array, then points it at the current buffers. */
+void BindBuffers() {
+  if (vertexArray == 0) {
+    glCreateVertexArrays(1, &vertexArray);
+
+    // Position, normal and texture coordinates, all read from one binding.
+    const GLint sizes[] = {3, 3, 2};
+    GLuint offset = 0;
+    for (GLuint location = 0; location < 3; ++location) {
+      glVertexArrayAttribFormat(vertexArray, location, sizes[location],
+                                GL_FLOAT, GL_FALSE, offset * sizeof(float));
+      glVertexArrayAttribBinding(vertexArray, location, VertexBinding);
+      glEnableVertexArrayAttrib(vertexArray, location);
+      offset += sizes[location];
+    }
+
+    // The instance index advances once per instance, from baseInstance.
+    const GLuint location = MeshBuffer::InstanceIndexLocation;
+    glVertexArrayAttribIFormat(vertexArray, location, 1, GL_UNSIGNED_INT, 0);
+    glVertexArrayAttribBinding(vertexArray, location, InstanceIndexBinding);
+    glVertexArrayBindingDivisor(vertexArray, InstanceIndexBinding, 1);
+    glEnableVertexArrayAttrib(vertexArray, location);
+  }
+
+  glVertexArrayVertexBuffer(vertexArray, VertexBinding, vertexBuffer, 0,
+                            static_cast<GLsizei>(VertexBytes));
+  glVertexArrayElementBuffer(vertexArray, indexBuffer);
+}
+
+}  // namespace
+
+MeshAllocation MeshBuffer::Allocate(Span<const float> vertices, int stride,
+                                    Span<const unsigned int> indices) {
+  const auto vertexCount = static_cast<std::uint32_t>(vertices.size() / stride);
+  const auto indexCount = static_cast<std::uint32_t>(indices.size());
+
+  if (vertexCount == 0 || indexCount == 0) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(bufferMutex);
+  const GLuint oldVertexBuffer = vertexBuffer;
+  const GLuint oldIndexBuffer = indexBuffer;
+
+  MeshAllocation allocation;
+  allocation.vertexCount = vertexCount;
+  allocation.indexCount = indexCount;
+  allocation.baseVertex = static_cast<GLint>(
+      AllocateRange(vertexRanges, vertexBuffer, VertexBytes,
+                    InitialVertexCapacity, vertexCount));
+  allocation.firstIndex = AllocateRange(indexRanges, indexBuffer, IndexBytes,
+                                        InitialIndexCapacity, indexCount);
+
+  if (vertexArray == 0 || vertexBuffer != oldVertexBuffer ||
+      indexBuffer != oldIndexBuffer) {
+    BindBuffers();
+  }
+
+  const float* data = vertices.data();
+  if (stride != VertexStride) {
+    // Pad or trim every vertex to the shared format.
+    convertedVertices.assign(std::size_t{vertexCount} * VertexStride, 0.0f);
+    const int copied = std::min(stride, VertexStride);
+    for (std::uint32_t i = 0; i < vertexCount; ++i) {
+      std::copy_n(data + std::size_t{i} * stride, copied,
+                  convertedVertices.data() + std::size_t{i} * VertexStride);
+    }
+    data = convertedVertices.data();
+  }
+
+  glNamedBufferSubData(
+      vertexBuffer,
+      static_cast<GLintptr>(allocation.baseVertex * VertexBytes),
+      static_cast<GLsizeiptr>(vertexCount * VertexBytes), data);
+  glNamedBufferSubData(
+      indexBuffer, static_cast<GLintptr>(allocation.firstIndex * IndexBytes),
+      static_cast<GLsizeiptr>(indexCount * IndexBytes), indices.data());
+
+  return allocation;
+}
+
+void MeshBuffer::Free(const MeshAllocation& allocation) {
+  if (!allocation.IsValid()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(bufferMutex);
+  vertexRanges.Free(static_cast<std::uint32_t>(allocation.baseVertex),
+                    allocation.vertexCount);
+  indexRanges.Free(allocation.firstIndex, allocation.indexCount);
+}
+
+GLuint MeshBuffer::GetVertexArray() {
+  std::lock_guard<std::mutex> lock(bufferMutex);
+
+  if (vertexArray == 0) {
+    BindBuffers();
+  }
+
+  return vertexArray;
+}
+
+void MeshBuffer::BindInstanceIndices(GLuint buffer, GLintptr offset) {
+  glVertexArrayVertexBuffer(GetVertexArray(), InstanceIndexBinding, buffer,
+                            offset, sizeof(GLuint));
+}
+
+std::size_t MeshBuffer::GetUsedBytes() {
+  std::lock_guard<std::mutex> lock(bufferMutex);
+  return vertexRanges.GetUsed() * VertexBytes +
+         indexRanges.GetUsed() * IndexBytes;
+}
+
+std::size_t MeshBuffer::GetCapacityBytes() {
+  std::lock_guard<std::mutex> lock(bufferMutex);
+  return vertexRanges.GetCapacity() * VertexBytes +
+         indexRanges.GetCapacity() * IndexBytes;
+}
+
+void MeshBuffer::Shutdown() {
+  std::lock_guard<std::mutex> lock(bufferMutex);
+  glDeleteVertexArrays(1, &vertexArray);
+  glDeleteBuffers(1, &vertexBuffer);
+  glDeleteBuffers(1, &indexBuffer);
+  vertexArray = 0;
+  vertexBuffer = 0;
+  indexBuffer = 0;
+}
@@ -1,17 +1,32 @@
 #include "MeshComponent.h"
 
-void MeshComponent::SetMesh(const std::shared_ptr<Mesh>& mesh) {
+#include "GameObject.h"
+#include "TransformComponent.h"
+
+void MeshComponent::SetMesh(const std::shared_ptr<const Mesh>& mesh) {
   m_mesh = mesh;
+  MarkBoundsDirty();
 }
 
 void MeshComponent::ClearMesh() {
-  m_mesh->Clear();
+  m_mesh = nullptr;
+  MarkBoundsDirty();
+}
+
+void MeshComponent::MarkBoundsDirty() {
+  if (m_owner == nullptr) {
+    return;
+  }
+
+  if (auto* transform = m_owner->GetComponent<TransformComponent>()) {
+    transform->MarkBoundsDirty();
+  }
 }
 
-std::shared_ptr<Mesh> MeshComponent::GetMesh() {
+std::shared_ptr<const Mesh> MeshComponent::GetMesh() {
   return m_mesh;
 }
 
 MeshType MeshComponent::GetMeshType() const {
-  return m_mesh->GetType();
+  return m_mesh != nullptr ? m_mesh->GetType() : MeshType::Custom;
 }
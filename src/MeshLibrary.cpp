@@ -0,0 +1,124 @@
+#include "MeshLibrary.h"
+
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+/**
+ * @struct LibraryEntry
+ * @brief A mesh of the library and how its CPU copy is treated.
+ */
+struct LibraryEntry {
+  std::shared_ptr<Mesh> mesh;
+  /**Whether ReleaseUploadedCpuData() leaves the CPU copy alone. */
+  bool keepCpuData{true};
+};
+
+std::mutex libraryMutex;
+// Ordered, so statistics come out sorted by key.
+std::map<std::string, LibraryEntry> entries;
+
+/** Returns the mesh of `key`, building it with `build` if it is missing. */
+template <typename Build>
+std::shared_ptr<const Mesh> GetOrBuild(const std::string& key,
+                                       bool keepCpuData, Build&& build) {
+  {
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+      return it->second.mesh;
+    }
+  }
+
+  // Built unlocked, since simplifying an asset can take a while. Should two
+  // threads race on the same key, the first mesh inserted wins.
+  std::shared_ptr<Mesh> mesh = build();
+
+  std::lock_guard<std::mutex> lock(libraryMutex);
+  auto it = entries.try_emplace(key, LibraryEntry{mesh, keepCpuData}).first;
+  return it->second.mesh;
+}
+
+}  // namespace
+
+std::shared_ptr<const Mesh> MeshLibrary::Get(MeshType type) {
+  if (type == MeshType::Custom || type == MeshType::Count) {
+    return nullptr;
+  }
+
+  const std::string key(MeshTypeNames[static_cast<int>(type)]);
+  return GetOrBuild(key, true, [type] { return std::make_shared<Mesh>(type); });
+}
+
+std::shared_ptr<const Mesh> MeshLibrary::GetCapsule(float radius, float height,
+                                                    int segments, int rings) {
+  std::ostringstream key;
+  key << "Capsule(" << radius << ", " << height << ", " << segments << ", "
+      << rings << ")";
+
+  return GetOrBuild(key.str(), true, [=] {
+    auto mesh = std::make_shared<Mesh>();
+    mesh->CreateCapsule(radius, height, segments, rings);
+    return mesh;
+  });
+}
+
+std::shared_ptr<const Mesh> MeshLibrary::Get(const std::string& path,
+                                             const Builder& build) {
+  return GetOrBuild(path, false, [&build] {
+    auto mesh = std::make_shared<Mesh>();
+    build(*mesh);
+    return mesh;
+  });
+}
+
+std::shared_ptr<const Mesh> MeshLibrary::Find(const std::string& key) {
+  std::lock_guard<std::mutex> lock(libraryMutex);
+  auto it = entries.find(key);
+  return it != entries.end() ? it->second.mesh : nullptr;
+}
+
+void MeshLibrary::ReleaseUploadedCpuData() {
+  std::lock_guard<std::mutex> lock(libraryMutex);
+  for (auto& [key, entry] : entries) {
+    if (!entry.keepCpuData && entry.mesh->HasCpuData()) {
+      entry.mesh->ReleaseCpuData();
+    }
+  }
+}
+
+std::size_t MeshLibrary::ReleaseUnused() {
+  std::lock_guard<std::mutex> lock(libraryMutex);
+  std::size_t released = 0;
+
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->second.mesh.use_count() == 1) {
+      it = entries.erase(it);
+      ++released;
+    } else {
+      ++it;
+    }
+  }
+
+  return released;
+}
+
+void MeshLibrary::GetStats(std::vector<MeshStats>& stats) {
+  std::lock_guard<std::mutex> lock(libraryMutex);
+  stats.clear();
+  stats.reserve(entries.size());
+
+  for (const auto& [key, entry] : entries) {
+    const Mesh& mesh = *entry.mesh;
+    stats.push_back({&key, entry.mesh.use_count() - 1, mesh.GetVertexCount(),
+                     mesh.GetIndexCount(), mesh.GetCpuMemoryUsage(),
+                     mesh.GetGpuMemoryUsage()});
+  }
+}
+
+void MeshLibrary::Clear() {
+  std::lock_guard<std::mutex> lock(libraryMutex);
+  entries.clear();
+}
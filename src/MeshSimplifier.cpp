@@ -0,0 +1,307 @@
+#include "core/MeshSimplifier.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "core/Bounds.h"
+
+namespace {
+
+/**
+ * @struct Quadric
+ * @brief Symmetric 4x4 matrix summing squared distances to planes.
+ */
+struct Quadric {
+  double a2{0}, ab{0}, ac{0}, ad{0};
+  double b2{0}, bc{0}, bd{0};
+  double c2{0}, cd{0};
+  double d2{0};
+
+  void AddPlane(const glm::vec3& normal, float distance) {
+    const double a = normal.x;
+    const double b = normal.y;
+    const double c = normal.z;
+    const double d = distance;
+    a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+    b2 += b * b; bc += b * c; bd += b * d;
+    c2 += c * c; cd += c * d;
+    d2 += d * d;
+  }
+
+  Quadric& operator+=(const Quadric& other) {
+    a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+    b2 += other.b2; bc += other.bc; bd += other.bd;
+    c2 += other.c2; cd += other.cd;
+    d2 += other.d2;
+    return *this;
+  }
+
+  /** Sum of the squared distances from `p` to the planes. */
+  [[nodiscard]] double Error(const glm::vec3& p) const {
+    const double x = p.x;
+    const double y = p.y;
+    const double z = p.z;
+    return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+           b2 * y * y + 2 * bc * y * z + 2 * bd * y + c2 * z * z +
+           2 * cd * z + d2;
+  }
+};
+
+/**
+ * @struct Collapse
+ * @brief Candidate move of vertex `from` onto vertex `to`.
+ */
+struct Collapse {
+  double cost;
+  std::uint32_t from;
+  std::uint32_t to;
+
+  bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+struct PositionHash {
+  std::size_t operator()(const glm::vec3& p) const {
+    std::uint32_t bits[3];
+    std::memcpy(bits, &p, sizeof(bits));
+    return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^
+           (bits[2] * 83492791u);
+  }
+};
+
+}  // namespace
+
+std::vector<unsigned int> SimplifyMesh(const std::vector<float>& vertices,
+                                       int stride,
+                                       Span<const unsigned int> indices,
+                                       std::size_t targetIndexCount,
+                                       float maxError) {
+  const std::size_t vertexCount = vertices.size() / stride;
+  auto positionOf = [&vertices, stride](std::uint32_t vertex) {
+    const float* p = &vertices[static_cast<std::size_t>(vertex) * stride];
+    return glm::vec3(p[0], p[1], p[2]);
+  };
+
+  // Weld vertices by position; topology is built on the first copy of each.
+  std::vector<std::uint32_t> welded(vertexCount);
+  std::unordered_map<glm::vec3, std::uint32_t, PositionHash> firstCopy;
+  Aabb bounds;
+  for (std::uint32_t v = 0; v < vertexCount; ++v) {
+    const glm::vec3 position = positionOf(v);
+    welded[v] = firstCopy.try_emplace(position, v).first->second;
+    bounds.Expand(position);
+  }
+
+  // Remaining triangles, as corners of the original index buffer.
+  std::vector<std::array<std::uint32_t, 3>> triangles;
+  triangles.reserve(indices.size() / 3);
+  std::vector<Quadric> quadrics(vertexCount);
+  std::unordered_map<std::uint64_t, int> edgeUses;
+
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const std::array<std::uint32_t, 3> corners = {indices[i], indices[i + 1],
+                                                  indices[i + 2]};
+    const std::uint32_t w0 = welded[corners[0]];
+    const std::uint32_t w1 = welded[corners[1]];
+    const std::uint32_t w2 = welded[corners[2]];
+
+    if (w0 == w1 || w1 == w2 || w2 == w0) {
+      continue;
+    }
+
+    const glm::vec3 p0 = positionOf(w0);
+    glm::vec3 normal = glm::cross(positionOf(w1) - p0, positionOf(w2) - p0);
+    const float length = glm::length(normal);
+    if (length == 0.0f) {
+      continue;
+    }
+    normal = normal * (1.0f / length);
+
+    Quadric plane;
+    plane.AddPlane(normal, -glm::dot(normal, p0));
+    quadrics[w0] += plane;
+    quadrics[w1] += plane;
+    quadrics[w2] += plane;
+
+    for (int edge = 0; edge < 3; ++edge) {
+      std::uint32_t a = welded[corners[edge]];
+      std::uint32_t b = welded[corners[(edge + 1) % 3]];
+      if (a > b) {
+        std::swap(a, b);
+      }
+      ++edgeUses[(static_cast<std::uint64_t>(a) << 32) | b];
+    }
+
+    triangles.push_back(corners);
+  }
+
+  // Vertices on an open border would pull the outline inwards; keep them.
+  std::vector<bool> locked(vertexCount, false);
+  for (const auto& [edge, uses] : edgeUses) {
+    if (uses == 1) {
+      locked[edge >> 32] = true;
+      locked[edge & 0xFFFFFFFFu] = true;
+    }
+  }
+
+  // Collapsed vertices point to the vertex they were merged into.
+  std::vector<std::uint32_t> mergedInto(vertexCount);
+  for (std::uint32_t v = 0; v < vertexCount; ++v) {
+    mergedInto[v] = v;
+  }
+  auto find = [&mergedInto](std::uint32_t v) {
+    while (mergedInto[v] != v) {
+      mergedInto[v] = mergedInto[mergedInto[v]];
+      v = mergedInto[v];
+    }
+    return v;
+  };
+  auto cornerOf = [&](std::uint32_t triangle, int corner) {
+    return find(welded[triangles[triangle][corner]]);
+  };
+
+  std::vector<std::vector<std::uint32_t>> adjacency(vertexCount);
+  std::vector<bool> alive(triangles.size(), true);
+  std::size_t aliveCount = triangles.size();
+
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> heap;
+  auto costOf = [&](std::uint32_t from, std::uint32_t to) {
+    Quadric combined = quadrics[from];
+    combined += quadrics[to];
+    return combined.Error(positionOf(to));
+  };
+  auto pushEdges = [&](std::uint32_t triangle) {
+    for (int edge = 0; edge < 3; ++edge) {
+      const std::uint32_t a = cornerOf(triangle, edge);
+      const std::uint32_t b = cornerOf(triangle, (edge + 1) % 3);
+      if (!locked[a]) {
+        heap.push({costOf(a, b), a, b});
+      }
+      if (!locked[b]) {
+        heap.push({costOf(b, a), b, a});
+      }
+    }
+  };
+
+  for (std::uint32_t t = 0; t < triangles.size(); ++t) {
+    for (int corner = 0; corner < 3; ++corner) {
+      adjacency[cornerOf(t, corner)].push_back(t);
+    }
+    pushEdges(t);
+  }
+
+  const glm::vec3 diagonal = bounds.IsEmpty() ? glm::vec3(0.0f)
+                                              : bounds.max - bounds.min;
+  const double errorLimit =
+      static_cast<double>(maxError) * maxError * glm::dot(diagonal, diagonal);
+
+  while (aliveCount * 3 > targetIndexCount && !heap.empty()) {
+    const Collapse collapse = heap.top();
+    heap.pop();
+
+    const std::uint32_t from = collapse.from;
+    const std::uint32_t to = collapse.to;
+    if (find(from) != from || find(to) != to || from == to) {
+      continue;
+    }
+
+    // Quadrics only grow, so a stale entry is requeued with its real cost.
+    const double cost = costOf(from, to);
+    if (cost > collapse.cost * (1.0 + 1e-6) + 1e-12) {
+      heap.push({cost, from, to});
+      continue;
+    }
+
+    if (cost > errorLimit) {
+      break;
+    }
+
+    // The collapse is valid only if the edge still exists and no triangle
+    // around `from` turns over, or stands up on its edge: a normal turning
+    // by more than about 75 degrees counts as a flip.
+    bool sharesTriangle = false;
+    bool flips = false;
+    const glm::vec3 target = positionOf(to);
+    for (std::uint32_t t : adjacency[from]) {
+      if (!alive[t]) {
+        continue;
+      }
+
+      glm::vec3 before[3];
+      glm::vec3 after[3];
+      bool hasTo = false;
+      for (int corner = 0; corner < 3; ++corner) {
+        const std::uint32_t v = cornerOf(t, corner);
+        hasTo = hasTo || v == to;
+        before[corner] = positionOf(v);
+        after[corner] = v == from ? target : before[corner];
+      }
+
+      if (hasTo) {
+        sharesTriangle = true;
+        continue;
+      }
+
+      const glm::vec3 oldNormal =
+          glm::cross(before[1] - before[0], before[2] - before[0]);
+      const glm::vec3 newNormal =
+          glm::cross(after[1] - after[0], after[2] - after[0]);
+      if (glm::dot(oldNormal, newNormal) <=
+          0.25f * glm::length(oldNormal) * glm::length(newNormal)) {
+        flips = true;
+        break;
+      }
+    }
+
+    if (!sharesTriangle || flips) {
+      continue;
+    }
+
+    mergedInto[from] = to;
+    quadrics[to] += quadrics[from];
+
+    for (std::uint32_t t : adjacency[from]) {
+      if (!alive[t]) {
+        continue;
+      }
+
+      const std::uint32_t v0 = cornerOf(t, 0);
+      const std::uint32_t v1 = cornerOf(t, 1);
+      const std::uint32_t v2 = cornerOf(t, 2);
+      if (v0 == v1 || v1 == v2 || v2 == v0) {
+        alive[t] = false;
+        --aliveCount;
+      } else {
+        adjacency[to].push_back(t);
+      }
+    }
+    adjacency[from].clear();
+
+    for (std::uint32_t t : adjacency[to]) {
+      if (alive[t]) {
+        pushEdges(t);
+      }
+    }
+  }
+
+  // Corners that did not move keep their own vertex, so seams keep their
+  // normals; moved corners take the vertex they were collapsed onto.
+  std::vector<unsigned int> result;
+  result.reserve(aliveCount * 3);
+  for (std::uint32_t t = 0; t < triangles.size(); ++t) {
+    if (!alive[t]) {
+      continue;
+    }
+
+    for (int corner = 0; corner < 3; ++corner) {
+      const std::uint32_t original = triangles[t][corner];
+      const std::uint32_t vertex = find(welded[original]);
+      result.push_back(vertex == welded[original] ? original : vertex);
+    }
+  }
+
+  return result;
+}
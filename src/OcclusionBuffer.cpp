@@ -0,0 +1,302 @@
+#include "core/OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCCLUSION_BUFFER_SSE 1
+#endif
+
+namespace {
+
+/**Clip-space w below which a vertex counts as behind the camera. */
+constexpr float NearW = 1e-4f;
+
+/** Clip space to (pixel x, pixel y, window depth, 1); w is 0 if behind. */
+glm::vec4 ToScreen(const glm::vec4& clip) {
+  if (clip.w <= NearW) {
+    return glm::vec4(0.0f);
+  }
+
+  const float inverseW = 1.0f / clip.w;
+  return glm::vec4(
+      (clip.x * inverseW * 0.5f + 0.5f) * OcclusionBuffer::Width,
+      (clip.y * inverseW * 0.5f + 0.5f) * OcclusionBuffer::Height,
+      clip.z * inverseW * 0.5f + 0.5f, 1.0f);
+}
+
+}  // namespace
+
+OcclusionBuffer::OcclusionBuffer() {
+  int width = Width;
+  int height = Height;
+
+  while (true) {
+    m_levels.emplace_back(static_cast<std::size_t>(width) * height, 1.0f);
+    m_levelWidths.push_back(width);
+    m_levelHeights.push_back(height);
+
+    if (width == 1 && height == 1) {
+      break;
+    }
+
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+  }
+}
+
+void OcclusionBuffer::Clear() {
+  m_triangles.clear();
+  std::fill(m_levels[0].begin(), m_levels[0].end(), 1.0f);
+}
+
+void OcclusionBuffer::AddOccluder(const std::vector<float>& vertices,
+                                  int stride,
+                                  const std::vector<unsigned int>& indices,
+                                  const glm::mat4& modelViewProjection) {
+  const std::size_t vertexCount = vertices.size() / stride;
+  m_screenVertices.resize(vertexCount);
+
+  for (std::size_t i = 0; i < vertexCount; ++i) {
+    const float* position = &vertices[i * stride];
+    m_screenVertices[i] = ToScreen(
+        modelViewProjection *
+        glm::vec4(position[0], position[1], position[2], 1.0f));
+  }
+
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    glm::vec4 v0 = m_screenVertices[indices[i]];
+    glm::vec4 v1 = m_screenVertices[indices[i + 1]];
+    glm::vec4 v2 = m_screenVertices[indices[i + 2]];
+
+    // Clipping is not worth it here: a dropped triangle only occludes less.
+    if (v0.w == 0.0f || v1.w == 0.0f || v2.w == 0.0f) {
+      continue;
+    }
+
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (std::fabs(area) < 1e-6f) {
+      continue;
+    }
+
+    // Both windings occlude; orient every triangle counter-clockwise.
+    if (area < 0.0f) {
+      std::swap(v1, v2);
+      area = -area;
+    }
+
+    Triangle triangle;
+    triangle.minX = std::max(0, static_cast<int>(std::floor(
+                                    std::min({v0.x, v1.x, v2.x}))));
+    triangle.maxX = std::min(Width - 1, static_cast<int>(std::ceil(
+                                            std::max({v0.x, v1.x, v2.x}))));
+    triangle.minY = std::max(0, static_cast<int>(std::floor(
+                                    std::min({v0.y, v1.y, v2.y}))));
+    triangle.maxY = std::min(Height - 1, static_cast<int>(std::ceil(
+                                             std::max({v0.y, v1.y, v2.y}))));
+
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+      continue;
+    }
+
+    const glm::vec4* corners[3] = {&v0, &v1, &v2};
+    for (int edge = 0; edge < 3; ++edge) {
+      const glm::vec4& a = *corners[(edge + 1) % 3];
+      const glm::vec4& b = *corners[(edge + 2) % 3];
+      triangle.edgeA[edge] = a.y - b.y;
+      triangle.edgeB[edge] = b.x - a.x;
+      triangle.edgeC[edge] = a.x * b.y - a.y * b.x;
+    }
+
+    // Edge i, divided by the area, is the barycentric weight of vertex i.
+    const float inverseArea = 1.0f / area;
+    triangle.depthA = triangle.depthB = triangle.depthC = 0.0f;
+    for (int vertex = 0; vertex < 3; ++vertex) {
+      const float weight = corners[vertex]->z * inverseArea;
+      triangle.depthA += triangle.edgeA[vertex] * weight;
+      triangle.depthB += triangle.edgeB[vertex] * weight;
+      triangle.depthC += triangle.edgeC[vertex] * weight;
+    }
+
+    m_triangles.push_back(triangle);
+  }
+}
+
+void OcclusionBuffer::Rasterize(JobSystem* jobSystem) {
+  constexpr int bandCount = (Height + BandHeight - 1) / BandHeight;
+
+  auto rasterizeBands = [this](std::size_t begin, std::size_t end) {
+    for (std::size_t band = begin; band < end; ++band) {
+      const int firstRow = static_cast<int>(band) * BandHeight;
+      RasterizeRows(firstRow, std::min(firstRow + BandHeight, Height));
+    }
+  };
+
+  // Bands cover disjoint rows, so they are written without synchronization.
+  if (jobSystem != nullptr && !m_triangles.empty()) {
+    jobSystem->ParallelFor(bandCount, 1, rasterizeBands);
+  } else {
+    rasterizeBands(0, bandCount);
+  }
+
+  BuildPyramid();
+}
+
+void OcclusionBuffer::RasterizeRows(int firstRow, int lastRow) {
+  std::vector<float>& depth = m_levels[0];
+
+  for (const Triangle& triangle : m_triangles) {
+    const int rowBegin = std::max(triangle.minY, firstRow);
+    const int rowEnd = std::min(triangle.maxY + 1, lastRow);
+    // Whole groups of 4 pixels; Width is a multiple of 4.
+    const int columnBegin = triangle.minX & ~3;
+
+    for (int y = rowBegin; y < rowEnd; ++y) {
+      const float centerY = static_cast<float>(y) + 0.5f;
+      float* row = &depth[static_cast<std::size_t>(y) * Width];
+
+#if defined(OCCLUSION_BUFFER_SSE)
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+      __m128 rowEdge[3];
+      __m128 edgeA[3];
+      for (int edge = 0; edge < 3; ++edge) {
+        edgeA[edge] = _mm_set1_ps(triangle.edgeA[edge]);
+        rowEdge[edge] = _mm_set1_ps(triangle.edgeB[edge] * centerY +
+                                    triangle.edgeC[edge]);
+      }
+      const __m128 depthA = _mm_set1_ps(triangle.depthA);
+      const __m128 rowDepth =
+          _mm_set1_ps(triangle.depthB * centerY + triangle.depthC);
+
+      for (int x = columnBegin; x <= triangle.maxX; x += 4) {
+        const __m128 centerX =
+            _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+
+        __m128 inside = _mm_cmpge_ps(
+            _mm_add_ps(_mm_mul_ps(edgeA[0], centerX), rowEdge[0]), zero);
+        inside = _mm_and_ps(
+            inside, _mm_cmpge_ps(
+                        _mm_add_ps(_mm_mul_ps(edgeA[1], centerX), rowEdge[1]),
+                        zero));
+        inside = _mm_and_ps(
+            inside, _mm_cmpge_ps(
+                        _mm_add_ps(_mm_mul_ps(edgeA[2], centerX), rowEdge[2]),
+                        zero));
+
+        if (_mm_movemask_ps(inside) == 0) {
+          continue;
+        }
+
+        const __m128 fragment =
+            _mm_add_ps(_mm_mul_ps(depthA, centerX), rowDepth);
+        const __m128 current = _mm_loadu_ps(row + x);
+        const __m128 nearest = _mm_min_ps(current, fragment);
+        _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest),
+                                         _mm_andnot_ps(inside, current)));
+      }
+#else
+      for (int x = triangle.minX; x <= triangle.maxX; ++x) {
+        const float centerX = static_cast<float>(x) + 0.5f;
+        bool inside = true;
+        for (int edge = 0; edge < 3; ++edge) {
+          inside = inside && triangle.edgeA[edge] * centerX +
+                                     triangle.edgeB[edge] * centerY +
+                                     triangle.edgeC[edge] >=
+                                 0.0f;
+        }
+
+        if (inside) {
+          const float fragment = triangle.depthA * centerX +
+                                 triangle.depthB * centerY + triangle.depthC;
+          row[x] = std::min(row[x], fragment);
+        }
+      }
+#endif
+    }
+  }
+}
+
+void OcclusionBuffer::BuildPyramid() {
+  for (std::size_t level = 1; level < m_levels.size(); ++level) {
+    const std::vector<float>& source = m_levels[level - 1];
+    std::vector<float>& target = m_levels[level];
+    const int sourceWidth = m_levelWidths[level - 1];
+    const int sourceHeight = m_levelHeights[level - 1];
+    const int width = m_levelWidths[level];
+    const int height = m_levelHeights[level];
+
+    for (int y = 0; y < height; ++y) {
+      const int y0 = std::min(2 * y, sourceHeight - 1);
+      const int y1 = std::min(2 * y + 1, sourceHeight - 1);
+
+      for (int x = 0; x < width; ++x) {
+        const int x0 = std::min(2 * x, sourceWidth - 1);
+        const int x1 = std::min(2 * x + 1, sourceWidth - 1);
+        target[static_cast<std::size_t>(y) * width + x] = std::max(
+            {source[static_cast<std::size_t>(y0) * sourceWidth + x0],
+             source[static_cast<std::size_t>(y0) * sourceWidth + x1],
+             source[static_cast<std::size_t>(y1) * sourceWidth + x0],
+             source[static_cast<std::size_t>(y1) * sourceWidth + x1]});
+      }
+    }
+  }
+}
+
+bool OcclusionBuffer::IsVisible(const Aabb& box,
+                                const glm::mat4& viewProjection) const {
+  float minX = static_cast<float>(Width);
+  float maxX = 0.0f;
+  float minY = static_cast<float>(Height);
+  float maxY = 0.0f;
+  float nearestDepth = 1.0f;
+
+  for (int corner = 0; corner < 8; ++corner) {
+    const glm::vec3 point((corner & 1) != 0 ? box.max.x : box.min.x,
+                          (corner & 2) != 0 ? box.max.y : box.min.y,
+                          (corner & 4) != 0 ? box.max.z : box.min.z);
+    const glm::vec4 screen = ToScreen(viewProjection * glm::vec4(point, 1.0f));
+
+    if (screen.w == 0.0f) {
+      return true;
+    }
+
+    minX = std::min(minX, screen.x);
+    maxX = std::max(maxX, screen.x);
+    minY = std::min(minY, screen.y);
+    maxY = std::max(maxY, screen.y);
+    nearestDepth = std::min(nearestDepth, screen.z);
+  }
+
+  const int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+  const int x1 = std::min(Width - 1, static_cast<int>(std::floor(maxX)));
+  const int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+  const int y1 = std::min(Height - 1, static_cast<int>(std::floor(maxY)));
+
+  if (x0 > x1 || y0 > y1) {
+    return true;
+  }
+
+  // The coarsest test is 2x2 texels of the level where the rectangle fits.
+  std::size_t level = 0;
+  while (level + 1 < m_levels.size() &&
+         ((x1 >> level) - (x0 >> level) > 1 ||
+          (y1 >> level) - (y0 >> level) > 1)) {
+    ++level;
+  }
+
+  const std::vector<float>& depth = m_levels[level];
+  const int width = m_levelWidths[level];
+  float farthestOccluder = 0.0f;
+  for (int y = y0 >> level; y <= (y1 >> level); ++y) {
+    for (int x = x0 >> level; x <= (x1 >> level); ++x) {
+      farthestOccluder = std::max(
+          farthestOccluder, depth[static_cast<std::size_t>(y) * width + x]);
+    }
+  }
+
+  return nearestDepth <= farthestOccluder;
+}
@@ -0,0 +1,56 @@
+#include "core/PoolAllocator.h"
+
+#include <algorithm>
+
+PoolAllocator::PoolAllocator(std::size_t blockSize, std::size_t alignment,
+                             std::size_t blocksPerPage)
+    : m_alignment(std::max(alignment, alignof(FreeBlock))),
+      m_blocksPerPage(std::max<std::size_t>(blocksPerPage, 1)) {
+  // Every block must be able to hold the free list link and keep the next
+  // block aligned.
+  blockSize = std::max(blockSize, sizeof(FreeBlock));
+  m_blockSize = (blockSize + m_alignment - 1) & ~(m_alignment - 1);
+}
+
+PoolAllocator::~PoolAllocator() {
+  for (void* page : m_pages) {
+    ::operator delete(page, std::align_val_t{m_alignment});
+  }
+}
+
+void* PoolAllocator::Allocate() {
+  if (m_freeList == nullptr) {
+    AddPage();
+  }
+
+  FreeBlock* block = m_freeList;
+  m_freeList = block->next;
+
+  ++m_stats.liveCount;
+  m_stats.highWaterMark = std::max(m_stats.highWaterMark, m_stats.liveCount);
+
+  return block;
+}
+
+void PoolAllocator::Deallocate(void* block) {
+  auto* freeBlock = static_cast<FreeBlock*>(block);
+  freeBlock->next = m_freeList;
+  m_freeList = freeBlock;
+
+  --m_stats.liveCount;
+}
+
+void PoolAllocator::AddPage() {
+  auto* page = static_cast<std::byte*>(::operator new(
+      m_blockSize * m_blocksPerPage, std::align_val_t{m_alignment}));
+  m_pages.push_back(page);
+
+  // Thread the new blocks in address order, so allocations walk the page.
+  for (std::size_t i = m_blocksPerPage; i-- > 0;) {
+    auto* block = reinterpret_cast<FreeBlock*>(page + i * m_blockSize);
+    block->next = m_freeList;
+    m_freeList = block;
+  }
+
+  m_stats.capacity += m_blocksPerPage;
+}
@@ -0,0 +1,74 @@
+#include "core/RangeAllocator.h"
+
+#include <algorithm>
+#include <iterator>
+
+std::uint32_t RangeAllocator::Allocate(std::uint32_t size) {
+  if (size == 0) {
+    return NoRange;
+  }
+
+  for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+    if (it->size < size) {
+      continue;
+    }
+
+    const std::uint32_t offset = it->offset;
+    if (it->size == size) {
+      m_free.erase(it);
+    } else {
+      it->offset += size;
+      it->size -= size;
+    }
+
+    m_used += size;
+    return offset;
+  }
+
+  return NoRange;
+}
+
+void RangeAllocator::Free(std::uint32_t offset, std::uint32_t size) {
+  if (size == 0) {
+    return;
+  }
+
+  m_used -= size;
+
+  auto next = std::lower_bound(
+      m_free.begin(), m_free.end(), offset,
+      [](const Range& range, std::uint32_t value) {
+        return range.offset < value;
+      });
+
+  const bool joinsPrevious =
+      next != m_free.begin() &&
+      std::prev(next)->offset + std::prev(next)->size == offset;
+  const bool joinsNext = next != m_free.end() && offset + size == next->offset;
+
+  if (joinsPrevious && joinsNext) {
+    std::prev(next)->size += size + next->size;
+    m_free.erase(next);
+  } else if (joinsPrevious) {
+    std::prev(next)->size += size;
+  } else if (joinsNext) {
+    next->offset = offset;
+    next->size += size;
+  } else {
+    m_free.insert(next, {offset, size});
+  }
+}
+
+void RangeAllocator::Grow(std::uint32_t capacity) {
+  if (capacity <= m_capacity) {
+    return;
+  }
+
+  const std::uint32_t added = capacity - m_capacity;
+  const std::uint32_t offset = m_capacity;
+  m_capacity = capacity;
+
+  // Freeing the new tail merges it with a free range ending the old one.
+  m_used += added;
+  Free(offset, added);
+}
@@ -0,0 +1,91 @@
+#include "core/RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+constexpr unsigned RadixBits = 8;
+constexpr std::size_t RadixSize = std::size_t{1} << RadixBits;
+constexpr unsigned DigitCount = 64 / RadixBits;
+
+constexpr std::uint64_t FieldMask(unsigned bits) {
+  return (std::uint64_t{1} << bits) - 1;
+}
+
+static_assert(RenderQueue::DepthBits + RenderQueue::LodBits +
+                      RenderQueue::MeshBits + RenderQueue::MaterialBits +
+                      RenderQueue::ShaderBits + RenderQueue::PassBits ==
+                  64,
+              "Sort key fields must fill 64 bits");
+
+}  // namespace
+
+std::uint64_t RenderQueue::MakeKey(std::uint32_t pass, std::uint32_t shader,
+                                   std::uint32_t material, std::uint32_t mesh,
+                                   std::uint32_t lod, std::uint32_t depth) {
+  std::uint64_t key = pass & FieldMask(PassBits);
+  key = (key << ShaderBits) | (shader & FieldMask(ShaderBits));
+  key = (key << MaterialBits) | (material & FieldMask(MaterialBits));
+  key = (key << MeshBits) | (mesh & FieldMask(MeshBits));
+  key = (key << LodBits) | (lod & FieldMask(LodBits));
+  key = (key << DepthBits) | (depth & FieldMask(DepthBits));
+  return key;
+}
+
+std::uint32_t RenderQueue::QuantizeDepth(float depth, float nearPlane,
+                                         float farPlane) {
+  const float normalized =
+      std::clamp((depth - nearPlane) / (farPlane - nearPlane), 0.0f, 1.0f);
+  return static_cast<std::uint32_t>(normalized *
+                                    static_cast<float>(FieldMask(DepthBits)));
+}
+
+void RenderQueue::Sort() {
+  const std::size_t count = m_entries.size();
+
+  if (count < 2) {
+    return;
+  }
+
+  // One pass builds the histograms of every digit.
+  std::array<std::array<std::uint32_t, RadixSize>, DigitCount> histograms{};
+  for (const Entry& entry : m_entries) {
+    for (unsigned digit = 0; digit < DigitCount; ++digit) {
+      ++histograms[digit][(entry.key >> (digit * RadixBits)) &
+                          (RadixSize - 1)];
+    }
+  }
+
+  m_scratch.resize(count);
+  Entry* source = m_entries.data();
+  Entry* destination = m_scratch.data();
+
+  for (unsigned digit = 0; digit < DigitCount; ++digit) {
+    const unsigned shift = digit * RadixBits;
+    std::array<std::uint32_t, RadixSize>& histogram = histograms[digit];
+
+    // Every key has the same byte here: the pass would not move anything.
+    if (histogram[(source[0].key >> shift) & (RadixSize - 1)] == count) {
+      continue;
+    }
+
+    std::uint32_t offset = 0;
+    for (std::uint32_t& bucket : histogram) {
+      const std::uint32_t size = bucket;
+      bucket = offset;
+      offset += size;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+      const std::size_t bucket = (source[i].key >> shift) & (RadixSize - 1);
+      destination[histogram[bucket]++] = source[i];
+    }
+
+    std::swap(source, destination);
+  }
+
+  if (source != m_entries.data()) {
+    m_entries.swap(m_scratch);
+  }
+}
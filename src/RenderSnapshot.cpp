@@ -0,0 +1,72 @@
+// This file uses ImGui.
+// Copyright (c) 2014-2024 Omar Cornut
+// License: MIT (included in the LICENSE file)
+
+#include "RenderSnapshot.h"
+
+#include <cstring>
+
+namespace {
+
+/** Copies `source` into `destination`, reallocating only when it grows. */
+template <typename T>
+void CopyBuffer(ImVector<T>& destination, const ImVector<T>& source) {
+  destination.resize(source.Size);
+
+  if (source.Size > 0) {
+    std::memcpy(destination.Data, source.Data, source.size_in_bytes());
+  }
+}
+
+}  // namespace
+
+RenderSnapshot::~RenderSnapshot() {
+  for (ImDrawList* list : m_uiLists) {
+    IM_DELETE(list);
+  }
+}
+
+void RenderSnapshot::Clear() {
+  items.clear();
+  instances.clear();
+  batches.clear();
+  instanceBounds.clear();
+  gpuCulling = false;
+  culledItems = 0;
+  occludedItems = 0;
+  lights.clear();
+  m_uiDrawData.Clear();
+}
+
+void RenderSnapshot::CaptureUi(const ImDrawData* drawData) {
+  m_uiDrawData.Clear();
+
+  if (drawData == nullptr || !drawData->Valid) {
+    return;
+  }
+
+  while (m_uiLists.size() < static_cast<std::size_t>(drawData->CmdListsCount)) {
+    m_uiLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+  }
+
+  for (int i = 0; i < drawData->CmdListsCount; ++i) {
+    const ImDrawList* source = drawData->CmdLists[i];
+    ImDrawList* list = m_uiLists[i];
+
+    CopyBuffer(list->CmdBuffer, source->CmdBuffer);
+    CopyBuffer(list->IdxBuffer, source->IdxBuffer);
+    CopyBuffer(list->VtxBuffer, source->VtxBuffer);
+    list->Flags = source->Flags;
+
+    m_uiDrawData.CmdLists.push_back(list);
+  }
+
+  m_uiDrawData.Valid = true;
+  m_uiDrawData.CmdListsCount = drawData->CmdListsCount;
+  m_uiDrawData.TotalIdxCount = drawData->TotalIdxCount;
+  m_uiDrawData.TotalVtxCount = drawData->TotalVtxCount;
+  m_uiDrawData.DisplayPos = drawData->DisplayPos;
+  m_uiDrawData.DisplaySize = drawData->DisplaySize;
+  m_uiDrawData.FramebufferScale = drawData->FramebufferScale;
+  m_uiDrawData.OwnerViewport = drawData->OwnerViewport;
+}
@@ -0,0 +1,84 @@
+#include "RenderThread.h"
+
+#include <GLFW/glfw3.h>
+
+RenderThread::RenderThread(std::shared_ptr<Renderer> renderer)
+    : m_renderer(std::move(renderer)) {}
+
+RenderThread::~RenderThread() {
+  Stop();
+}
+
+void RenderThread::Start() {
+  if (m_thread.joinable()) {
+    return;
+  }
+
+  m_stopRequested = false;
+
+  // A context can only be current on one thread at a time.
+  glfwMakeContextCurrent(nullptr);
+  m_thread = std::thread([this] { Run(); });
+}
+
+void RenderThread::Stop() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopRequested = true;
+  }
+
+  m_published.notify_one();
+  m_thread.join();
+
+  glfwMakeContextCurrent(m_renderer->GetWindow());
+}
+
+void RenderThread::Publish() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_submitted.wait(lock, [this] { return !m_pending; });
+
+    m_readIndex = m_writeIndex;
+    m_pending = true;
+  }
+
+  m_published.notify_one();
+
+  // The other snapshot was submitted before the wait above returned.
+  m_writeIndex = 1 - m_writeIndex;
+}
+
+void RenderThread::Run() {
+  glfwMakeContextCurrent(m_renderer->GetWindow());
+
+  for (;;) {
+    std::size_t index = 0;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_published.wait(lock, [this] { return m_pending || m_stopRequested; });
+
+      // Finish the last frame before stopping.
+      if (!m_pending) {
+        break;
+      }
+
+      index = m_readIndex;
+    }
+
+    m_renderer->Submit(m_snapshots[index]);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pending = false;
+    }
+
+    m_submitted.notify_one();
+  }
+
+  glfwMakeContextCurrent(nullptr);
+}
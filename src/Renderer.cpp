@@ -4,25 +4,24 @@
 
 #include "Renderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <iomanip>
 #include <iostream>
 #include <map>
-#include <sstream>
+#include <numeric>
 
 #include "MeshComponent.h"
 #include "TransformComponent.h"
+#include "core/AllocationCounter.h"
+#include "core/GLDeletionQueue.h"
+#include "core/JobSystem.h"
 #include "imgui.h"
-#include "imgui_impl_glfw.h"
-#include "imgui_impl_opengl3.h"
-
-std::string FormatFPS(double fps, int decimalPlaces) {
-  std::stringstream stream;
-  stream << std::fixed << std::setprecision(decimalPlaces) << fps;
-  return stream.str();
-}
 
 Renderer::Renderer()
     : m_window(nullptr),
@@ -79,7 +78,12 @@ bool Renderer::Initialize() {
   m_shaderManager = std::make_shared<ShaderManager>();
   m_shaderManager->LoadShader("default", "shaders/basic.vert",
                               "shaders/basic.frag");
+  m_shaderManager->LoadShader("instanced", "shaders/basic_instanced.vert",
+                              "shaders/basic.frag");
   m_shaderManager->LoadShader("font", "shaders/font.vert", "shaders/font.frag");
+  StreamingBuffer::Initialize(StreamingRegionSize);
+  m_gpuCuller = std::make_unique<GpuCuller>(m_shaderManager);
+  m_gpuCuller->Initialize();
   m_inputManager = std::make_shared<InputManager>(m_window);
   m_camera = std::make_unique<Camera>(glm::vec3(0.0f, 0.0f, 3.0f), -90.f, 0.0f);
 
@@ -92,6 +96,21 @@ bool Renderer::Initialize() {
 
   glEnable(GL_DEPTH_TEST);
 
+  m_shaderManager->UseShader("default");
+  // MAX_LIGHTS is a preprocessor constant of the shader, invisible to GL, so
+  // count the elements of the light array instead.
+  char uniformName[LightUniformNameSize];
+  m_maxLights = 0;
+  for (;;) {
+    std::snprintf(uniformName, sizeof(uniformName), "lights[%u].position",
+                  m_maxLights);
+    if (m_shaderManager->GetUniformLocation(uniformName) ==
+        static_cast<unsigned int>(-1)) {
+      break;
+    }
+    ++m_maxLights;
+  }
+
   // Uncomment for blending
   // glEnable(GL_BLEND);
   // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -107,6 +126,10 @@ bool Renderer::Initialize() {
 }
 
 void Renderer::Shutdown() {
+  GLDeletionQueue::Flush();
+  m_gpuCuller.reset();
+  StreamingBuffer::Shutdown();
+  MeshBuffer::Shutdown();
   glfwDestroyWindow(m_window);
   glfwTerminate();
 }
@@ -123,110 +146,316 @@ void Renderer::SetLights(const std::vector<Light>& lights) {
   for (size_t i = 0; i < lights.size(); ++i) {
     std::string uniformName = "lights[" + std::to_string(i) + "]";
 
-    m_shaderManager->SetVector3(uniformName + ".position",
+    m_shaderManager->SetVector3((uniformName + ".position").c_str(),
                                 lights[i].GetPosition());
 
-    m_shaderManager->SetVector3(uniformName + ".color",
+    m_shaderManager->SetVector3((uniformName + ".color").c_str(),
                                 lights[i].GetColor());
 
-    m_shaderManager->SetFloat(uniformName + ".intensity",
+    m_shaderManager->SetFloat((uniformName + ".intensity").c_str(),
                               lights[i].GetIntensity());
   }
 }
 
-void Renderer::RenderObject(const std::shared_ptr<GameObject>& object) const {
-  auto* meshComponent = object->GetComponent<MeshComponent>();
-
-  if (meshComponent != nullptr) {
-    auto* transformComponent = object->GetComponent<TransformComponent>();
-
-    if (transformComponent != nullptr) {
-      glm::mat4 model = transformComponent->GetTransformMatrix();
-      m_shaderManager->SetMatrix4("model", model);
-
-      std::shared_ptr<Mesh> mesh = meshComponent->GetMesh();
-
-      if (mesh != nullptr) {
-        // SetLights(m_lights); unused, we are using the new system.
-        mesh->Draw();
-      }
-    }
-  }
-}
-
 bool Renderer::ShouldClose() {
   return glfwWindowShouldClose(m_window);
 }
 
-void Renderer::Render(const std::shared_ptr<Scene>& scene) {
+void Renderer::Render(const std::shared_ptr<Scene>& scene, float deltaTime,
+                      float interpolation) {
+  BuildSnapshot(scene, deltaTime, interpolation, m_snapshot);
+  Submit(m_snapshot);
+}
+
+void Renderer::BuildSnapshot(const std::shared_ptr<Scene>& scene,
+                             float deltaTime, float interpolation,
+                             RenderSnapshot& snapshot) {
   CalculateFPS();
+  CountFrameAllocations();
 
-  if (m_editor != nullptr) {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_editor->GetFramebuffer());
-    glViewport(0, 0, m_editor->GetViewPortSize().x,
-               m_editor->GetViewPortSize().y);
-  }
-
-  glClearColor(0, 0, 0, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  snapshot.Clear();
+  snapshot.fps = m_fps;
+  snapshot.frameAllocations = m_frameAllocations;
 
   m_inputManager->PollEvents();
+  glfwGetWindowSize(m_window, &snapshot.screenWidth, &snapshot.screenHeight);
+
+  // The UI is built here too: it reads and edits the live scene, and ImGui's
+  // GLFW backend needs the main thread. Only its draw output is handed over.
+  // It runs first so the projection below matches this frame's viewport.
+  if (m_editor != nullptr) {
+    Editor::Begin();
+    m_editor->Render(scene);
+    Editor::End();
+    snapshot.viewportSize = m_editor->GetViewPortSize();
+    snapshot.CaptureUi(ImGui::GetDrawData());
+  }
 
   if (m_camera != nullptr) {
     // Camera movement
     if (m_editor->IsViewportFocused()) {
       if (m_inputManager->IsKeyPressed(GLFW_KEY_W))
-        m_camera->MoveForward();
+        m_camera->MoveForward(deltaTime);
       if (m_inputManager->IsKeyPressed(GLFW_KEY_S))
-        m_camera->MoveBackward();
+        m_camera->MoveBackward(deltaTime);
       if (m_inputManager->IsKeyPressed(GLFW_KEY_A))
-        m_camera->MoveLeft();
+        m_camera->MoveLeft(deltaTime);
       if (m_inputManager->IsKeyPressed(GLFW_KEY_D))
-        m_camera->MoveRight();
+        m_camera->MoveRight(deltaTime);
       if (m_inputManager->IsKeyPressed(GLFW_KEY_Q))
-        m_camera->RotateLeft();
+        m_camera->RotateLeft(deltaTime);
       if (m_inputManager->IsKeyPressed(GLFW_KEY_E))
-        m_camera->RotateRight();
+        m_camera->RotateRight(deltaTime);
       if (m_inputManager->IsKeyPressed(GLFW_KEY_LEFT_CONTROL))
-        m_camera->MoveDown();
+        m_camera->MoveDown(deltaTime);
       if (m_inputManager->IsKeyPressed(GLFW_KEY_SPACE))
-        m_camera->MoveUp();
+        m_camera->MoveUp(deltaTime);
     }
 
-    // Prepare matrices
-    int screenWidth, screenHeight;
-    glfwGetWindowSize(m_window, &screenWidth, &screenHeight);
-    glm::mat4 view = m_camera->GetViewMatrix();
-    glm::mat4 projection = glm::perspective(
-        glm::radians(45.0f),
-        static_cast<float>(screenWidth) / static_cast<float>(screenHeight),
-        0.1f, 100.0f);
-    auto model = glm::mat4(1.0f);
-
-    m_shaderManager->UseShader("default");
-    m_shaderManager->SetMatrix4("view", view);
-    m_shaderManager->SetMatrix4("projection", projection);
-    m_shaderManager->SetMatrix4("model", model);
-
-    UpdateLights(scene);
-
-    for (auto& object : scene->GetGameObjects()) {
-      RenderObject(object);
+    // Prepare matrices. The scene is drawn into the editor viewport when
+    // there is one, so its aspect ratio is the one the frustum must have.
+    float targetWidth = static_cast<float>(snapshot.screenWidth);
+    float targetHeight = static_cast<float>(snapshot.screenHeight);
+    if (m_editor != nullptr) {
+      targetWidth = snapshot.viewportSize.x;
+      targetHeight = snapshot.viewportSize.y;
+    }
+    const float aspect =
+        targetWidth > 0.0f && targetHeight > 0.0f ? targetWidth / targetHeight
+                                                  : 1.0f;
+
+    const float fieldOfView = glm::radians(45.0f);
+    snapshot.view = m_camera->GetViewMatrix();
+    snapshot.projection =
+        glm::perspective(fieldOfView, aspect, NearPlane, FarPlane);
+
+    ExtractLights(scene, snapshot);
+
+    // World matrices are already computed in batch by the hierarchy; blend
+    // them between the last two simulation steps.
+    TransformHierarchy& hierarchy = scene->GetHierarchy();
+    hierarchy.Interpolate(interpolation);
+    const std::vector<glm::mat4>& worldMatrices = hierarchy.GetRenderMatrices();
+
+    // Only objects with a mesh are visited, not the whole hierarchy. Their
+    // world bounding spheres are kept for LOD selection and culling.
+    auto meshes = scene->View<TransformComponent, MeshComponent>();
+    snapshot.items.reserve(meshes.Count());
+    CullBatch& batch = m_cullBatch;
+    batch.centerX.clear();
+    batch.centerY.clear();
+    batch.centerZ.clear();
+    batch.radius.clear();
+    const float projectionScale = 1.0f / std::tan(fieldOfView * 0.5f);
+
+    meshes.ForEach([&](GameObject& gameObject, TransformComponent& transform,
+                       MeshComponent& meshComponent) {
+      std::shared_ptr<const Mesh> mesh = meshComponent.GetMesh();
+
+      if (mesh == nullptr) {
+        return;
+      }
+
+      // The center is transformed, the radius grows with the largest axis
+      // scale.
+      const glm::mat4& model = worldMatrices[transform.GetHierarchyIndex()];
+      const Sphere& local = mesh->GetBoundingSphere();
+      const glm::vec3 axisX(model[0]);
+      const glm::vec3 axisY(model[1]);
+      const glm::vec3 axisZ(model[2]);
+      Sphere sphere;
+      sphere.center = glm::vec3(model * glm::vec4(local.center, 1.0f));
+      sphere.radius = local.radius * std::sqrt(std::max(
+                                         {glm::dot(axisX, axisX),
+                                          glm::dot(axisY, axisY),
+                                          glm::dot(axisZ, axisZ)}));
+
+      batch.centerX.push_back(sphere.center.x);
+      batch.centerY.push_back(sphere.center.y);
+      batch.centerZ.push_back(sphere.center.z);
+      batch.radius.push_back(sphere.radius);
+
+      const std::uint32_t lod =
+          SelectLod(*mesh, sphere, gameObject.GetHandle().index,
+                    snapshot.view, projectionScale);
+      snapshot.items.push_back({std::move(mesh), model, lod});
+    });
+
+    // On the GPU, every item is drawn through the compute pass instead.
+    snapshot.gpuCulling = IsGpuCulling();
+    if (!snapshot.gpuCulling) {
+      const glm::mat4 viewProjection = snapshot.projection * snapshot.view;
+      CullItems(Frustum::FromMatrix(viewProjection), snapshot);
+      CullOccludedItems(viewProjection, snapshot);
+    }
+    BuildBatches(snapshot);
+  }
+}
+
+void Renderer::Submit(const RenderSnapshot& snapshot) {
+  // Objects released since the last frame, possibly by another thread.
+  GLDeletionQueue::Flush();
+  StreamingBuffer::BeginFrame();
+
+  if (m_editor != nullptr) {
+    m_editor->SyncFramebuffer(snapshot.viewportSize);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_editor->GetFramebuffer());
+    glViewport(0, 0, static_cast<GLsizei>(snapshot.viewportSize.x),
+               static_cast<GLsizei>(snapshot.viewportSize.y));
+  }
+
+  glClearColor(0, 0, 0, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  if (m_camera != nullptr) {
+    // One indirect command per batch, never per object. Batches come in
+    // sort key order, so commands sharing a shader are consecutive. Empty
+    // meshes keep a command drawing nothing, so commands are indexed like
+    // batches, which is how GPU-culled instances name theirs.
+    m_drawCommands.clear();
+    m_drawRuns.clear();
+
+    for (const RenderBatch& batch : snapshot.batches) {
+      DrawElementsIndirectCommand command;
+      if (!batch.mesh->GetDrawCommand(batch.lod, batch.instanceCount,
+                                      command)) {
+        command = DrawElementsIndirectCommand{};
+      }
+
+      // The compute pass counts the instances it keeps. baseInstance is the
+      // batch's first slot in the visible-instance list, which is also its
+      // first MeshInstance.
+      if (snapshot.gpuCulling) {
+        command.instanceCount = 0;
+      }
+      command.baseInstance = batch.firstInstance;
+
+      const auto index = static_cast<std::uint32_t>(m_drawCommands.size());
+      if (m_drawRuns.empty() || m_drawRuns.back().shader != batch.shader) {
+        m_drawRuns.push_back({batch.shader, index, 0});
+      }
+      ++m_drawRuns.back().commandCount;
+
+      m_drawCommands.push_back(command);
+    }
+
+    // The frame's records are written straight into the streaming buffer.
+    const std::size_t alignment = StreamingBuffer::GetStorageAlignment();
+    const std::size_t instanceCount = snapshot.instances.size();
+    const StreamAllocation instances =
+        StreamingBuffer::Upload(snapshot.instances.data(),
+                                instanceCount * sizeof(MeshInstance),
+                                alignment);
+    // The commands are also a storage buffer of the culling pass.
+    const StreamAllocation commands = StreamingBuffer::Upload(
+        m_drawCommands.data(),
+        m_drawCommands.size() * sizeof(DrawElementsIndirectCommand),
+        alignment);
+
+    // Culled on the CPU, every instance is drawn in order; on the GPU, the
+    // compute pass fills the list.
+    const StreamAllocation visible = StreamingBuffer::Allocate(
+        instanceCount * sizeof(std::uint32_t), alignment);
+    if (!snapshot.gpuCulling && visible.IsValid()) {
+      auto* indices = static_cast<std::uint32_t*>(visible.data);
+      std::iota(indices, indices + instanceCount, 0u);
+    }
+
+    StreamingBuffer::BindRange(GL_SHADER_STORAGE_BUFFER, InstanceBinding,
+                               instances);
+    MeshBuffer::BindInstanceIndices(visible.buffer, visible.offset);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.buffer);
+
+    GLStateCache& state = m_shaderManager->GetState();
+    state.ResetStats();
+
+    if (snapshot.gpuCulling) {
+      m_gpuCuller->Cull(snapshot.projection * snapshot.view,
+                        snapshot.instanceBounds.data(), instanceCount,
+                        commands, visible);
+    }
+
+    // Every mesh lives in the MeshBuffer: one VAO, and one call per shader.
+    state.InvalidateVertexArray();
+    state.BindVertexArray(MeshBuffer::GetVertexArray());
+
+    for (const DrawRun& run : m_drawRuns) {
+      m_shaderManager->UseShader(SceneShaders[run.shader]);
+      m_shaderManager->SetMatrix4("view", snapshot.view);
+      m_shaderManager->SetMatrix4("projection", snapshot.projection);
+      SubmitLights(snapshot.lights);
+
+      glMultiDrawElementsIndirect(
+          GL_TRIANGLES, GL_UNSIGNED_INT,
+          reinterpret_cast<const void*>(
+              commands.offset +
+              run.firstCommand * sizeof(DrawElementsIndirectCommand)),
+          static_cast<GLsizei>(run.commandCount), 0);
+      state.CountDraw();
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    m_renderStats = state.GetStats();
+
+    // The next frame tests against this one's depth. Only the editor's
+    // viewport has a depth format the copy is known to match.
+    if (snapshot.gpuCulling) {
+      if (m_editor != nullptr) {
+        m_gpuCuller->UpdateDepthPyramid(
+            m_editor->GetFramebuffer(),
+            static_cast<int>(snapshot.viewportSize.x),
+            static_cast<int>(snapshot.viewportSize.y),
+            snapshot.projection * snapshot.view);
+      } else {
+        m_gpuCuller->InvalidateDepthPyramid();
+      }
     }
 
     // Render text overlay
     {
-      glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(screenWidth),
-                                        0.0f, static_cast<float>(screenHeight));
+      const auto screenWidth = static_cast<float>(snapshot.screenWidth);
+      const auto screenHeight = static_cast<float>(snapshot.screenHeight);
+      glm::mat4 projection = glm::ortho(0.0f, screenWidth, 0.0f, screenHeight);
       m_textRenderer->SetProjection(projection);
 
       glDisable(GL_DEPTH_TEST);
       glEnable(GL_BLEND);
       glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-      std::string fpsText = FormatFPS(m_fps, 1);
-      m_textRenderer->RenderText(fpsText + " FPS", 25.0f, screenHeight - 50.0f,
-                                 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+      // The frame arena belongs to the simulation thread; format on the stack.
+      char text[96];
+      std::snprintf(text, sizeof(text), "%.1f FPS", snapshot.fps);
+      m_textRenderer->RenderText(text, 25.0f, screenHeight - 50.0f, 1.0f,
+                                 glm::vec3(1.0f, 1.0f, 1.0f));
+      std::snprintf(text, sizeof(text), "%llu allocations/frame",
+                    static_cast<unsigned long long>(snapshot.frameAllocations));
+      m_textRenderer->RenderText(text, 25.0f, screenHeight - 80.0f, 0.5f,
+                                 glm::vec3(1.0f, 1.0f, 1.0f));
+      const std::size_t testedItems =
+          snapshot.items.size() + snapshot.occludedItems;
+      if (snapshot.gpuCulling) {
+        // Survivors are only known to the GPU, which is never read back.
+        std::snprintf(text, sizeof(text),
+                      "%zu commands, %zu objects, culled on the GPU",
+                      m_drawCommands.size(), snapshot.items.size());
+      } else {
+        std::snprintf(
+            text, sizeof(text),
+            "%zu commands, %zu objects, %zu culled, %zu occluded (%.0f%%)",
+            m_drawCommands.size(), snapshot.items.size(),
+            snapshot.culledItems, snapshot.occludedItems,
+            testedItems != 0 ? 100.0 * snapshot.occludedItems /
+                                   static_cast<double>(testedItems)
+                             : 0.0);
+      }
+      m_textRenderer->RenderText(text, 25.0f, screenHeight - 100.0f, 0.5f,
+                                 glm::vec3(1.0f, 1.0f, 1.0f));
+      std::snprintf(text, sizeof(text),
+                    "%u draw calls, %u program switches, %u VAO switches",
+                    m_renderStats.drawCalls, m_renderStats.programSwitches,
+                    m_renderStats.vertexArraySwitches);
+      m_textRenderer->RenderText(text, 25.0f, screenHeight - 120.0f, 0.5f,
+                                 glm::vec3(1.0f, 1.0f, 1.0f));
 
       glDisable(GL_BLEND);
       glEnable(GL_DEPTH_TEST);
@@ -235,13 +464,11 @@ void Renderer::Render(const std::shared_ptr<Scene>& scene) {
 
   if (m_editor != nullptr) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    Editor::Begin();
-    m_editor->Render(scene);
-    Editor::End();
+    Editor::RenderDrawData(snapshot.GetUiDrawData());
   }
 
+  StreamingBuffer::EndFrame();
   glfwSwapBuffers(m_window);
-  glfwPollEvents();
 }
 
 void Renderer::CalculateFPS() {
@@ -255,33 +482,271 @@ void Renderer::CalculateFPS() {
   }
 }
 
-void Renderer::UpdateLights(const std::shared_ptr<Scene>& scene) {
-  const unsigned int MAX_LIGHTS =
-      m_shaderManager->GetUniformLocation("MAX_LIGHTS");
-  std::vector<LightComponent*> sceneLights;
+void Renderer::CountFrameAllocations() {
+  std::uint64_t count = GetHeapAllocationCount();
+  m_frameAllocations = count - m_lastAllocationCount;
+  m_lastAllocationCount = count;
+}
+
+std::uint32_t Renderer::SelectLod(const Mesh& mesh, const Sphere& bounds,
+                                  std::uint32_t entitySlot,
+                                  const glm::mat4& view,
+                                  float projectionScale) {
+  const std::size_t lodCount = mesh.GetLodCount();
+  if (lodCount <= 1) {
+    return 0;
+  }
 
-  for (auto& gameObject : scene->GetGameObjects()) {
-    if (auto* lightComp = gameObject->GetComponent<LightComponent>()) {
-      sceneLights.push_back(lightComp);
+  // Radius on screen, as a fraction of half the viewport height. Each unit
+  // of bias halves it; a camera inside the sphere always gets the finest
+  // level.
+  const float depth = -(view * glm::vec4(bounds.center, 1.0f)).z;
+  const float size =
+      depth > bounds.radius
+          ? bounds.radius * projectionScale / depth * std::exp2(-m_lodBias)
+          : std::numeric_limits<float>::max();
+
+  // Level `lod` covers sizes in [lowerBound(lod), upperBound(lod)).
+  auto lowerBound = [lodCount](std::size_t lod) {
+    return lod + 1 < lodCount ? LodScreenSizes[lod] : 0.0f;
+  };
+  auto upperBound = [](std::size_t lod) {
+    return lod == 0 ? std::numeric_limits<float>::max()
+                    : LodScreenSizes[lod - 1];
+  };
+
+  if (entitySlot >= m_lodHistory.size()) {
+    m_lodHistory.resize(entitySlot + 1, NoLod);
+  }
+  std::uint8_t& previous = m_lodHistory[entitySlot];
+
+  // The previous level is kept until the size leaves its range widened by
+  // the hysteresis, so objects near a threshold do not flicker.
+  if (previous < lodCount &&
+      size >= lowerBound(previous) * (1.0f - LodHysteresis) &&
+      size < upperBound(previous) * (1.0f + LodHysteresis)) {
+    return previous;
+  }
+
+  std::size_t lod = 0;
+  while (size < lowerBound(lod)) {
+    ++lod;
+  }
+
+  previous = static_cast<std::uint8_t>(lod);
+  return previous;
+}
+
+void Renderer::CullItems(const Frustum& frustum, RenderSnapshot& snapshot) {
+  std::vector<RenderItem>& items = snapshot.items;
+  const std::size_t count = items.size();
+  CullBatch& batch = m_cullBatch;
+
+  batch.bounds.resize(count);
+  batch.visible.resize(count);
+
+  const SphereSoA spheres{batch.centerX.data(), batch.centerY.data(),
+                          batch.centerZ.data(), batch.radius.data()};
+  CullSpheres(frustum, spheres, count, batch.visible.data());
+
+  // Spheres are loose around flat or long meshes; survivors get a second
+  // test with their world box. Visible items are compacted in order, with
+  // their bounds, for the occlusion pass.
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (batch.visible[i] == 0) {
+      continue;
+    }
+
+    const Aabb bounds =
+        TransformAabb(items[i].mesh->GetBounds(), items[i].model);
+    if (!frustum.Overlaps(bounds)) {
+      continue;
+    }
+
+    if (kept != i) {
+      items[kept] = std::move(items[i]);
+      batch.centerX[kept] = batch.centerX[i];
+      batch.centerY[kept] = batch.centerY[i];
+      batch.centerZ[kept] = batch.centerZ[i];
+      batch.radius[kept] = batch.radius[i];
     }
+    batch.bounds[kept] = bounds;
+    ++kept;
   }
 
-  m_shaderManager->UseShader("default");
+  snapshot.culledItems = count - kept;
+  items.erase(items.begin() + static_cast<std::ptrdiff_t>(kept), items.end());
+}
 
-  unsigned int numLights =
-      std::min(static_cast<unsigned int>(sceneLights.size()), MAX_LIGHTS);
+void Renderer::CullOccludedItems(const glm::mat4& viewProjection,
+                                 RenderSnapshot& snapshot) {
+  std::vector<RenderItem>& items = snapshot.items;
+  const std::size_t count = items.size();
+  CullBatch& batch = m_cullBatch;
+
+  // Occluders are the cubes and planes covering the most screen, judged by
+  // their bounding sphere's radius over its distance to the camera. Meshes
+  // whose CPU copy was released cannot be rasterized.
+  std::vector<std::pair<float, std::uint32_t>>& occluders = m_occluders;
+  occluders.clear();
+  for (std::size_t i = 0; i < count; ++i) {
+    const MeshType type = items[i].mesh->GetType();
+    if ((type != MeshType::Cube && type != MeshType::Plane) ||
+        !items[i].mesh->HasCpuData()) {
+      continue;
+    }
 
-  m_shaderManager->SetInt("numLights", numLights);
+    const glm::vec4 center = snapshot.view * glm::vec4(batch.centerX[i],
+                                                       batch.centerY[i],
+                                                       batch.centerZ[i], 1.0f);
+    const float size = batch.radius[i] / std::max(-center.z, 1e-3f);
+    if (size >= MinOccluderSize) {
+      occluders.emplace_back(size, static_cast<std::uint32_t>(i));
+    }
+  }
 
-  for (unsigned int i = 0; i < numLights; ++i) {
-    std::string uniformName = "lights[" + std::to_string(i) + "]";
-    auto* light = sceneLights[i];
-
-    m_shaderManager->SetVector3(uniformName + ".position",
-                                light->GetPosition());
-    m_shaderManager->SetVector3(uniformName + ".color",
-                                light->GetColor());
-    m_shaderManager->SetFloat(uniformName + ".intensity",
-                              light->GetIntensity());
+  if (occluders.empty()) {
+    return;
+  }
+
+  if (occluders.size() > MaxOccluders) {
+    std::partial_sort(occluders.begin(), occluders.begin() + MaxOccluders,
+                      occluders.end(), std::greater<>());
+    occluders.resize(MaxOccluders);
+  }
+
+  m_occlusionBuffer.Clear();
+  for (const auto& [size, index] : occluders) {
+    const Mesh& mesh = *items[index].mesh;
+    m_occlusionBuffer.AddOccluder(mesh.GetVertices(), mesh.GetVertexStride(),
+                                  mesh.GetIndices(),
+                                  viewProjection * items[index].model);
+  }
+  m_occlusionBuffer.Rasterize(m_jobSystem.get());
+
+  auto testItems = [this, &viewProjection](std::size_t begin,
+                                           std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      m_cullBatch.visible[i] =
+          m_occlusionBuffer.IsVisible(m_cullBatch.bounds[i], viewProjection)
+              ? 1
+              : 0;
+    }
+  };
+
+  if (m_jobSystem != nullptr) {
+    m_jobSystem->ParallelFor(count, OcclusionTestBatchSize, testItems);
+  } else {
+    testItems(0, count);
+  }
+
+  // An occluder must not hide itself through rounding in its own depth.
+  for (const auto& [size, index] : occluders) {
+    batch.visible[index] = 1;
+  }
+
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (batch.visible[i] == 0) {
+      continue;
+    }
+
+    if (kept != i) {
+      items[kept] = std::move(items[i]);
+    }
+    ++kept;
+  }
+
+  snapshot.occludedItems = count - kept;
+  items.erase(items.begin() + static_cast<std::ptrdiff_t>(kept), items.end());
+}
+
+void Renderer::BuildBatches(RenderSnapshot& snapshot) {
+  const std::vector<RenderItem>& items = snapshot.items;
+  RenderQueue& queue = m_renderQueue;
+  queue.Clear();
+  queue.Reserve(items.size());
+
+  // Every item is opaque and drawn with the instanced shader; there are no
+  // materials yet, so that field stays 0.
+  constexpr std::uint32_t shader = 0;
+  constexpr std::uint32_t material = 0;
+
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    const RenderItem& item = items[i];
+    const glm::vec3 center(
+        snapshot.view * item.model *
+        glm::vec4(item.mesh->GetBoundingSphere().center, 1.0f));
+    const std::uint32_t depth =
+        RenderQueue::QuantizeDepth(-center.z, NearPlane, FarPlane);
+
+    queue.Push(RenderQueue::MakeKey(OpaquePass, shader, material,
+                                    item.mesh->GetId(), item.lod, depth),
+               static_cast<std::uint32_t>(i));
+  }
+
+  queue.Sort();
+
+  const std::vector<RenderQueue::Entry>& entries = queue.GetEntries();
+  snapshot.instances.resize(entries.size());
+
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const RenderItem& item = items[entries[i].item];
+    const glm::mat4& model = item.model;
+    const glm::mat3 normalMatrix =
+        glm::transpose(glm::inverse(glm::mat3(model)));
+    snapshot.instances[i] = {model,
+                             {glm::vec4(normalMatrix[0], 0.0f),
+                              glm::vec4(normalMatrix[1], 0.0f),
+                              glm::vec4(normalMatrix[2], 0.0f)}};
+
+    // Mesh ids are truncated in the key, so the meshes are compared too.
+    if (i == 0 ||
+        (entries[i].key & RenderQueue::StateMask) !=
+            (entries[i - 1].key & RenderQueue::StateMask) ||
+        item.mesh != items[entries[i - 1].item].mesh) {
+      snapshot.batches.push_back({item.mesh.get(), shader, item.lod,
+                                  static_cast<std::uint32_t>(i), 0});
+    }
+    ++snapshot.batches.back().instanceCount;
+
+    if (snapshot.gpuCulling) {
+      const Aabb bounds = TransformAabb(item.mesh->GetBounds(), model);
+      snapshot.instanceBounds.push_back(
+          {bounds.GetCenter(),
+           static_cast<std::uint32_t>(snapshot.batches.size() - 1),
+           bounds.GetExtents()});
+    }
+  }
+}
+
+void Renderer::ExtractLights(const std::shared_ptr<Scene>& scene,
+                             RenderSnapshot& snapshot) const {
+  scene->View<TransformComponent, LightComponent>().ForEach(
+      [&](GameObject&, TransformComponent&, LightComponent& light) {
+        if (snapshot.lights.size() < m_maxLights) {
+          snapshot.lights.emplace_back(light.GetPosition(), light.GetColor(),
+                                       light.GetIntensity());
+        }
+      });
+}
+
+void Renderer::SubmitLights(const std::vector<Light>& lights) const {
+  const auto count = static_cast<std::uint32_t>(
+      std::min<std::size_t>(lights.size(), m_maxLights));
+  m_shaderManager->SetInt("numLights", static_cast<int>(count));
+
+  char uniformName[LightUniformNameSize];
+
+  for (std::uint32_t i = 0; i < count; ++i) {
+    const Light& light = lights[i];
+
+    std::snprintf(uniformName, sizeof(uniformName), "lights[%u].position", i);
+    m_shaderManager->SetVector3(uniformName, light.GetPosition());
+    std::snprintf(uniformName, sizeof(uniformName), "lights[%u].color", i);
+    m_shaderManager->SetVector3(uniformName, light.GetColor());
+    std::snprintf(uniformName, sizeof(uniformName), "lights[%u].intensity", i);
+    m_shaderManager->SetFloat(uniformName, light.GetIntensity());
   }
 }
@@ -1 +1,43 @@
 #include "Scene.h"
+
+#include "MeshComponent.h"
+
+void Scene::RefitSpatialIndex() {
+  const std::vector<GameObject*>& nodes = m_hierarchy.GetNodes();
+
+  for (std::uint32_t index : m_hierarchy.GetChangedNodes()) {
+    GameObject* gameObject = nodes[index];
+
+    Aabb localBounds;
+    MeshComponent* meshComponent = gameObject->GetComponent<MeshComponent>();
+    if (meshComponent != nullptr && meshComponent->GetMesh() != nullptr &&
+        !meshComponent->GetMesh()->GetBounds().IsEmpty()) {
+      localBounds = meshComponent->GetMesh()->GetBounds();
+    } else {
+      localBounds.Expand(glm::vec3(0.0f));
+    }
+
+    Aabb bounds =
+        TransformAabb(localBounds, m_hierarchy.GetWorldMatrix(index));
+
+    std::uint32_t slot = gameObject->GetHandle().index;
+    if (slot >= m_spatialProxies.size()) {
+      m_spatialProxies.resize(slot + 1, AabbTree::NullNode);
+    }
+
+    std::int32_t& proxy = m_spatialProxies[slot];
+    if (proxy == AabbTree::NullNode) {
+      proxy = m_spatialIndex.CreateProxy(bounds, gameObject);
+    } else {
+      m_spatialIndex.MoveProxy(proxy, bounds);
+    }
+  }
+
+  // Incremental insertions are cheap but leave the tree worse than a full
+  // SAH build; rebuild once about half the tree has been reinserted.
+  const std::size_t rebuildThreshold =
+      std::max<std::size_t>(64, m_spatialIndex.GetProxyCount() / 2);
+  if (m_spatialIndex.GetInsertionsSinceRebuild() > rebuildThreshold) {
+    m_spatialIndex.Rebuild();
+  }
+}
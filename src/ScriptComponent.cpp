@@ -10,6 +10,18 @@
 #include <dlfcn.h>
 #endif
 
+ScriptComponent::ScriptComponent(ScriptComponent&& other) noexcept
+    : Component(std::move(other)),
+      compiled(other.compiled),
+      m_ScriptName(std::move(other.m_ScriptName)),
+      m_DllHandle(other.m_DllHandle),
+      m_Instance(other.m_Instance),
+      m_LastCompileTime(other.m_LastCompileTime) {
+  other.compiled = false;
+  other.m_DllHandle = nullptr;
+  other.m_Instance = nullptr;
+}
+
 ScriptComponent::~ScriptComponent() {
   UnloadScript();
 }
@@ -146,11 +158,7 @@ std::string ScriptComponent::CompileAndLoad() {
       throw std::runtime_error("Failed to create script instance");
     }
 
-    if (auto sharedOwner = m_owner.lock()) {
-      m_Instance->m_gameObject = sharedOwner;
-    } else {
-      throw std::runtime_error("GameObject no longer exists.");
-    }
+    m_Instance->m_gameObject = m_owner;
     m_Instance->OnCreate();
 
     m_LastCompileTime = std::filesystem::last_write_time(GetScriptPath());
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 ShaderManager::ShaderManager() = default;
 
@@ -22,6 +23,17 @@ bool ShaderManager::LoadShader(const std::string& name, const char* vertexPath,
   }
 }
 
+bool ShaderManager::LoadComputeShader(const std::string& name,
+                                      const char* computePath) {
+  try {
+    m_shaders[name] = std::make_shared<Shader>(computePath);
+    return true;
+  } catch (std::exception& e) {
+    std::cerr << "Failed to load shader '" << name << "': " << e.what() << "\n";
+    return false;
+  }
+}
+
 unsigned int ShaderManager::GetShaderID(const std::string& name) {
   auto it = m_shaders.find(name);
   if (it != m_shaders.end()) {
@@ -32,47 +44,51 @@ unsigned int ShaderManager::GetShaderID(const std::string& name) {
   }
 }
 
-void ShaderManager::UseShader(const std::string& name) {
+bool ShaderManager::UseShader(const std::string& name) {
   // std::cout << "shader " << name << " successfully selected." << std::endl;
   // Will reuse this into a Log dock
 
   auto it = m_shaders.find(name);
   if (it != m_shaders.end()) {
-    if (m_currentShader != it->second) {
-      m_currentShader = it->second;
-      m_currentShader->Use();  // Activate shader
-    }
+    m_currentShader = it->second;
+    return m_state.UseProgram(m_currentShader->ID);  // Activate shader
   } else {
     std::cerr << "Shader '" << name << "' not found." << "\n";
+    return false;
   }
 }
 
-void ShaderManager::SetBool(const std::string& name, bool value) {
+void ShaderManager::SetBool(const char* name, bool value) {
   glUniform1i(GetUniformLocation(name), static_cast<int>(value));
 }
 
-void ShaderManager::SetInt(const std::string& name, int value) {
+void ShaderManager::SetInt(const char* name, int value) {
   glUniform1i(GetUniformLocation(name), value);
 }
 
-void ShaderManager::SetFloat(const std::string& name, float value) {
+void ShaderManager::SetFloat(const char* name, float value) {
   glUniform1f(GetUniformLocation(name), value);
 }
 
-void ShaderManager::SetVector3(const std::string& name,
+void ShaderManager::SetVector3(const char* name,
                                const glm::vec3& value) {
   glUniform3fv(GetUniformLocation(name), 1, glm::value_ptr(value));
 }
 
-void ShaderManager::SetMatrix4(const std::string& name,
+void ShaderManager::SetVector4(const char* name,
+                               const glm::vec4& value) {
+  glUniform4fv(GetUniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void ShaderManager::SetMatrix4(const char* name,
                                const glm::mat4& value) {
   glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE,
                      glm::value_ptr(value));
 }
 
-unsigned int ShaderManager::GetUniformLocation(const std::string& name) {
+unsigned int ShaderManager::GetUniformLocation(const char* name) {
   if (m_currentShader != nullptr) {
-    return glGetUniformLocation(m_currentShader->ID, name.c_str());
+    return glGetUniformLocation(m_currentShader->ID, name);
   } else {
     std::cerr << "No shader currently in use." << "\n";
     return -1;
@@ -139,6 +155,45 @@ ShaderManager::Shader::Shader(const char* vertexPath,
   glDeleteShader(fragment);
 }
 
+ShaderManager::Shader::Shader(const char* computePath) {
+  std::string computeCode;
+  std::ifstream cShaderFile;
+
+  cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+  try {
+    cShaderFile.open(computePath);
+    std::stringstream cShaderStream;
+    cShaderStream << cShaderFile.rdbuf();
+    cShaderFile.close();
+    computeCode = cShaderStream.str();
+  } catch (std::ifstream::failure& e) {
+    throw std::runtime_error(std::string("cannot read ") + computePath);
+  }
+
+  const char* cShaderCode = computeCode.c_str();
+
+  unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+  glShaderSource(compute, 1, &cShaderCode, nullptr);
+  glCompileShader(compute);
+  checkCompileErrors(compute, "COMPUTE");
+
+  ID = glCreateProgram();
+  glAttachShader(ID, compute);
+  glLinkProgram(ID);
+  checkCompileErrors(ID, "PROGRAM");
+  glDeleteShader(compute);
+
+  // Callers fall back to another path when a compute program is missing, so
+  // a failure is reported rather than leaving an unusable program.
+  int success = 0;
+  glGetProgramiv(ID, GL_LINK_STATUS, &success);
+  if (!success) {
+    glDeleteProgram(ID);
+    throw std::runtime_error(std::string("cannot link ") + computePath);
+  }
+}
+
 void ShaderManager::Shader::checkCompileErrors(unsigned int shader,
                                                const std::string& type) {
   int success;
@@ -0,0 +1,179 @@
+#include "core/StreamingBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "core/GLDeletionQueue.h"
+
+namespace {
+
+constexpr GLbitfield MapFlags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+/**Regions are kept multiples of this, so each starts suitably aligned. */
+constexpr std::size_t RegionGranularity = 256;
+/**How long BeginFrame() waits on a fence per try, in nanoseconds. */
+constexpr GLuint64 FenceTimeout = 1000000;
+
+GLuint buffer = 0;
+std::uint8_t* mappedData = nullptr;
+std::size_t regionSize = 0;
+std::array<GLsync, StreamingBuffer::RegionCount> fences{};
+/**Region of the current frame, and the bytes it used so far. */
+std::size_t region = 0;
+std::size_t head = 0;
+/**Bytes the current frame used in buffers it outgrew. */
+std::size_t grownFrameBytes = 0;
+std::size_t lastFrameBytes = 0;
+std::size_t storageAlignment = StreamingBuffer::DefaultAlignment;
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+void WaitFence(GLsync& fence) {
+  if (fence == nullptr) {
+    return;
+  }
+
+  GLenum result = glClientWaitSync(fence, 0, 0);
+  while (result == GL_TIMEOUT_EXPIRED) {
+    result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceTimeout);
+  }
+
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+/** Creates and maps a buffer of RegionCount regions of `size` bytes. */
+void CreateStorage(std::size_t size) {
+  regionSize = AlignUp(std::max<std::size_t>(size, RegionGranularity),
+                       RegionGranularity);
+  const auto totalSize =
+      static_cast<GLsizeiptr>(regionSize * StreamingBuffer::RegionCount);
+
+  glCreateBuffers(1, &buffer);
+  glNamedBufferStorage(buffer, totalSize, nullptr, MapFlags);
+  mappedData = static_cast<std::uint8_t*>(
+      glMapNamedBufferRange(buffer, 0, totalSize, MapFlags));
+}
+
+/** Moves to a buffer whose regions hold `required` bytes. The frame goes on
+ * in its first region; the old buffer stays mapped until the frame is
+ * submitted, since its ranges are still in use. */
+void Grow(std::size_t required) {
+  // Nothing is in flight in the new buffer.
+  for (GLsync& fence : fences) {
+    if (fence != nullptr) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  GLDeletionQueue::DeleteBuffer(buffer);
+  CreateStorage(std::max(regionSize * 2, required));
+  region = 0;
+  grownFrameBytes += head;
+  head = 0;
+}
+
+}  // namespace
+
+void StreamingBuffer::Initialize(std::size_t size) {
+  GLint alignment = 0;
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  storageAlignment = std::max(static_cast<std::size_t>(alignment),
+                              DefaultAlignment);
+
+  CreateStorage(size);
+  region = 0;
+  head = 0;
+}
+
+void StreamingBuffer::Shutdown() {
+  for (GLsync& fence : fences) {
+    WaitFence(fence);
+  }
+
+  if (buffer != 0) {
+    glUnmapNamedBuffer(buffer);
+    glDeleteBuffers(1, &buffer);
+  }
+
+  buffer = 0;
+  mappedData = nullptr;
+  regionSize = 0;
+  head = 0;
+}
+
+void StreamingBuffer::BeginFrame() {
+  region = (region + 1) % RegionCount;
+  head = 0;
+  grownFrameBytes = 0;
+  WaitFence(fences[region]);
+}
+
+void StreamingBuffer::EndFrame() {
+  if (buffer == 0) {
+    return;
+  }
+
+  fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  lastFrameBytes = grownFrameBytes + head;
+}
+
+StreamAllocation StreamingBuffer::Allocate(std::size_t size,
+                                           std::size_t alignment) {
+  if (buffer == 0) {
+    return {};
+  }
+
+  const std::size_t base = region * regionSize;
+  std::size_t offset = AlignUp(base + head, alignment);
+
+  if (offset + size > base + regionSize) {
+    Grow(head + size + alignment);
+    offset = AlignUp(region * regionSize + head, alignment);
+  }
+
+  head = offset + size - region * regionSize;
+
+  StreamAllocation allocation;
+  allocation.buffer = buffer;
+  allocation.offset = static_cast<GLintptr>(offset);
+  allocation.size = static_cast<GLsizeiptr>(size);
+  allocation.data = mappedData + offset;
+  return allocation;
+}
+
+StreamAllocation StreamingBuffer::Upload(const void* data, std::size_t size,
+                                         std::size_t alignment) {
+  StreamAllocation allocation = Allocate(size, alignment);
+
+  if (allocation.IsValid() && size != 0) {
+    std::memcpy(allocation.data, data, size);
+  }
+
+  return allocation;
+}
+
+void StreamingBuffer::BindRange(GLenum target, GLuint index,
+                                const StreamAllocation& allocation) {
+  if (allocation.size > 0) {
+    glBindBufferRange(target, index, allocation.buffer, allocation.offset,
+                      allocation.size);
+  }
+}
+
+std::size_t StreamingBuffer::GetStorageAlignment() {
+  return storageAlignment;
+}
+
+std::size_t StreamingBuffer::GetRegionSize() {
+  return regionSize;
+}
+
+std::size_t StreamingBuffer::GetLastFrameBytes() {
+  return lastFrameBytes;
+}
@@ -2,17 +2,26 @@
 
 #include <glad/glad.h>
 
+#include <cstring>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 
 #include "ShaderManager.h"
+#include "core/StreamingBuffer.h"
+
+namespace {
+
+/**Floats per vertex of a glyph quad: position, then texture coordinates. */
+constexpr int GlyphVertexStride = 4;
+constexpr int GlyphVertexCount = 6;
+
+}  // namespace
 
 TextRenderer::TextRenderer(const std::shared_ptr<ShaderManager>& shaderManager)
-    : m_shaderManager(shaderManager), VAO(0), VBO(0) {}
+    : m_shaderManager(shaderManager), VAO(0) {}
 
 TextRenderer::~TextRenderer() {
   glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
 }
 
 bool TextRenderer::Initialize(const std::string& fontPath,
@@ -81,30 +90,37 @@ bool TextRenderer::Initialize(const std::string& fontPath,
   FT_Done_Face(face);
   FT_Done_FreeType(ft);
 
-  // Setup VBO and VAO
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-  glBindVertexArray(VAO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  // Setup VAO; its vertex buffer is the range of each RenderText() call
+  glCreateVertexArrays(1, &VAO);
+  glVertexArrayAttribFormat(VAO, 0, GlyphVertexStride, GL_FLOAT, GL_FALSE, 0);
+  glVertexArrayAttribBinding(VAO, 0, 0);
+  glEnableVertexArrayAttrib(VAO, 0);
 
   return true;
 }
 
-void TextRenderer::RenderText(const std::string& text, float x, float y,
+void TextRenderer::RenderText(std::string_view text, float x, float y,
                               float scale, glm::vec3 color) {
   m_shaderManager->UseShader("font");
   m_shaderManager->SetVector3("textColor", color);
   m_shaderManager->SetMatrix4("projection", m_projection);
 
+  // One upload for the whole string instead of one per glyph
+  const StreamAllocation allocation = StreamingBuffer::Allocate(
+      text.size() * GlyphVertexCount * GlyphVertexStride * sizeof(float));
+  if (!allocation.IsValid()) {
+    return;
+  }
+
+  auto* quads = static_cast<float*>(allocation.data);
+  glVertexArrayVertexBuffer(VAO, 0, allocation.buffer, allocation.offset,
+                            GlyphVertexStride * sizeof(float));
+
   glActiveTexture(GL_TEXTURE0);
   glBindVertexArray(VAO);
 
-  for (std::string::const_iterator c = text.begin(); c != text.end(); ++c) {
+  GLint firstVertex = 0;
+  for (auto c = text.begin(); c != text.end(); ++c) {
     Character ch = Characters[*c];
 
     float xpos = x + ch.Bearing.x * scale;
@@ -124,13 +140,13 @@ void TextRenderer::RenderText(const std::string& text, float x, float y,
 			{ xpos + w, ypos + h,   1.0f, 0.0f }
 		};
 
-    // Render glyph texture and update VBO
+    // Write the quad into the string's range, then render the glyph texture;
+    // the mapping is coherent, so the draw sees the write
+    std::memcpy(quads + firstVertex * GlyphVertexStride, vertices,
+                sizeof(vertices));
     glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glDrawArrays(GL_TRIANGLES, firstVertex, GlyphVertexCount);
+    firstVertex += GlyphVertexCount;
 
     // Now advance cursors for next glyph (note that advance is number of
     // 1/64 pixels)
@@ -0,0 +1,382 @@
+#include "core/TransformHierarchy.h"
+
+#include <algorithm>
+#include <glm/gtc/quaternion.hpp>
+
+#include "GameObject.h"
+#include "core/Quaternion.h"
+#include "core/TransformKernel.h"
+
+namespace {
+
+TransformComponent& GetTransform(GameObject* object) {
+  return *object->GetComponent<TransformComponent>();
+}
+
+template <typename T>
+void RotateBlock(std::vector<T>& values, std::uint32_t first,
+                 std::uint32_t count, std::uint32_t position) {
+  auto begin = values.begin();
+
+  if (position > first) {
+    std::rotate(begin + first, begin + first + count, begin + position);
+  } else {
+    std::rotate(begin + position, begin + first, begin + first + count);
+  }
+}
+
+/**
+ * @brief Blends two world matrices.
+ *
+ * Translation and the length of each axis are interpolated linearly and the
+ * rotation along the shortest arc, so a spinning object keeps its size.
+ * Mirrored matrices have no rotation to extract and are blended entry-wise.
+ */
+glm::mat4 InterpolateMatrix(const glm::mat4& from, const glm::mat4& to,
+                            float alpha) {
+  glm::vec3 fromScale(glm::length(glm::vec3(from[0])),
+                      glm::length(glm::vec3(from[1])),
+                      glm::length(glm::vec3(from[2])));
+  glm::vec3 toScale(glm::length(glm::vec3(to[0])),
+                    glm::length(glm::vec3(to[1])),
+                    glm::length(glm::vec3(to[2])));
+
+  glm::mat3 fromAxes(glm::vec3(from[0]) / fromScale.x,
+                     glm::vec3(from[1]) / fromScale.y,
+                     glm::vec3(from[2]) / fromScale.z);
+  glm::mat3 toAxes(glm::vec3(to[0]) / toScale.x,
+                   glm::vec3(to[1]) / toScale.y,
+                   glm::vec3(to[2]) / toScale.z);
+
+  if (!(glm::determinant(fromAxes) > 0.0f && glm::determinant(toAxes) > 0.0f)) {
+    glm::mat4 result;
+    for (int column = 0; column < 4; ++column) {
+      result[column] = glm::mix(from[column], to[column], alpha);
+    }
+    return result;
+  }
+
+  glm::quat rotation =
+      Nlerp(glm::quat_cast(fromAxes), glm::quat_cast(toAxes), alpha);
+  glm::mat3 axes = glm::mat3_cast(rotation);
+  glm::vec3 scale = glm::mix(fromScale, toScale, alpha);
+
+  glm::mat4 result(1.0f);
+  result[0] = glm::vec4(axes[0] * scale.x, 0.0f);
+  result[1] = glm::vec4(axes[1] * scale.y, 0.0f);
+  result[2] = glm::vec4(axes[2] * scale.z, 0.0f);
+  result[3] = glm::mix(from[3], to[3], alpha);
+  return result;
+}
+
+}  // namespace
+
+void TransformHierarchy::Add(GameObject& object) {
+  auto index = static_cast<std::uint32_t>(m_nodes.size());
+
+  m_nodes.push_back(&object);
+  m_parents.push_back(NoParent);
+  m_subtreeSizes.push_back(1);
+  m_worldMatrices.emplace_back(1.0f);
+  m_previousWorldMatrices.emplace_back(1.0f);
+  m_renderMatrices.emplace_back(1.0f);
+  m_motion.push_back(MotionState::Snap);
+
+  TransformComponent& transform = GetTransform(&object);
+  transform.m_hierarchy = this;
+  transform.m_hierarchyIndex = index;
+  transform.m_worldDirty = false;
+  transform.MarkDirty();
+}
+
+void TransformHierarchy::Remove(GameObject& object) {
+  GameObject* objects[] = {&object};
+  Remove(Span<GameObject* const>(objects, 1));
+}
+
+void TransformHierarchy::Remove(Span<GameObject* const> objects) {
+  if (objects.empty()) {
+    return;
+  }
+
+  std::vector<bool> removed(m_nodes.size(), false);
+
+  // The children now hang from another node, so their world matrices change.
+  // Visit them before any subtree size is touched.
+  for (GameObject* object : objects) {
+    std::uint32_t index = GetTransform(object).m_hierarchyIndex;
+    std::uint32_t childrenEnd = index + m_subtreeSizes[index];
+    removed[index] = true;
+
+    for (std::uint32_t child = index + 1; child < childrenEnd;
+         child += m_subtreeSizes[child]) {
+      GetTransform(m_nodes[child]).m_worldDirty = true;
+    }
+  }
+
+  for (GameObject* object : objects) {
+    std::uint32_t index = GetTransform(object).m_hierarchyIndex;
+
+    for (std::int32_t p = m_parents[index]; p != NoParent; p = m_parents[p]) {
+      --m_subtreeSizes[p];
+    }
+  }
+
+  // Compact every array in one pass; the depth-first order is preserved.
+  std::uint32_t kept = 0;
+  for (std::uint32_t i = 0; i < m_nodes.size(); ++i) {
+    if (removed[i]) {
+      TransformComponent& transform = GetTransform(m_nodes[i]);
+      transform.m_hierarchy = nullptr;
+      transform.m_worldDirty = false;
+
+      if (m_motion[i] == MotionState::Moved) {
+        --m_movedCount;
+      }
+      continue;
+    }
+
+    m_nodes[kept] = m_nodes[i];
+    m_subtreeSizes[kept] = m_subtreeSizes[i];
+    m_worldMatrices[kept] = m_worldMatrices[i];
+    m_previousWorldMatrices[kept] = m_previousWorldMatrices[i];
+    m_renderMatrices[kept] = m_renderMatrices[i];
+    m_motion[kept] = m_motion[i];
+    ++kept;
+  }
+
+  m_nodes.resize(kept);
+  m_parents.resize(kept);
+  m_subtreeSizes.resize(kept);
+  m_worldMatrices.resize(kept);
+  m_previousWorldMatrices.resize(kept);
+  m_renderMatrices.resize(kept);
+  m_motion.resize(kept);
+
+  Reindex();
+}
+
+void TransformHierarchy::Reserve(std::size_t count) {
+  m_nodes.reserve(count);
+  m_parents.reserve(count);
+  m_subtreeSizes.reserve(count);
+  m_worldMatrices.reserve(count);
+  m_previousWorldMatrices.reserve(count);
+  m_renderMatrices.reserve(count);
+  m_motion.reserve(count);
+}
+
+bool TransformHierarchy::SetParent(GameObject& child, GameObject* parent) {
+  std::uint32_t first = GetTransform(&child).m_hierarchyIndex;
+  std::uint32_t count = m_subtreeSizes[first];
+  auto position = static_cast<std::uint32_t>(m_nodes.size());
+
+  if (parent != nullptr) {
+    std::uint32_t parentIndex = GetTransform(parent).m_hierarchyIndex;
+
+    if (parentIndex >= first && parentIndex < first + count) {
+      return false;
+    }
+
+    // Append the subtree after the parent's last descendant.
+    position = parentIndex + m_subtreeSizes[parentIndex];
+  }
+
+  for (std::int32_t p = m_parents[first]; p != NoParent; p = m_parents[p]) {
+    m_subtreeSizes[p] -= count;
+  }
+
+  if (parent != nullptr) {
+    for (auto p = static_cast<std::int32_t>(GetTransform(parent).m_hierarchyIndex);
+         p != NoParent; p = m_parents[p]) {
+      m_subtreeSizes[p] += count;
+    }
+  }
+
+  // Parent indices are stale after the move; Reindex() rebuilds them from
+  // the subtree sizes.
+  MoveBlock(first, count, position);
+
+  GetTransform(&child).m_worldDirty = true;
+  Reindex();
+
+  return true;
+}
+
+GameObject* TransformHierarchy::GetParent(GameObject& object) const {
+  const auto* transform = object.GetComponent<TransformComponent>();
+
+  if (transform == nullptr || transform->m_hierarchy != this) {
+    return nullptr;
+  }
+
+  std::int32_t parent = m_parents[transform->m_hierarchyIndex];
+  return parent != NoParent ? m_nodes[parent] : nullptr;
+}
+
+void TransformHierarchy::Update() {
+  m_changedNodes.clear();
+
+  // Nodes that moved during the previous step are at rest unless this step
+  // moves them again.
+  if (m_movedCount != 0) {
+    for (std::size_t i = 0; i < m_nodes.size(); ++i) {
+      if (m_motion[i] == MotionState::Moved) {
+        m_previousWorldMatrices[i] = m_worldMatrices[i];
+        m_renderMatrices[i] = m_worldMatrices[i];
+        m_motion[i] = MotionState::Static;
+      }
+    }
+    m_movedCount = 0;
+  }
+
+  if (m_dirtyNodes.empty()) {
+    return;
+  }
+
+  // Parents come first, so a dirty node may already be covered by the subtree
+  // of an earlier one.
+  std::sort(m_dirtyNodes.begin(), m_dirtyNodes.end());
+  UpdateLocalMatrices();
+
+  std::uint32_t updatedEnd = 0;
+
+  for (std::uint32_t dirty : m_dirtyNodes) {
+    if (dirty < updatedEnd) {
+      continue;
+    }
+
+    updatedEnd = dirty + m_subtreeSizes[dirty];
+
+    for (std::uint32_t i = dirty; i < updatedEnd; ++i) {
+      TransformComponent& transform = GetTransform(m_nodes[i]);
+      std::int32_t parent = m_parents[i];
+
+      glm::mat4 world = parent != NoParent
+                            ? m_worldMatrices[parent] *
+                                  transform.GetLocalMatrix()
+                            : transform.GetLocalMatrix();
+      transform.m_worldDirty = false;
+
+      if (m_motion[i] == MotionState::Snap) {
+        m_previousWorldMatrices[i] = world;
+        m_renderMatrices[i] = world;
+        m_motion[i] = MotionState::Static;
+      } else {
+        m_previousWorldMatrices[i] = m_worldMatrices[i];
+        m_motion[i] = MotionState::Moved;
+        ++m_movedCount;
+      }
+      m_worldMatrices[i] = world;
+      m_changedNodes.push_back(i);
+    }
+  }
+
+  m_dirtyNodes.clear();
+}
+
+void TransformHierarchy::Interpolate(float alpha) {
+  if (m_movedCount == 0) {
+    return;
+  }
+
+  for (std::size_t i = 0; i < m_nodes.size(); ++i) {
+    if (m_motion[i] == MotionState::Moved) {
+      m_renderMatrices[i] = InterpolateMatrix(m_previousWorldMatrices[i],
+                                              m_worldMatrices[i], alpha);
+    }
+  }
+}
+
+void TransformHierarchy::UpdateLocalMatrices() {
+  LocalBatch& batch = m_localBatch;
+  batch.transforms.clear();
+
+  std::uint32_t gatheredEnd = 0;
+  for (std::uint32_t dirty : m_dirtyNodes) {
+    std::uint32_t end = dirty + m_subtreeSizes[dirty];
+
+    for (std::uint32_t i = std::max(dirty, gatheredEnd); i < end; ++i) {
+      TransformComponent& transform = GetTransform(m_nodes[i]);
+      if (transform.m_localDirty) {
+        batch.transforms.push_back(&transform);
+      }
+    }
+
+    gatheredEnd = std::max(gatheredEnd, end);
+  }
+
+  std::size_t count = batch.transforms.size();
+  if (count == 0) {
+    return;
+  }
+
+  for (auto* values :
+       {&batch.positionX, &batch.positionY, &batch.positionZ, &batch.rotationX,
+        &batch.rotationY, &batch.rotationZ, &batch.rotationW, &batch.scaleX,
+        &batch.scaleY, &batch.scaleZ}) {
+    values->resize(count);
+  }
+  batch.matrices.resize(count);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const TransformComponent& transform = *batch.transforms[i];
+    batch.positionX[i] = transform.m_position.x;
+    batch.positionY[i] = transform.m_position.y;
+    batch.positionZ[i] = transform.m_position.z;
+    batch.rotationX[i] = transform.m_rotation.x;
+    batch.rotationY[i] = transform.m_rotation.y;
+    batch.rotationZ[i] = transform.m_rotation.z;
+    batch.rotationW[i] = transform.m_rotation.w;
+    batch.scaleX[i] = transform.m_scale.x;
+    batch.scaleY[i] = transform.m_scale.y;
+    batch.scaleZ[i] = transform.m_scale.z;
+  }
+
+  TransformSoA input{batch.positionX.data(), batch.positionY.data(),
+                     batch.positionZ.data(), batch.rotationX.data(),
+                     batch.rotationY.data(), batch.rotationZ.data(),
+                     batch.rotationW.data(), batch.scaleX.data(),
+                     batch.scaleY.data(),    batch.scaleZ.data()};
+  ComputeTransformMatrices(input, count, batch.matrices.data());
+
+  for (std::size_t i = 0; i < count; ++i) {
+    batch.transforms[i]->m_localMatrix = batch.matrices[i];
+    batch.transforms[i]->m_localDirty = false;
+  }
+}
+
+void TransformHierarchy::MoveBlock(std::uint32_t first, std::uint32_t count,
+                                   std::uint32_t position) {
+  RotateBlock(m_nodes, first, count, position);
+  RotateBlock(m_parents, first, count, position);
+  RotateBlock(m_subtreeSizes, first, count, position);
+  RotateBlock(m_worldMatrices, first, count, position);
+  RotateBlock(m_previousWorldMatrices, first, count, position);
+  RotateBlock(m_renderMatrices, first, count, position);
+  RotateBlock(m_motion, first, count, position);
+}
+
+void TransformHierarchy::Reindex() {
+  m_dirtyNodes.clear();
+
+  std::vector<std::uint32_t> ancestors;
+  for (std::uint32_t i = 0; i < m_nodes.size(); ++i) {
+    while (!ancestors.empty() &&
+           i >= ancestors.back() + m_subtreeSizes[ancestors.back()]) {
+      ancestors.pop_back();
+    }
+
+    m_parents[i] = ancestors.empty()
+                       ? NoParent
+                       : static_cast<std::int32_t>(ancestors.back());
+    ancestors.push_back(i);
+
+    TransformComponent& transform = GetTransform(m_nodes[i]);
+    transform.m_hierarchyIndex = i;
+
+    if (transform.m_worldDirty) {
+      m_dirtyNodes.push_back(i);
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#include "core/TransformKernel.h"
+
+#include "core/TransformKernelImpl.h"
+
+namespace {
+
+TransformKernelLevel SelectLevel() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+
+  if (GetTransformKernelAvx2() != nullptr && __builtin_cpu_supports("avx2")) {
+    return TransformKernelLevel::Avx2;
+  }
+
+  if (GetTransformKernelSse42() != nullptr &&
+      __builtin_cpu_supports("sse4.2")) {
+    return TransformKernelLevel::Sse42;
+  }
+#endif
+
+  return TransformKernelLevel::Scalar;
+}
+
+TransformKernelFn SelectKernel(TransformKernelLevel level) {
+  switch (level) {
+    case TransformKernelLevel::Avx2:
+      return GetTransformKernelAvx2();
+    case TransformKernelLevel::Sse42:
+      return GetTransformKernelSse42();
+    case TransformKernelLevel::Scalar:
+      break;
+  }
+
+  return GetTransformKernelScalar();
+}
+
+}  // namespace
+
+void ComputeTransformMatrices(const TransformSoA& input, std::size_t count,
+                              glm::mat4* output) {
+  static const TransformKernelFn kernel =
+      SelectKernel(GetTransformKernelLevel());
+  kernel(input, count, output);
+}
+
+TransformKernelFn GetTransformKernelScalar() {
+  return &ComputeTransformMatricesWith<ScalarLanes>;
+}
+
+TransformKernelLevel GetTransformKernelLevel() {
+  static const TransformKernelLevel level = SelectLevel();
+  return level;
+}
@@ -0,0 +1,36 @@
+// Built with -mavx2 (see CMakeLists.txt); only called after a CPUID check.
+#include "core/TransformKernel.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#include "core/TransformKernelImpl.h"
+
+namespace {
+
+struct Avx2Lanes {
+  using Reg = __m256;
+  static constexpr std::size_t Width = 8;
+
+  static Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+  static void Store(float* p, Reg v) { _mm256_storeu_ps(p, v); }
+  static Reg Set(float v) { return _mm256_set1_ps(v); }
+  static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+  static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+  static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+};
+
+}  // namespace
+
+TransformKernelFn GetTransformKernelAvx2() {
+  return &ComputeTransformMatricesWith<Avx2Lanes>;
+}
+
+#else
+
+TransformKernelFn GetTransformKernelAvx2() {
+  return nullptr;
+}
+
+#endif
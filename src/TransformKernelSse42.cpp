@@ -0,0 +1,36 @@
+// Built with -msse4.2 (see CMakeLists.txt); only called after a CPUID check.
+#include "core/TransformKernel.h"
+
+#if defined(__SSE4_2__)
+
+#include <nmmintrin.h>
+
+#include "core/TransformKernelImpl.h"
+
+namespace {
+
+struct Sse42Lanes {
+  using Reg = __m128;
+  static constexpr std::size_t Width = 4;
+
+  static Reg Load(const float* p) { return _mm_loadu_ps(p); }
+  static void Store(float* p, Reg v) { _mm_storeu_ps(p, v); }
+  static Reg Set(float v) { return _mm_set1_ps(v); }
+  static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+  static Reg Sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+  static Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+};
+
+}  // namespace
+
+TransformKernelFn GetTransformKernelSse42() {
+  return &ComputeTransformMatricesWith<Sse42Lanes>;
+}
+
+#else
+
+TransformKernelFn GetTransformKernelSse42() {
+  return nullptr;
+}
+
+#endif
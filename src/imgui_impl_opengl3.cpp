@@ -241,6 +241,7 @@ struct ImGui_ImplOpenGL3_Data
     bool            HasPolygonMode;
     bool            HasClipOrigin;
     bool            UseBufferSubData;
+    ImGui_ImplOpenGL3_StreamAllocator StreamAllocator; // [1158Engine]
 
     ImGui_ImplOpenGL3_Data() { memset((void*)this, 0, sizeof(*this)); }
 };
@@ -419,6 +420,24 @@ void    ImGui_ImplOpenGL3_NewFrame()
         ImGui_ImplOpenGL3_CreateFontsTexture();
 }
 
+// [1158Engine]
+void    ImGui_ImplOpenGL3_SetStreamAllocator(ImGui_ImplOpenGL3_StreamAllocator allocator)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    bd->StreamAllocator = allocator;
+}
+
+// [1158Engine] Points the ImDrawVert attributes at vertices starting 'vtx_offset' bytes into 'vbo'
+static void ImGui_ImplOpenGL3_BindVertexBuffers(ImGui_ImplOpenGL3_Data* bd, GLuint vbo, GLuint ebo, size_t vtx_offset)
+{
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
+    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + offsetof(ImDrawVert, pos))));
+    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + offsetof(ImDrawVert, uv))));
+    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)(vtx_offset + offsetof(ImDrawVert, col))));
+}
+
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
 {
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
@@ -559,6 +578,7 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
     // Render command lists
+    bool bound_stream = false; // [1158Engine] Streaming buffer bound instead of VboHandle/ElementsHandle
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* draw_list = draw_data->CmdLists[n];
@@ -573,7 +593,26 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
         // - See https://github.com/ocornut/imgui/issues/4468 and please report any corruption issues.
         const GLsizeiptr vtx_buffer_size = (GLsizeiptr)draw_list->VtxBuffer.Size * (int)sizeof(ImDrawVert);
         const GLsizeiptr idx_buffer_size = (GLsizeiptr)draw_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx);
-        if (bd->UseBufferSubData)
+        // [1158Engine] Write into the application's streaming buffer when it provides one
+        ImGui_ImplOpenGL3_StreamAllocation vtx_stream = {}, idx_stream = {};
+        const bool streamed = bd->StreamAllocator != nullptr
+            && bd->StreamAllocator((size_t)vtx_buffer_size, &vtx_stream)
+            && bd->StreamAllocator((size_t)idx_buffer_size, &idx_stream);
+        const size_t idx_stream_offset = streamed ? idx_stream.Offset : 0;
+        if (!streamed && bound_stream)
+        {
+            // A previous list left the streaming buffer bound; uploading would replace it
+            ImGui_ImplOpenGL3_BindVertexBuffers(bd, bd->VboHandle, bd->ElementsHandle, 0);
+            bound_stream = false;
+        }
+        if (streamed)
+        {
+            memcpy(vtx_stream.Data, draw_list->VtxBuffer.Data, (size_t)vtx_buffer_size);
+            memcpy(idx_stream.Data, draw_list->IdxBuffer.Data, (size_t)idx_buffer_size);
+            ImGui_ImplOpenGL3_BindVertexBuffers(bd, vtx_stream.Buffer, idx_stream.Buffer, vtx_stream.Offset);
+            bound_stream = true;
+        }
+        else if (bd->UseBufferSubData)
         {
             if (bd->VertexBufferSize < vtx_buffer_size)
             {
@@ -602,7 +641,12 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                {
                     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
+                    if (streamed)
+                        ImGui_ImplOpenGL3_BindVertexBuffers(bd, vtx_stream.Buffer, idx_stream.Buffer, vtx_stream.Offset);
+                    bound_stream = streamed;
+                }
                 else
                     pcmd->UserCallback(draw_list, pcmd);
             }
@@ -621,10 +665,10 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 GL_CALL(glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->GetTexID()));
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
                 if (bd->GlVersion >= 320)
-                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset));
+                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(idx_stream_offset + pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset));
                 else
 #endif
-                GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx))));
+                GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(idx_stream_offset + pcmd->IdxOffset * sizeof(ImDrawIdx))));
             }
         }
     }
@@ -0,0 +1,112 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "GameObject.h"
+#include "LightComponent.h"
+#include "Scene.h"
+#include "Test.h"
+#include "core/EntityCommandBuffer.h"
+
+namespace {
+
+/** Names of the scene's objects owning a LightComponent. */
+std::vector<std::string> LitObjects(const Scene& scene) {
+  std::vector<std::string> names;
+  for (GameObject* gameObject : scene.GetGameObjects()) {
+    if (gameObject->GetComponent<LightComponent>() != nullptr) {
+      names.push_back(gameObject->GetName());
+    }
+  }
+  return names;
+}
+
+// Commands for a pending entity reach the object created by the same flush.
+void TestPendingEntity() {
+  Scene scene;
+  EntityCommandBuffer& commands = scene.GetCommandBuffer();
+
+  commands.Create("A");
+  const PendingEntity b = commands.Create("B");
+  commands.AddComponent<LightComponent>(b);
+  CHECK_EQUAL(scene.GetGameObjects().size(), 0u);
+
+  scene.Update(0.0f);
+  CHECK_EQUAL(scene.GetGameObjects().size(), 2u);
+  CHECK(LitObjects(scene) == std::vector<std::string>{"B"});
+}
+
+// A pending entity kept past its flush neither aliases an object of the
+// next batch with the same id nor indexes past the smaller batch.
+void TestExpiredPendingEntity() {
+  Scene scene;
+  EntityCommandBuffer& commands = scene.GetCommandBuffer();
+
+  const PendingEntity first = commands.Create("First");
+  commands.Create("Second");
+  const PendingEntity third = commands.Create("Third");
+  scene.Update(0.0f);
+
+  commands.Create("Fourth");
+  commands.AddComponent<LightComponent>(first);
+  commands.AddComponent<LightComponent>(third);
+  commands.AddComponent<LightComponent>(PendingEntity{});
+  scene.Update(0.0f);
+
+  CHECK_EQUAL(scene.GetGameObjects().size(), 4u);
+  CHECK(LitObjects(scene).empty());
+  CHECK(commands.IsEmpty());
+}
+
+// Initializers run during the flush: commands they record go to the next
+// batch, where pending entities of the current one have expired. Handles
+// stay valid.
+void TestRecordDuringFlush() {
+  Scene scene;
+  EntityCommandBuffer& commands = scene.GetCommandBuffer();
+
+  PendingEntity b;
+  commands.Create("A", [&commands, &b](GameObject& gameObject) {
+    commands.AddComponent<LightComponent>(b);
+    commands.AddComponent<LightComponent>(gameObject.GetHandle());
+  });
+  b = commands.Create("B");
+
+  scene.Update(0.0f);
+  CHECK(LitObjects(scene).empty());
+  CHECK(!commands.IsEmpty());
+
+  scene.Update(0.0f);
+  CHECK(LitObjects(scene) == std::vector<std::string>{"A"});
+  CHECK(commands.IsEmpty());
+}
+
+// Destructions run after the rest of the batch, whatever their order.
+void TestDestroyAppliedLast() {
+  Scene scene;
+  EntityCommandBuffer& commands = scene.GetCommandBuffer();
+
+  commands.Create("A");
+  scene.Update(0.0f);
+  const EntityHandle a = scene.GetGameObjects()[0]->GetHandle();
+
+  commands.Destroy(a);
+  commands.AddComponent<LightComponent>(a);
+  scene.Update(0.0f);
+  CHECK_EQUAL(scene.GetGameObjects().size(), 0u);
+  CHECK(scene.GetGameObject(a) == nullptr);
+
+  // The handle is stale now, so the command is dropped.
+  commands.AddComponent<LightComponent>(a);
+  scene.Update(0.0f);
+  CHECK(commands.IsEmpty());
+}
+
+}  // namespace
+
+int main() {
+  TestPendingEntity();
+  TestExpiredPendingEntity();
+  TestRecordDuringFlush();
+  TestDestroyAppliedLast();
+  return test::Result();
+}
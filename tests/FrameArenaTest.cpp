@@ -0,0 +1,112 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Test.h"
+#include "core/AllocationCounter.h"
+#include "core/FrameArena.h"
+
+// The frame arena's promise: once both arenas have grown to the peak of the
+// workload, a frame costs no heap allocation at all, which the global
+// allocation counter sees as well.
+
+namespace {
+
+/**
+ * One frame of transient data, in the shape the renderer and the editor use:
+ * formatted labels, a scratch array and an arena-backed vector.
+ */
+void UseFrame(FrameArena& arena, std::uint32_t frame, std::size_t items) {
+  for (std::uint32_t i = 0; i < items; ++i) {
+    const char* label = arena.Format("Object%u##%u", frame, i);
+    CHECK(label[0] == 'O');
+  }
+
+  float* scratch = arena.AllocateArray<float>(items * 16);
+  scratch[items * 16 - 1] = 1.0f;
+
+  ArenaVector<std::uint32_t> indices{ArenaAllocator<std::uint32_t>(arena)};
+  indices.reserve(items);
+  for (std::uint32_t i = 0; i < items; ++i) {
+    indices.push_back(i);
+  }
+  CHECK_EQUAL(indices.size(), items);
+}
+
+// A workload overflowing the initial capacity allocates while both arenas
+// grow, then never again.
+void TestSteadyStateAllocatesNothing() {
+  FrameArena arena(1024);
+  constexpr std::size_t Items = 500;
+
+  // Each arena overflows on its first frame and grows at its next reset.
+  for (std::uint32_t frame = 0; frame < 4; ++frame) {
+    arena.BeginFrame();
+    UseFrame(arena, frame, Items);
+  }
+  CHECK(arena.GetCurrentArena().GetCapacity() >
+        arena.GetCurrentArena().GetUsed());
+
+  const std::uint64_t arenaAllocations = arena.GetHeapAllocationCount();
+  const std::uint64_t heapAllocations = GetHeapAllocationCount();
+  for (std::uint32_t frame = 4; frame < 104; ++frame) {
+    arena.BeginFrame();
+    UseFrame(arena, frame, Items);
+  }
+  CHECK_EQUAL(arena.GetHeapAllocationCount(), arenaAllocations);
+  CHECK_EQUAL(GetHeapAllocationCount(), heapAllocations);
+
+  // A spike overflows again, and the larger workload settles the same way.
+  arena.BeginFrame();
+  UseFrame(arena, 104, 4 * Items);
+  CHECK(arena.GetHeapAllocationCount() > arenaAllocations);
+  CHECK(GetHeapAllocationCount() > heapAllocations);
+
+  for (std::uint32_t frame = 105; frame < 109; ++frame) {
+    arena.BeginFrame();
+    UseFrame(arena, frame, 4 * Items);
+  }
+  const std::uint64_t grownAllocations = arena.GetHeapAllocationCount();
+  const std::uint64_t grownHeapAllocations = GetHeapAllocationCount();
+  for (std::uint32_t frame = 109; frame < 209; ++frame) {
+    arena.BeginFrame();
+    UseFrame(arena, frame, frame % 2 == 0 ? 4 * Items : Items);
+  }
+  CHECK_EQUAL(arena.GetHeapAllocationCount(), grownAllocations);
+  CHECK_EQUAL(GetHeapAllocationCount(), grownHeapAllocations);
+}
+
+// Data built during a frame is still intact while the next frame allocates.
+void TestPreviousFrameSurvives() {
+  FrameArena arena(256);
+
+  arena.BeginFrame();
+  const char* previous = arena.Format("frame %d", 1);
+
+  arena.BeginFrame();
+  for (int i = 0; i < 100; ++i) {
+    arena.Format("overwrite %d", i);
+  }
+  CHECK(std::strcmp(previous, "frame 1") == 0);
+}
+
+// Alignments are honoured inside the block and in overflow allocations.
+void TestAlignment() {
+  FrameArena arena(128);
+  arena.BeginFrame();
+
+  for (std::size_t alignment : {1u, 4u, 16u, 64u, 256u}) {
+    for (int i = 0; i < 4; ++i) {
+      const void* memory = arena.Allocate(40, alignment);
+      CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(memory) % alignment, 0u);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestSteadyStateAllocatesNothing();
+  TestPreviousFrameSurvives();
+  TestAlignment();
+  return test::Result();
+}
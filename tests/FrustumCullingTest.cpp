@@ -0,0 +1,182 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Test.h"
+#include "core/Bounds.h"
+#include "core/FrustumCulling.h"
+
+// CullSpheres() runs four spheres per SSE iteration and the rest through a
+// scalar tail; both must agree with a plain per-sphere plane test, whatever
+// the count and the alignment of the arrays.
+
+namespace {
+
+/**
+ * Spheres stored one float past the start of their arrays, so the SSE path
+ * loads from unaligned addresses.
+ */
+struct SphereArrays {
+  explicit SphereArrays(std::size_t count)
+      : x(count + 1), y(count + 1), z(count + 1), radius(count + 1) {}
+
+  void Set(std::size_t i, const glm::vec3& center, float sphereRadius) {
+    x[i + 1] = center.x;
+    y[i + 1] = center.y;
+    z[i + 1] = center.z;
+    radius[i + 1] = sphereRadius;
+  }
+
+  [[nodiscard]] SphereSoA View() const {
+    return {x.data() + 1, y.data() + 1, z.data() + 1, radius.data() + 1};
+  }
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> radius;
+};
+
+/** The per-sphere test CullSpheres() vectorizes. */
+bool IsSphereVisible(const Frustum& frustum, const glm::vec3& center,
+                     float radius) {
+  for (const glm::vec4& plane : frustum.planes) {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Whether rounding may decide the sphere's test either way. */
+bool OnFrustumBoundary(const Frustum& frustum, const glm::vec3& center,
+                       float radius) {
+  for (const glm::vec4& plane : frustum.planes) {
+    const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+    if (std::abs(distance + radius) < 1e-4f) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Aabb BoundsOf(const glm::vec3& center, float radius) {
+  Aabb box;
+  box.Expand(center - glm::vec3(radius));
+  box.Expand(center + glm::vec3(radius));
+  return box;
+}
+
+/**
+ * Culls the spheres and checks every flag against `expected`, and that the
+ * byte after the last one is left alone.
+ */
+void CheckCull(const Frustum& frustum, const SphereArrays& spheres,
+               const std::vector<std::uint8_t>& expected) {
+  const std::size_t count = expected.size();
+  std::vector<std::uint8_t> visible(count + 1, 0xAB);
+
+  const std::size_t visibleCount =
+      CullSpheres(frustum, spheres.View(), count, visible.data());
+
+  std::size_t expectedCount = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    CHECK_EQUAL(visible[i], expected[i]);
+    expectedCount += expected[i];
+  }
+  CHECK_EQUAL(visibleCount, expectedCount);
+  CHECK_EQUAL(visible[count], 0xAB);
+}
+
+// Random spheres around a perspective frustum, at every count from the
+// empty and tail-only cases to many SIMD groups plus a tail.
+void TestMatchesScalar() {
+  const Frustum frustum = Frustum::FromMatrix(
+      glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+      glm::lookAt(glm::vec3(10.0f, 5.0f, 40.0f), glm::vec3(0.0f),
+                  glm::vec3(0.0f, 1.0f, 0.0f)));
+
+  std::mt19937 generator(1158);
+  std::uniform_real_distribution<float> position(-80.0f, 80.0f);
+  std::uniform_real_distribution<float> radius(0.0f, 5.0f);
+
+  for (std::size_t count : {0u, 1u, 3u, 4u, 5u, 1003u}) {
+    SphereArrays spheres(count);
+    std::vector<std::uint8_t> expected(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      glm::vec3 center;
+      float sphereRadius = 0.0f;
+      do {
+        center = glm::vec3(position(generator), position(generator),
+                           position(generator));
+        sphereRadius = radius(generator);
+      } while (OnFrustumBoundary(frustum, center, sphereRadius));
+
+      spheres.Set(i, center, sphereRadius);
+      expected[i] = IsSphereVisible(frustum, center, sphereRadius) ? 1 : 0;
+
+      // The box around a visible sphere is never culled.
+      if (expected[i] != 0) {
+        CHECK(frustum.Overlaps(BoundsOf(center, sphereRadius)));
+      }
+    }
+
+    CheckCull(frustum, spheres, expected);
+  }
+}
+
+// A box-shaped frustum, |x|, |y| <= 10 and 1 <= z <= 50, where plane
+// distances are exact: spheres exactly touching a plane from outside are
+// visible, as Classify() sees their boxes, and spheres just beyond are not.
+void TestTouchingPlanes() {
+  Frustum frustum;
+  frustum.planes = {glm::vec4(1.0f, 0.0f, 0.0f, 10.0f),
+                    glm::vec4(-1.0f, 0.0f, 0.0f, 10.0f),
+                    glm::vec4(0.0f, 1.0f, 0.0f, 10.0f),
+                    glm::vec4(0.0f, -1.0f, 0.0f, 10.0f),
+                    glm::vec4(0.0f, 0.0f, 1.0f, -1.0f),
+                    glm::vec4(0.0f, 0.0f, -1.0f, 50.0f)};
+
+  const glm::vec3 inside(0.0f, 0.0f, 20.0f);
+  const float limits[3][2] = {{-10.0f, 10.0f}, {-10.0f, 10.0f}, {1.0f, 50.0f}};
+
+  for (std::size_t count : {1u, 3u, 4u, 5u, 1003u}) {
+    SphereArrays spheres(count);
+    std::vector<std::uint8_t> expected(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      // Cycle through the six planes, touching then missing each one.
+      const std::size_t axis = i % 3;
+      const std::size_t side = (i / 3) % 2;
+      const bool touching = (i / 6) % 2 == 0;
+      const float radius = 0.5f * static_cast<float>(1 + i % 4);
+      const float offset = touching ? radius : radius + 0.25f;
+      const float limit = limits[axis][side];
+
+      glm::vec3 center = inside;
+      center[static_cast<int>(axis)] =
+          side == 0 ? limit - offset : limit + offset;
+
+      spheres.Set(i, center, radius);
+      expected[i] = touching ? 1 : 0;
+      CHECK_EQUAL(frustum.Overlaps(BoundsOf(center, radius)), touching);
+      CHECK_EQUAL(
+          frustum.Classify(BoundsOf(center, radius)) == Containment::Outside,
+          !touching);
+    }
+
+    CheckCull(frustum, spheres, expected);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestMatchesScalar();
+  TestTouchingPlanes();
+  return test::Result();
+}
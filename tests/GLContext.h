@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstdio>
+
+/**
+ * OpenGL context of the tests that need a GPU.
+ *
+ * The context is created through EGL without a window or surface, so the
+ * tests run headless, e.g. on Mesa's software rasterizer. Where no driver
+ * provides OpenGL 4.5 core, main() returns test::SkipCode and CTest reports
+ * the test as skipped.
+ */
+namespace test {
+
+/**Exit code CTest treats as a skipped test, see SKIP_RETURN_CODE. */
+constexpr int SkipCode = 77;
+
+class GLContext {
+ public:
+  GLContext() {
+    const auto getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay != nullptr) {
+      m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                     EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (m_display == EGL_NO_DISPLAY) {
+      m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (m_display == EGL_NO_DISPLAY ||
+        eglInitialize(m_display, nullptr, nullptr) == EGL_FALSE ||
+        eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+      std::printf("No EGL display\n");
+      return;
+    }
+
+    const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                        4,
+                                        EGL_CONTEXT_MINOR_VERSION,
+                                        5,
+                                        EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                        EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                        EGL_NONE};
+    m_context = eglCreateContext(m_display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+                                 contextAttributes);
+    if (m_context == EGL_NO_CONTEXT ||
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       m_context) == EGL_FALSE) {
+      std::printf("No OpenGL 4.5 core context\n");
+      return;
+    }
+
+    if (gladLoadGLLoader(
+            reinterpret_cast<GLADloadproc>(eglGetProcAddress)) == 0) {
+      std::printf("Failed to load OpenGL functions\n");
+      return;
+    }
+
+    std::printf("%s, OpenGL %s\n",
+                reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+                reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    m_valid = true;
+  }
+
+  ~GLContext() {
+    if (m_context != EGL_NO_CONTEXT) {
+      eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     EGL_NO_CONTEXT);
+      eglDestroyContext(m_display, m_context);
+    }
+    if (m_display != EGL_NO_DISPLAY) {
+      eglTerminate(m_display);
+    }
+  }
+
+  GLContext(const GLContext&) = delete;
+  GLContext& operator=(const GLContext&) = delete;
+
+  /**Whether the context is current and its functions are loaded. */
+  [[nodiscard]] bool IsValid() const { return m_valid; }
+
+ private:
+  EGLDisplay m_display{EGL_NO_DISPLAY};
+  EGLContext m_context{EGL_NO_CONTEXT};
+  bool m_valid{false};
+};
+
+}  // namespace test
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "GLContext.h"
+#include "GpuCuller.h"
+#include "ShaderManager.h"
+#include "Test.h"
+#include "core/Bounds.h"
+#include "core/MeshBuffer.h"
+#include "core/StreamingBuffer.h"
+
+// The compute culling pass against the CPU's frustum test, its occlusion test
+// against a known depth buffer, and the vertex attribute through which the
+// draws read its output. Runs from the source directory, where the shaders
+// are.
+
+namespace {
+
+/** Visible instances of each command, sorted. */
+using DrawLists = std::vector<std::vector<std::uint32_t>>;
+
+/**
+ * Culls `bounds` into `drawCount` commands the way Renderer::Submit() does
+ * and reads the visible-instance lists back.
+ */
+DrawLists CullOnGpu(GpuCuller& culler, const glm::mat4& viewProjection,
+                    const std::vector<InstanceBounds>& bounds,
+                    std::size_t drawCount) {
+  std::vector<DrawElementsIndirectCommand> commands(drawCount);
+  for (const InstanceBounds& box : bounds) {
+    ++commands[box.draw].baseInstance;
+  }
+  GLuint firstSlot = 0;
+  for (DrawElementsIndirectCommand& command : commands) {
+    const GLuint size = command.baseInstance;
+    command.baseInstance = firstSlot;
+    firstSlot += size;
+  }
+
+  StreamingBuffer::BeginFrame();
+  const std::size_t alignment = StreamingBuffer::GetStorageAlignment();
+  const StreamAllocation commandRange = StreamingBuffer::Upload(
+      commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand),
+      alignment);
+  const StreamAllocation visibleRange =
+      StreamingBuffer::Allocate(bounds.size() * sizeof(GLuint), alignment);
+
+  culler.Cull(viewProjection, bounds.data(), bounds.size(), commandRange,
+              visibleRange);
+
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  std::vector<GLuint> visible(bounds.size());
+  glGetNamedBufferSubData(commandRange.buffer, commandRange.offset,
+                          commandRange.size, commands.data());
+  glGetNamedBufferSubData(visibleRange.buffer, visibleRange.offset,
+                          visibleRange.size, visible.data());
+  StreamingBuffer::EndFrame();
+
+  DrawLists lists(drawCount);
+  for (std::size_t draw = 0; draw < drawCount; ++draw) {
+    const auto first = visible.begin() + commands[draw].baseInstance;
+    lists[draw].assign(first, first + commands[draw].instanceCount);
+    std::sort(lists[draw].begin(), lists[draw].end());
+  }
+  return lists;
+}
+
+Aabb ToAabb(const InstanceBounds& box) {
+  Aabb aabb;
+  aabb.Expand(box.center - box.extents);
+  aabb.Expand(box.center + box.extents);
+  return aabb;
+}
+
+/** Whether rounding may decide the box's frustum test either way. */
+bool OnFrustumBoundary(const Frustum& frustum, const InstanceBounds& box) {
+  for (const glm::vec4& plane : frustum.planes) {
+    const glm::vec3 normal(plane);
+    const float distance = glm::dot(normal, box.center) + plane.w;
+    const float radius = glm::dot(glm::abs(normal), box.extents);
+    if (std::abs(distance + radius) < 1e-3f) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Random boxes in 7 commands give the same visible set on both sides.
+void TestFrustumMatchesCpu(GpuCuller& culler) {
+  constexpr std::size_t InstanceCount = 20000;
+  constexpr std::size_t DrawCount = 7;
+
+  std::mt19937 generator(1158);
+  std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> extent(0.1f, 2.0f);
+  std::uniform_int_distribution<std::uint32_t> draw(0, DrawCount - 1);
+
+  std::vector<InstanceBounds> bounds(InstanceCount);
+  for (InstanceBounds& box : bounds) {
+    box.center = glm::vec3(position(generator), position(generator),
+                           position(generator));
+    box.draw = draw(generator);
+    box.extents =
+        glm::vec3(extent(generator), extent(generator), extent(generator));
+  }
+
+  const glm::mat4 viewProjection =
+      glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) *
+      glm::lookAt(glm::vec3(10.0f, 5.0f, 40.0f), glm::vec3(0.0f),
+                  glm::vec3(0.0f, 1.0f, 0.0f));
+  const Frustum frustum = Frustum::FromMatrix(viewProjection);
+
+  culler.InvalidateDepthPyramid();
+  DrawLists gpu = CullOnGpu(culler, viewProjection, bounds, DrawCount);
+
+  DrawLists cpu(DrawCount);
+  std::size_t visibleCount = 0;
+  for (std::uint32_t i = 0; i < InstanceCount; ++i) {
+    if (OnFrustumBoundary(frustum, bounds[i])) {
+      for (std::vector<std::uint32_t>& list : gpu) {
+        list.erase(std::remove(list.begin(), list.end(), i), list.end());
+      }
+    } else if (frustum.Overlaps(ToAabb(bounds[i]))) {
+      cpu[bounds[i].draw].push_back(i);
+      ++visibleCount;
+    }
+  }
+
+  std::printf("%zu of %zu instances visible\n", visibleCount, InstanceCount);
+  CHECK(visibleCount > 0 && visibleCount < InstanceCount);
+  for (std::size_t i = 0; i < DrawCount; ++i) {
+    CHECK(gpu[i] == cpu[i]);
+  }
+}
+
+// A wall 10 units in front of the previous camera, covering the middle half
+// of its view, is drawn into a depth buffer the pyramid is built from. The
+// current camera has moved 4 units to the right since.
+void TestOcclusion(GpuCuller& culler) {
+  constexpr int Size = 256;
+  const glm::mat4 projection =
+      glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+  const glm::vec3 up(0.0f, 1.0f, 0.0f);
+  const glm::mat4 previous =
+      projection * glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                               up);
+  const glm::mat4 current =
+      projection * glm::lookAt(glm::vec3(4.0f, 0.0f, 0.0f),
+                               glm::vec3(4.0f, 0.0f, -1.0f), up);
+
+  GLuint framebuffer = 0;
+  GLuint depth = 0;
+  glCreateFramebuffers(1, &framebuffer);
+  glCreateRenderbuffers(1, &depth);
+  glNamedRenderbufferStorage(depth, GL_DEPTH24_STENCIL8, Size, Size);
+  glNamedFramebufferRenderbuffer(framebuffer, GL_DEPTH_STENCIL_ATTACHMENT,
+                                 GL_RENDERBUFFER, depth);
+
+  const glm::vec4 wallClip = previous * glm::vec4(0.0f, 0.0f, -10.0f, 1.0f);
+  const float wallDepth = wallClip.z / wallClip.w * 0.5f + 0.5f;
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glClearDepth(1.0);
+  glClear(GL_DEPTH_BUFFER_BIT);
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(Size / 4, Size / 4, Size / 2, Size / 2);
+  glClearDepth(wallDepth);
+  glClear(GL_DEPTH_BUFFER_BIT);
+  glDisable(GL_SCISSOR_TEST);
+  glClearDepth(1.0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  culler.UpdateDepthPyramid(framebuffer, Size, Size, previous);
+
+  const std::vector<InstanceBounds> bounds{
+      // Behind the wall from both cameras.
+      {glm::vec3(0.0f, 0.0f, -20.0f), 0, glm::vec3(1.0f)},
+      // In front of the wall.
+      {glm::vec3(2.0f, 0.0f, -5.0f), 0, glm::vec3(0.5f)},
+      // Beside the wall.
+      {glm::vec3(15.0f, 0.0f, -20.0f), 0, glm::vec3(1.0f)},
+      // Beside the wall from the previous camera, but projected onto it by
+      // the current one: only its depth is unknown.
+      {glm::vec3(12.0f, 0.0f, -20.0f), 0, glm::vec3(0.5f)},
+  };
+
+  CHECK(CullOnGpu(culler, current, bounds, 1)[0] ==
+        (std::vector<std::uint32_t>{1, 2, 3}));
+
+  culler.InvalidateDepthPyramid();
+  CHECK(CullOnGpu(culler, current, bounds, 1)[0] ==
+        (std::vector<std::uint32_t>{0, 1, 2, 3}));
+
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteRenderbuffers(1, &depth);
+}
+
+GLuint CompileShader(GLenum type, const std::string& source) {
+  const GLuint shader = glCreateShader(type);
+  const char* code = source.c_str();
+  glShaderSource(shader, 1, &code, nullptr);
+  glCompileShader(shader);
+
+  GLint success = 0;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (success == 0) {
+    char log[512];
+    glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+    std::printf("%s\n", log);
+  }
+  CHECK(success != 0);
+  return shader;
+}
+
+// The scene's vertex shader builds without OpenGL 4.6.
+void TestSceneShaderCompiles() {
+  std::ifstream file("shaders/basic_instanced.vert");
+  std::stringstream source;
+  source << file.rdbuf();
+  CHECK(!source.str().empty());
+  glDeleteShader(CompileShader(GL_VERTEX_SHADER, source.str()));
+}
+
+// Two commands of one multi-draw find their own instances in the list
+// through baseInstance: each instance is drawn as a point at the pixel of
+// its index.
+void TestInstanceIndices(ShaderManager& shaderManager) {
+  constexpr int Width = 16;
+
+  const GLuint program = glCreateProgram();
+  const GLuint vertex = CompileShader(GL_VERTEX_SHADER, R"(#version 430 core
+layout (location = 3) in uint aInstance;
+flat out uint instance;
+void main()
+{
+	instance = aInstance;
+	gl_Position = vec4((float(aInstance) + 0.5) / 8.0 - 1.0, 0.0, 0.0, 1.0);
+}
+)");
+  const GLuint fragment = CompileShader(GL_FRAGMENT_SHADER, R"(#version 430 core
+flat in uint instance;
+layout (location = 0) out uint color;
+void main()
+{
+	color = instance + 1u;
+}
+)");
+  glAttachShader(program, vertex);
+  glAttachShader(program, fragment);
+  glLinkProgram(program);
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+
+  GLuint framebuffer = 0;
+  GLuint color = 0;
+  glCreateFramebuffers(1, &framebuffer);
+  glCreateRenderbuffers(1, &color);
+  glNamedRenderbufferStorage(color, GL_R32UI, Width, 1);
+  glNamedFramebufferRenderbuffer(framebuffer, GL_COLOR_ATTACHMENT0,
+                                 GL_RENDERBUFFER, color);
+
+  const float vertices[] = {0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1,
+                            0, 1, 0, 0, 0, 1};
+  const unsigned int indices[] = {0, 1, 2};
+  const MeshAllocation mesh =
+      MeshBuffer::Allocate(Span<const float>(vertices, 18), 6,
+                           Span<const unsigned int>(indices, 3));
+
+  // Slots 0-2 belong to the first command, 3-4 to the second.
+  const DrawElementsIndirectCommand commands[] = {
+      {1, 3, mesh.firstIndex, mesh.baseVertex, 0},
+      {1, 2, mesh.firstIndex, mesh.baseVertex, 3}};
+  const GLuint visible[] = {5, 6, 7, 9, 12};
+
+  StreamingBuffer::BeginFrame();
+  const StreamAllocation commandRange =
+      StreamingBuffer::Upload(commands, sizeof(commands));
+  const StreamAllocation visibleRange =
+      StreamingBuffer::Upload(visible, sizeof(visible));
+
+  const GLuint clear[4] = {0, 0, 0, 0};
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glViewport(0, 0, Width, 1);
+  glClearBufferuiv(GL_COLOR, 0, clear);
+
+  GLStateCache& state = shaderManager.GetState();
+  state.UseProgram(program);
+  state.InvalidateVertexArray();
+  state.BindVertexArray(MeshBuffer::GetVertexArray());
+  MeshBuffer::BindInstanceIndices(visibleRange.buffer, visibleRange.offset);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandRange.buffer);
+  glMultiDrawElementsIndirect(
+      GL_POINTS, GL_UNSIGNED_INT,
+      reinterpret_cast<const void*>(commandRange.offset), 2, 0);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  StreamingBuffer::EndFrame();
+
+  GLuint pixels[Width] = {};
+  glReadPixels(0, 0, Width, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, pixels);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  for (GLuint x = 0; x < Width; ++x) {
+    const bool drawn =
+        std::find(std::begin(visible), std::end(visible), x) !=
+        std::end(visible);
+    CHECK_EQUAL(pixels[x], drawn ? x + 1 : 0u);
+  }
+
+  MeshBuffer::Free(mesh);
+  state.UseProgram(0);
+  glDeleteProgram(program);
+  glDeleteFramebuffers(1, &framebuffer);
+  glDeleteRenderbuffers(1, &color);
+}
+
+}  // namespace
+
+int main() {
+  test::GLContext context;
+  if (!context.IsValid()) {
+    return test::SkipCode;
+  }
+
+  StreamingBuffer::Initialize(1 << 20);
+  auto shaderManager = std::make_shared<ShaderManager>();
+  {
+    GpuCuller culler(shaderManager);
+    CHECK(culler.Initialize());
+    if (culler.IsAvailable()) {
+      TestFrustumMatchesCpu(culler);
+      TestOcclusion(culler);
+    }
+  }
+  TestSceneShaderCompiles();
+  TestInstanceIndices(*shaderManager);
+
+  shaderManager.reset();
+  MeshBuffer::Shutdown();
+  StreamingBuffer::Shutdown();
+  return test::Result();
+}
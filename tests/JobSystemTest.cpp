@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "core/AllocationCounter.h"
+#include "core/JobSystem.h"
+
+namespace {
+
+constexpr std::size_t ItemCount = 100000;
+
+std::size_t SumIndices(JobSystem& jobSystem) {
+  std::vector<std::size_t> values(ItemCount);
+  jobSystem.ParallelFor(ItemCount, 1000, [&values](std::size_t begin,
+                                                   std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      values[i] = i;
+    }
+  });
+
+  std::size_t sum = 0;
+  for (std::size_t value : values) {
+    sum += value;
+  }
+  return sum;
+}
+
+constexpr std::size_t ExpectedSum = ItemCount * (ItemCount - 1) / 2;
+
+void TestParallelFor() {
+  JobSystem jobSystem(3);
+  CHECK_EQUAL(SumIndices(jobSystem), ExpectedSum);
+}
+
+void TestContinuation() {
+  JobSystem jobSystem(2);
+  std::atomic<int> order{0};
+  int antecedentOrder = -1;
+  int continuationOrder = -1;
+
+  JobSystem::JobHandle antecedent = jobSystem.CreateJob(
+      [&]() { antecedentOrder = order.fetch_add(1); });
+  JobSystem::JobHandle continuation = jobSystem.CreateJob(
+      [&]() { continuationOrder = order.fetch_add(1); });
+
+  jobSystem.AddContinuation(antecedent, continuation);
+  jobSystem.Run(antecedent);
+  jobSystem.Wait(continuation);
+
+  CHECK_EQUAL(antecedentOrder, 0);
+  CHECK_EQUAL(continuationOrder, 1);
+}
+
+// The owning thread and another thread, like the render thread, submit and
+// wait at the same time.
+void TestExternalThread() {
+  JobSystem jobSystem(2);
+  std::size_t externalSum = 0;
+
+  std::thread external([&]() { externalSum = SumIndices(jobSystem); });
+  const std::size_t ownSum = SumIndices(jobSystem);
+  external.join();
+
+  CHECK_EQUAL(ownSum, ExpectedSum);
+  CHECK_EQUAL(externalSum, ExpectedSum);
+}
+
+// Without workers, a thread waiting on its own submission runs it itself.
+void TestExternalThreadHelps() {
+  JobSystem jobSystem(0);
+  std::atomic<std::size_t> processed{0};
+
+  std::thread external([&]() {
+    jobSystem.Wait(jobSystem.ParallelForAsync(
+        ItemCount, 1000, [&processed](std::size_t begin, std::size_t end) {
+          processed.fetch_add(end - begin);
+        }));
+  });
+  external.join();
+
+  CHECK_EQUAL(processed.load(), ItemCount);
+}
+
+// Wait() must wake up when another thread finishes the job it sleeps on.
+void TestWaitSleepsUntilFinished() {
+  JobSystem jobSystem(2);
+  std::atomic<bool> done{false};
+
+  JobSystem::JobHandle job = jobSystem.CreateJob([&done]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    done = true;
+  });
+  jobSystem.Run(job);
+
+  // Lets a worker steal the job before waiting on it.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  jobSystem.Wait(job);
+
+  CHECK(done.load());
+}
+
+// Once the pool and the queues have grown, frames of parallel-for, nested
+// jobs and continuations must not allocate.
+void TestSteadyStateAllocations() {
+  JobSystem jobSystem(3);
+  std::vector<std::uint32_t> values(ItemCount);
+  std::atomic<std::size_t> continued{0};
+
+  const auto runFrame = [&]() {
+    jobSystem.ParallelFor(ItemCount, 500, [&](std::size_t begin,
+                                              std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        values[i] += 1;
+      }
+    });
+
+    JobSystem::JobHandle parent = jobSystem.CreateJob();
+    for (int i = 0; i < 16; ++i) {
+      jobSystem.Run(jobSystem.CreateChildJob(parent, [&continued]() {
+        continued.fetch_add(1);
+      }));
+    }
+    JobSystem::JobHandle continuation =
+        jobSystem.CreateJob([&continued]() { continued.fetch_add(1); });
+    jobSystem.AddContinuation(parent, continuation);
+    jobSystem.Run(parent);
+    jobSystem.Wait(continuation);
+  };
+
+  constexpr int WarmUpFrames = 10;
+  constexpr int MeasuredFrames = 100;
+  for (int frame = 0; frame < WarmUpFrames; ++frame) {
+    runFrame();
+  }
+
+  std::uint64_t maxFrameAllocations = 0;
+  for (int frame = 0; frame < MeasuredFrames; ++frame) {
+    const std::uint64_t before = GetHeapAllocationCount();
+    runFrame();
+    maxFrameAllocations =
+        std::max(maxFrameAllocations, GetHeapAllocationCount() - before);
+  }
+
+  std::printf("Most heap allocations in a frame: %llu\n",
+              static_cast<unsigned long long>(maxFrameAllocations));
+  CHECK_EQUAL(maxFrameAllocations, 0u);
+  CHECK_EQUAL(continued.load(),
+              static_cast<std::size_t>((WarmUpFrames + MeasuredFrames) * 17));
+  CHECK_EQUAL(values[ItemCount - 1],
+              static_cast<std::uint32_t>(WarmUpFrames + MeasuredFrames));
+}
+
+}  // namespace
+
+int main() {
+  TestParallelFor();
+  TestContinuation();
+  TestExternalThread();
+  TestExternalThreadHelps();
+  TestWaitSleepsUntilFinished();
+  TestSteadyStateAllocations();
+  return test::Result();
+}
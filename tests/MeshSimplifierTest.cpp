@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.h"
+#include "MeshLibrary.h"
+#include "Test.h"
+#include "core/AllocationCounter.h"
+#include "core/MeshSimplifier.h"
+
+// The quadric simplifier on a flat grid, whose border must stay put, and on
+// a UV sphere, whose seam and pole copies must be welded; then the levels of
+// detail Mesh::SetGeometry() builds from it.
+
+namespace {
+
+/**
+ * @struct TestMesh
+ * @brief Interleaved position, normal and texture coordinates.
+ */
+struct TestMesh {
+  static constexpr int Stride = 8;
+
+  std::vector<float> vertices;
+  std::vector<unsigned int> indices;
+
+  void AddVertex(const glm::vec3& position, const glm::vec3& normal,
+                 float u, float v) {
+    vertices.insert(vertices.end(), {position.x, position.y, position.z,
+                                     normal.x, normal.y, normal.z, u, v});
+  }
+
+  [[nodiscard]] std::size_t GetVertexCount() const {
+    return vertices.size() / Stride;
+  }
+
+  [[nodiscard]] glm::vec3 GetPosition(unsigned int vertex) const {
+    const float* p = &vertices[static_cast<std::size_t>(vertex) * Stride];
+    return {p[0], p[1], p[2]};
+  }
+};
+
+/**
+ * A unit square in the xy plane, facing +z, split into `cells` x `cells`
+ * quads. The interior is slightly bumped so collapses have a cost.
+ */
+TestMesh MakeGrid(int cells) {
+  TestMesh mesh;
+  for (int y = 0; y <= cells; ++y) {
+    for (int x = 0; x <= cells; ++x) {
+      const float u = static_cast<float>(x) / cells;
+      const float v = static_cast<float>(y) / cells;
+      const float bump = 0.002f * std::sin(u * 9.0f) * std::sin(v * 7.0f);
+      mesh.AddVertex(glm::vec3(u, v, bump), glm::vec3(0.0f, 0.0f, 1.0f), u,
+                     v);
+    }
+  }
+
+  const auto vertex = [cells](int x, int y) {
+    return static_cast<unsigned int>(y * (cells + 1) + x);
+  };
+  for (int y = 0; y < cells; ++y) {
+    for (int x = 0; x < cells; ++x) {
+      mesh.indices.insert(mesh.indices.end(),
+                          {vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1),
+                           vertex(x, y), vertex(x + 1, y + 1), vertex(x, y + 1)});
+    }
+  }
+  return mesh;
+}
+
+/**
+ * A closed unit sphere with a UV seam: the first and last column of every
+ * ring share positions, as do all vertices of a pole ring.
+ */
+TestMesh MakeSphere(int segments, int rings) {
+  constexpr float Pi = 3.14159265359f;
+  TestMesh mesh;
+
+  for (int ring = 0; ring <= rings; ++ring) {
+    const float phi = Pi * static_cast<float>(ring) / rings;
+    for (int segment = 0; segment <= segments; ++segment) {
+      // The last column reuses the first one's angle, so the seam is welded.
+      const float theta =
+          2.0f * Pi * static_cast<float>(segment % segments) / segments;
+      glm::vec3 position(std::sin(phi) * std::cos(theta), std::cos(phi),
+                         std::sin(phi) * std::sin(theta));
+      if (ring == 0 || ring == rings) {
+        position = glm::vec3(0.0f, ring == 0 ? 1.0f : -1.0f, 0.0f);
+      }
+      mesh.AddVertex(position, position,
+                     static_cast<float>(segment) / segments,
+                     static_cast<float>(ring) / rings);
+    }
+  }
+
+  for (int ring = 0; ring < rings; ++ring) {
+    for (int segment = 0; segment < segments; ++segment) {
+      const auto top = static_cast<unsigned int>(ring * (segments + 1) +
+                                                 segment);
+      const auto bottom = top + static_cast<unsigned int>(segments + 1);
+      // Counter-clockwise seen from outside.
+      mesh.indices.insert(mesh.indices.end(), {top, top + 1, bottom,
+                                               top + 1, bottom + 1, bottom});
+    }
+  }
+  return mesh;
+}
+
+glm::vec3 TriangleNormal(const TestMesh& mesh, const unsigned int* corners) {
+  const glm::vec3 p0 = mesh.GetPosition(corners[0]);
+  return glm::cross(mesh.GetPosition(corners[1]) - p0,
+                    mesh.GetPosition(corners[2]) - p0);
+}
+
+/** Distance from `p` to the triangle abc, after Ericson's closest point. */
+float DistanceToTriangle(const glm::vec3& p, const glm::vec3& a,
+                         const glm::vec3& b, const glm::vec3& c) {
+  const glm::vec3 ab = b - a;
+  const glm::vec3 ac = c - a;
+  const glm::vec3 ap = p - a;
+  const float d1 = glm::dot(ab, ap);
+  const float d2 = glm::dot(ac, ap);
+  if (d1 <= 0.0f && d2 <= 0.0f) {
+    return glm::length(p - a);
+  }
+
+  const glm::vec3 bp = p - b;
+  const float d3 = glm::dot(ab, bp);
+  const float d4 = glm::dot(ac, bp);
+  if (d3 >= 0.0f && d4 <= d3) {
+    return glm::length(p - b);
+  }
+
+  const float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+    return glm::length(p - (a + ab * (d1 / (d1 - d3))));
+  }
+
+  const glm::vec3 cp = p - c;
+  const float d5 = glm::dot(ab, cp);
+  const float d6 = glm::dot(ac, cp);
+  if (d6 >= 0.0f && d5 <= d6) {
+    return glm::length(p - c);
+  }
+
+  const float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+    return glm::length(p - (a + ac * (d2 / (d2 - d6))));
+  }
+
+  const float va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+    const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    return glm::length(p - (b + (c - b) * w));
+  }
+
+  const float denominator = 1.0f / (va + vb + vc);
+  return glm::length(p - (a + ab * (vb * denominator) +
+                          ac * (vc * denominator)));
+}
+
+/** Largest distance from a vertex of `mesh` to the triangles `indices`. */
+float SurfaceError(const TestMesh& mesh, const Span<const unsigned int> indices) {
+  float error = 0.0f;
+  for (std::size_t v = 0; v < mesh.GetVertexCount(); ++v) {
+    const glm::vec3 p = mesh.GetPosition(static_cast<unsigned int>(v));
+    float nearest = INFINITY;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+      nearest = std::min(
+          nearest, DistanceToTriangle(p, mesh.GetPosition(indices[i]),
+                                      mesh.GetPosition(indices[i + 1]),
+                                      mesh.GetPosition(indices[i + 2])));
+    }
+    error = std::max(error, nearest);
+  }
+  return error;
+}
+
+void CheckIndicesInRange(const TestMesh& mesh,
+                         const std::vector<unsigned int>& indices) {
+  CHECK_EQUAL(indices.size() % 3, 0u);
+  for (unsigned int index : indices) {
+    CHECK(index < mesh.GetVertexCount());
+  }
+}
+
+// The grid reaches its target; border vertices are all kept, so the
+// simplified triangles still tile the whole square, none turned over.
+void TestGrid() {
+  constexpr int Cells = 24;
+  const TestMesh grid = MakeGrid(Cells);
+  const std::size_t target = grid.indices.size() / 4;
+
+  const std::vector<unsigned int> simplified = SimplifyMesh(
+      grid.vertices, TestMesh::Stride, grid.indices, target, 0.05f);
+
+  CHECK(!simplified.empty());
+  CHECK(simplified.size() <= target);
+  CheckIndicesInRange(grid, simplified);
+
+  std::vector<bool> used(grid.GetVertexCount(), false);
+  for (unsigned int index : simplified) {
+    used[index] = true;
+  }
+
+  int missingBorderVertices = 0;
+  for (int y = 0; y <= Cells; ++y) {
+    for (int x = 0; x <= Cells; ++x) {
+      const bool border = x == 0 || y == 0 || x == Cells || y == Cells;
+      if (border && !used[static_cast<std::size_t>(y * (Cells + 1) + x)]) {
+        ++missingBorderVertices;
+      }
+    }
+  }
+  CHECK_EQUAL(missingBorderVertices, 0);
+
+  float area = 0.0f;
+  int flipped = 0;
+  for (std::size_t i = 0; i < simplified.size(); i += 3) {
+    const float z = TriangleNormal(grid, &simplified[i]).z;
+    flipped += z <= 0.0f ? 1 : 0;
+    area += 0.5f * z;
+  }
+  CHECK_EQUAL(flipped, 0);
+  CHECK(std::abs(area - 1.0f) < 1e-4f);
+}
+
+// The sphere reaches its target without opening the seam or the poles:
+// every triangle still faces outwards, and the surface stays close to the
+// original.
+void TestSphere() {
+  const TestMesh sphere = MakeSphere(32, 16);
+  const std::size_t target = sphere.indices.size() / 4;
+
+  const std::vector<unsigned int> simplified = SimplifyMesh(
+      sphere.vertices, TestMesh::Stride, sphere.indices, target, 0.05f);
+
+  CHECK(!simplified.empty());
+  CHECK(simplified.size() <= target);
+  CheckIndicesInRange(sphere, simplified);
+
+  int inward = 0;
+  for (std::size_t i = 0; i < simplified.size(); i += 3) {
+    const glm::vec3 centroid = (sphere.GetPosition(simplified[i]) +
+                                sphere.GetPosition(simplified[i + 1]) +
+                                sphere.GetPosition(simplified[i + 2])) /
+                               3.0f;
+    inward += glm::dot(TriangleNormal(sphere, &simplified[i]), centroid) <= 0.0f
+                  ? 1
+                  : 0;
+  }
+  CHECK_EQUAL(inward, 0);
+  CHECK(SurfaceError(sphere, simplified) < 0.2f);
+
+  // An error limit of 0 allows only the free collapses: the pole copies.
+  const std::vector<unsigned int> exact = SimplifyMesh(
+      sphere.vertices, TestMesh::Stride, sphere.indices, 0, 0.0f);
+  CHECK(exact.size() < sphere.indices.size());
+  CHECK(SurfaceError(sphere, exact) < 1e-5f);
+}
+
+// Through the library's asset path: the builder runs once, each level has
+// fewer indices than the previous one and a surface error at least as large.
+// Statistics refilled into the same vector allocate nothing.
+void TestLevelsOfDetail() {
+  const TestMesh sphere = MakeSphere(48, 24);
+  int builds = 0;
+  const MeshLibrary::Builder build = [&sphere, &builds](Mesh& mesh) {
+    ++builds;
+    mesh.SetGeometry(sphere.vertices, sphere.indices, TestMesh::Stride);
+  };
+
+  const std::shared_ptr<const Mesh> mesh =
+      MeshLibrary::Get("tests/sphere", build);
+  CHECK(MeshLibrary::Get("tests/sphere", build) == mesh);
+  CHECK_EQUAL(builds, 1);
+
+  std::vector<MeshLibrary::MeshStats> stats;
+  MeshLibrary::GetStats(stats);
+  CHECK_EQUAL(stats.size(), 1u);
+  CHECK(*stats[0].key == "tests/sphere");
+  CHECK_EQUAL(stats[0].users, 1);
+  CHECK_EQUAL(stats[0].indexCount, mesh->GetIndexCount());
+
+  const std::uint64_t allocations = GetHeapAllocationCount();
+  MeshLibrary::GetStats(stats);
+  CHECK_EQUAL(GetHeapAllocationCount(), allocations);
+  CHECK_EQUAL(stats.size(), 1u);
+
+  CHECK(mesh->GetLodCount() > 1);
+  CHECK(mesh->GetLodCount() <= Mesh::MaxLodCount);
+  CHECK(mesh->GetLodIndices(0).size() == sphere.indices.size());
+
+  float previousError = 0.0f;
+  std::size_t previousCount = sphere.indices.size() + 1;
+  for (std::size_t lod = 0; lod < mesh->GetLodCount(); ++lod) {
+    const Span<const unsigned int> indices = mesh->GetLodIndices(lod);
+    CHECK(indices.size() < previousCount);
+    for (unsigned int index : indices) {
+      CHECK(index < sphere.GetVertexCount());
+    }
+
+    const float error = SurfaceError(sphere, indices);
+    CHECK(error >= previousError);
+    previousError = error;
+    previousCount = indices.size();
+  }
+
+  MeshLibrary::Clear();
+}
+
+}  // namespace
+
+int main() {
+  TestGrid();
+  TestSphere();
+  TestLevelsOfDetail();
+  return test::Result();
+}
@@ -0,0 +1,181 @@
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Test.h"
+#include "core/Bounds.h"
+#include "core/JobSystem.h"
+#include "core/OcclusionBuffer.h"
+
+// The software rasterizer and its depth pyramid, seen through IsVisible().
+// Under an orthographic camera mapping world units to pixels, a quad
+// occluder covers a known set of pixel centers, so boxes can be tested one
+// pixel at a time, including along the columns the SSE loop handles in
+// partial groups of 4.
+
+namespace {
+
+/** The quad [x0, x1] x [y0, y1] at depth z, as two triangles. */
+struct Quad {
+  Quad(float x0, float y0, float x1, float y1, float z)
+      : vertices{x0, y0, z, x1, y0, z, x1, y1, z, x0, y1, z},
+        indices{0, 1, 2, 0, 2, 3} {}
+
+  std::vector<float> vertices;
+  std::vector<unsigned int> indices;
+};
+
+Aabb MakeBox(const glm::vec3& min, const glm::vec3& max) {
+  Aabb box;
+  box.Expand(min);
+  box.Expand(max);
+  return box;
+}
+
+/** A box filling the middle of pixel (x, y) between depths zNear and zFar. */
+Aabb PixelBox(int x, int y, float zNear, float zFar) {
+  return MakeBox(glm::vec3(x + 0.25f, y + 0.25f, -zFar),
+                 glm::vec3(x + 0.75f, y + 0.75f, -zNear));
+}
+
+// Camera at the origin looking down -z, one world unit per pixel.
+const glm::mat4 Orthographic =
+    glm::ortho(0.0f, static_cast<float>(OcclusionBuffer::Width), 0.0f,
+               static_cast<float>(OcclusionBuffer::Height), 1.0f, 100.0f);
+
+// Pixel centers x + 0.5 inside [13.3, 201.6] and y + 0.5 inside [9.7, 94.2]:
+// columns 13 to 201 and rows 10 to 93. Neither the first column nor the
+// width, 189, is a multiple of 4.
+const Quad Occluder(13.3f, 9.7f, 201.6f, 94.2f, -10.0f);
+constexpr int FirstColumn = 13;
+constexpr int LastColumn = 201;
+constexpr int FirstRow = 10;
+constexpr int LastRow = 93;
+
+bool IsCovered(int x, int y) {
+  return x >= FirstColumn && x <= LastColumn && y >= FirstRow &&
+         y <= LastRow;
+}
+
+// Every pixel: a box behind the quad is hidden exactly where the quad
+// covers the pixel center, a box in front of it never.
+void CheckEveryPixel(const OcclusionBuffer& buffer) {
+  int wrongBehind = 0;
+  int wrongInFront = 0;
+  for (int y = 0; y < OcclusionBuffer::Height; ++y) {
+    for (int x = 0; x < OcclusionBuffer::Width; ++x) {
+      if (buffer.IsVisible(PixelBox(x, y, 20.0f, 21.0f), Orthographic) ==
+          IsCovered(x, y)) {
+        ++wrongBehind;
+      }
+      if (!buffer.IsVisible(PixelBox(x, y, 8.0f, 9.0f), Orthographic)) {
+        ++wrongInFront;
+      }
+    }
+  }
+  CHECK_EQUAL(wrongBehind, 0);
+  CHECK_EQUAL(wrongInFront, 0);
+}
+
+void TestPixelCoverage() {
+  OcclusionBuffer buffer;
+  buffer.Clear();
+  buffer.AddOccluder(Occluder.vertices, 3, Occluder.indices, Orthographic);
+  CHECK_EQUAL(buffer.GetTriangleCount(), 2u);
+  buffer.Rasterize(nullptr);
+  CheckEveryPixel(buffer);
+
+  // Bands rasterized on workers give the same buffer.
+  JobSystem jobSystem(3);
+  buffer.Clear();
+  buffer.AddOccluder(Occluder.vertices, 3, Occluder.indices, Orthographic);
+  buffer.Rasterize(&jobSystem);
+  CheckEveryPixel(buffer);
+
+  // Clearing forgets the occluder.
+  buffer.Clear();
+  buffer.Rasterize(nullptr);
+  CHECK(buffer.IsVisible(PixelBox(100, 50, 20.0f, 21.0f), Orthographic));
+}
+
+// Larger boxes are tested against coarser pyramid levels, which must stay
+// conservative.
+void TestLargeBoxes() {
+  OcclusionBuffer buffer;
+  buffer.Clear();
+  buffer.AddOccluder(Occluder.vertices, 3, Occluder.indices, Orthographic);
+  buffer.Rasterize(nullptr);
+
+  // Behind the quad, tested against 2x1 texels of level 5, each 32x32
+  // pixels inside the quad.
+  CHECK(!buffer.IsVisible(MakeBox(glm::vec3(64.2f, 32.2f, -30.0f),
+                                  glm::vec3(127.8f, 63.8f, -20.0f)),
+                          Orthographic));
+  // A wider box is tested against level 7, whose two texels reach past the
+  // quad on both sides.
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(40.0f, 20.0f, -30.0f),
+                                 glm::vec3(170.0f, 80.0f, -20.0f)),
+                         Orthographic));
+  // Behind it but reaching one pixel past its right edge.
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(190.2f, 40.2f, -30.0f),
+                                 glm::vec3(202.8f, 47.8f, -20.0f)),
+                         Orthographic));
+  // Beside it.
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(210.0f, 20.0f, -30.0f),
+                                 glm::vec3(250.0f, 80.0f, -20.0f)),
+                         Orthographic));
+  // Behind the quad at one end, in front of it at the other.
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(40.0f, 20.0f, -30.0f),
+                                 glm::vec3(170.0f, 80.0f, -5.0f)),
+                         Orthographic));
+}
+
+// Perspective depth is z / w: a wall 10 units away hides what is behind it,
+// not what is in front. Boxes crossing the near plane or behind the camera
+// are always visible, even when the wall covers the whole view.
+void TestPerspective() {
+  const glm::mat4 projection = glm::perspective(
+      glm::radians(90.0f),
+      static_cast<float>(OcclusionBuffer::Width) / OcclusionBuffer::Height,
+      0.1f, 100.0f);
+  const Quad wall(-50.0f, -50.0f, 50.0f, 50.0f, -10.0f);
+
+  OcclusionBuffer buffer;
+  buffer.Clear();
+  buffer.AddOccluder(wall.vertices, 3, wall.indices, projection);
+  buffer.Rasterize(nullptr);
+
+  CHECK(!buffer.IsVisible(MakeBox(glm::vec3(-1.0f, -1.0f, -13.0f),
+                                  glm::vec3(1.0f, 1.0f, -11.0f)),
+                          projection));
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(-1.0f, -1.0f, -9.0f),
+                                 glm::vec3(1.0f, 1.0f, -7.0f)),
+                         projection));
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(-1.0f, -1.0f, -12.0f),
+                                 glm::vec3(1.0f, 1.0f, -9.0f)),
+                         projection));
+  // Crossing the near plane.
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(-0.5f, -0.5f, -0.5f),
+                                 glm::vec3(0.5f, 0.5f, 0.5f)),
+                         projection));
+  // Behind the camera.
+  CHECK(buffer.IsVisible(MakeBox(glm::vec3(-1.0f, -1.0f, 5.0f),
+                                 glm::vec3(1.0f, 1.0f, 7.0f)),
+                         projection));
+
+  // Triangles crossing the near plane are dropped rather than clipped.
+  const std::vector<float> crossing{-50.0f, -50.0f, -10.0f, 50.0f, -50.0f,
+                                    -10.0f, 50.0f,  50.0f,  1.0f,   -50.0f,
+                                    50.0f,  1.0f};
+  buffer.Clear();
+  buffer.AddOccluder(crossing, 3, wall.indices, projection);
+  CHECK_EQUAL(buffer.GetTriangleCount(), 0u);
+}
+
+}  // namespace
+
+int main() {
+  TestPixelCoverage();
+  TestLargeBoxes();
+  TestPerspective();
+  return test::Result();
+}
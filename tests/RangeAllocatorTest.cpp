@@ -0,0 +1,151 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include "Test.h"
+#include "core/RangeAllocator.h"
+
+namespace {
+
+void TestFirstFit() {
+  RangeAllocator allocator(100);
+  CHECK_EQUAL(allocator.Allocate(10), 0u);
+  CHECK_EQUAL(allocator.Allocate(20), 10u);
+  CHECK_EQUAL(allocator.Allocate(30), 30u);
+  CHECK_EQUAL(allocator.Allocate(10), 60u);
+  CHECK_EQUAL(allocator.GetUsed(), 70u);
+
+  // Free ranges at 0 (10 units), 30 (30 units) and the tail 70 (30 units).
+  allocator.Free(0, 10);
+  allocator.Free(30, 30);
+
+  // The first range large enough wins over a better fitting one: 5 units
+  // come from offset 0, not from the exact fit left at 55.
+  CHECK_EQUAL(allocator.Allocate(25), 30u);
+  CHECK_EQUAL(allocator.Allocate(5), 0u);
+  CHECK_EQUAL(allocator.Allocate(5), 5u);
+  CHECK_EQUAL(allocator.Allocate(6), 70u);
+  CHECK_EQUAL(allocator.Allocate(5), 55u);
+  CHECK_EQUAL(allocator.GetUsed(), 76u);
+}
+
+void TestFailures() {
+  RangeAllocator allocator(10);
+  CHECK_EQUAL(allocator.Allocate(0), RangeAllocator::NoRange);
+  CHECK_EQUAL(allocator.Allocate(11), RangeAllocator::NoRange);
+
+  // 6 units are free in total but no range holds more than 4.
+  CHECK_EQUAL(allocator.Allocate(2), 0u);
+  CHECK_EQUAL(allocator.Allocate(4), 2u);
+  CHECK_EQUAL(allocator.Allocate(4), 6u);
+  allocator.Free(0, 2);
+  allocator.Free(6, 4);
+  CHECK_EQUAL(allocator.Allocate(5), RangeAllocator::NoRange);
+  CHECK_EQUAL(allocator.GetUsed(), 4u);
+}
+
+// Freeing a range merges it with free neighbours on either side, so the whole
+// resource is one range again once everything is freed, in any order.
+void TestMerge() {
+  const std::vector<std::vector<int>> orders{
+      {0, 1, 2, 3}, {3, 2, 1, 0}, {1, 3, 0, 2}, {0, 2, 1, 3}, {2, 0, 3, 1}};
+
+  for (const std::vector<int>& order : orders) {
+    RangeAllocator allocator(40);
+    for (int i = 0; i < 4; ++i) {
+      CHECK_EQUAL(allocator.Allocate(10), static_cast<std::uint32_t>(i * 10));
+    }
+
+    for (int block : order) {
+      allocator.Free(static_cast<std::uint32_t>(block * 10), 10);
+    }
+
+    CHECK_EQUAL(allocator.GetUsed(), 0u);
+    CHECK_EQUAL(allocator.Allocate(40), 0u);
+  }
+}
+
+// Grown units merge with a free range ending the old capacity.
+void TestGrow() {
+  RangeAllocator allocator(10);
+  CHECK_EQUAL(allocator.Allocate(4), 0u);
+  CHECK_EQUAL(allocator.Allocate(20), RangeAllocator::NoRange);
+
+  allocator.Grow(30);
+  CHECK_EQUAL(allocator.GetCapacity(), 30u);
+  CHECK_EQUAL(allocator.GetUsed(), 4u);
+  CHECK_EQUAL(allocator.Allocate(26), 4u);
+
+  // Shrinking is ignored.
+  allocator.Grow(5);
+  CHECK_EQUAL(allocator.GetCapacity(), 30u);
+
+  // Without a free tail, the new units start a range of their own.
+  allocator.Grow(40);
+  CHECK_EQUAL(allocator.Allocate(10), 30u);
+  CHECK_EQUAL(allocator.GetUsed(), 40u);
+}
+
+// Random allocations and frees against a map of the units in use: every
+// allocation must land at the first run of free units long enough, which
+// holds only if free ranges are merged.
+void TestMatchesReference() {
+  constexpr std::uint32_t Capacity = 1024;
+  RangeAllocator allocator(Capacity);
+  std::vector<bool> used(Capacity, false);
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> live;
+
+  const auto firstFit = [&used](std::uint32_t size) {
+    std::uint32_t run = 0;
+    for (std::uint32_t i = 0; i < Capacity; ++i) {
+      run = used[i] ? 0 : run + 1;
+      if (run == size) {
+        return i + 1 - size;
+      }
+    }
+    return RangeAllocator::NoRange;
+  };
+
+  std::mt19937 generator(1158);
+  std::uniform_int_distribution<std::uint32_t> sizes(1, 64);
+  for (int step = 0; step < 20000; ++step) {
+    if (live.empty() || generator() % 5 < 3) {
+      const std::uint32_t size = sizes(generator);
+      const std::uint32_t offset = allocator.Allocate(size);
+      CHECK_EQUAL(offset, firstFit(size));
+      if (offset != RangeAllocator::NoRange) {
+        for (std::uint32_t i = 0; i < size; ++i) {
+          used[offset + i] = true;
+        }
+        live.emplace_back(offset, size);
+      }
+    } else {
+      const std::size_t index = generator() % live.size();
+      const auto [offset, size] = live[index];
+      allocator.Free(offset, size);
+      for (std::uint32_t i = 0; i < size; ++i) {
+        used[offset + i] = false;
+      }
+      live[index] = live.back();
+      live.pop_back();
+    }
+  }
+
+  for (const auto& [offset, size] : live) {
+    allocator.Free(offset, size);
+  }
+  CHECK_EQUAL(allocator.GetUsed(), 0u);
+  CHECK_EQUAL(allocator.Allocate(Capacity), 0u);
+}
+
+}  // namespace
+
+int main() {
+  TestFirstFit();
+  TestFailures();
+  TestMerge();
+  TestGrow();
+  TestMatchesReference();
+  return test::Result();
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "Test.h"
+#include "core/RenderQueue.h"
+
+namespace {
+
+// Pushes `keys` in order and returns the items after sorting.
+std::vector<std::uint32_t> SortedItems(RenderQueue& queue,
+                                       const std::vector<std::uint64_t>& keys) {
+  queue.Clear();
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    queue.Push(keys[i], static_cast<std::uint32_t>(i));
+  }
+  queue.Sort();
+
+  std::vector<std::uint32_t> items;
+  for (const RenderQueue::Entry& entry : queue.GetEntries()) {
+    items.push_back(entry.item);
+  }
+  return items;
+}
+
+// Each field outranks every field below it, whatever their values.
+void TestFieldPriority() {
+  const std::uint32_t maxDepth = RenderQueue::QuantizeDepth(1.0f, 0.0f, 1.0f);
+
+  CHECK(RenderQueue::MakeKey(0, 63, 4095, 0xFFFFFF, 15, maxDepth) <
+        RenderQueue::MakeKey(1, 0, 0, 0, 0, 0));
+  CHECK(RenderQueue::MakeKey(0, 0, 4095, 0xFFFFFF, 15, maxDepth) <
+        RenderQueue::MakeKey(0, 1, 0, 0, 0, 0));
+  CHECK(RenderQueue::MakeKey(0, 0, 0, 0xFFFFFF, 15, maxDepth) <
+        RenderQueue::MakeKey(0, 0, 1, 0, 0, 0));
+  CHECK(RenderQueue::MakeKey(0, 0, 0, 0, 15, maxDepth) <
+        RenderQueue::MakeKey(0, 0, 0, 1, 0, 0));
+  CHECK(RenderQueue::MakeKey(0, 0, 0, 0, 0, maxDepth) <
+        RenderQueue::MakeKey(0, 0, 0, 0, 1, 0));
+
+  // Draws differing only in depth share their state bits.
+  CHECK_EQUAL(RenderQueue::MakeKey(1, 2, 3, 4, 5, 0) & RenderQueue::StateMask,
+              RenderQueue::MakeKey(1, 2, 3, 4, 5, maxDepth) &
+                  RenderQueue::StateMask);
+}
+
+// Values wider than their field are truncated instead of spilling into the
+// field above.
+void TestTruncation() {
+  CHECK_EQUAL(RenderQueue::MakeKey(0, 0, 0, 0x1000001, 0, 0),
+              RenderQueue::MakeKey(0, 0, 0, 1, 0, 0));
+  CHECK_EQUAL(RenderQueue::MakeKey(0, 0, 0, 0, 0, 0x10002),
+              RenderQueue::MakeKey(0, 0, 0, 0, 0, 2));
+  CHECK_EQUAL(RenderQueue::MakeKey(4, 0, 0, 0, 0, 0),
+              RenderQueue::MakeKey(0, 0, 0, 0, 0, 0));
+}
+
+void TestQuantizeDepth() {
+  CHECK_EQUAL(RenderQueue::QuantizeDepth(0.05f, 0.1f, 100.0f), 0u);
+  CHECK_EQUAL(RenderQueue::QuantizeDepth(0.1f, 0.1f, 100.0f), 0u);
+  CHECK_EQUAL(RenderQueue::QuantizeDepth(100.0f, 0.1f, 100.0f), 0xFFFFu);
+  CHECK_EQUAL(RenderQueue::QuantizeDepth(500.0f, 0.1f, 100.0f), 0xFFFFu);
+
+  std::uint32_t previous = 0;
+  for (float depth = 0.1f; depth < 100.0f; depth += 0.5f) {
+    const std::uint32_t quantized =
+        RenderQueue::QuantizeDepth(depth, 0.1f, 100.0f);
+    CHECK(quantized >= previous);
+    previous = quantized;
+  }
+}
+
+// Opaque draws grouped by state, nearest first within a state, before
+// transparent ones.
+void TestFrameOrder() {
+  RenderQueue queue;
+  const std::vector<std::uint64_t> keys{
+      RenderQueue::MakeKey(1, 0, 0, 0, 0, 10),    // 0: transparent
+      RenderQueue::MakeKey(0, 2, 1, 7, 0, 900),   // 1: shader 2, far
+      RenderQueue::MakeKey(0, 1, 5, 3, 1, 50),    // 2: shader 1, lod 1
+      RenderQueue::MakeKey(0, 2, 1, 7, 0, 100),   // 3: shader 2, near
+      RenderQueue::MakeKey(0, 1, 5, 3, 0, 5000),  // 4: shader 1, lod 0
+  };
+
+  CHECK(SortedItems(queue, keys) ==
+        (std::vector<std::uint32_t>{4, 2, 3, 1, 0}));
+}
+
+// Equal keys keep their push order, including when every pass is skipped.
+void TestStability() {
+  RenderQueue queue;
+  const std::uint64_t a = RenderQueue::MakeKey(0, 1, 2, 3, 0, 40);
+  const std::uint64_t b = RenderQueue::MakeKey(0, 1, 2, 3, 0, 20);
+
+  CHECK(SortedItems(queue, {a, b, a, b, a}) ==
+        (std::vector<std::uint32_t>{1, 3, 0, 2, 4}));
+  CHECK(SortedItems(queue, {a, a, a}) ==
+        (std::vector<std::uint32_t>{0, 1, 2}));
+  CHECK(SortedItems(queue, {b}) == (std::vector<std::uint32_t>{0}));
+  CHECK(SortedItems(queue, {}).empty());
+}
+
+// The radix sort matches std::stable_sort on random keys, with fields both
+// fully used and mostly constant so that some passes are skipped.
+void TestMatchesStableSort() {
+  std::mt19937 generator(1158);
+  RenderQueue queue;
+
+  for (std::uint32_t fieldRange : {1u, 4u, 1000u, 0xFFFFFFFFu}) {
+    std::uniform_int_distribution<std::uint32_t> value(0, fieldRange - 1);
+    std::vector<std::uint64_t> keys(5000);
+    for (std::uint64_t& key : keys) {
+      key = RenderQueue::MakeKey(value(generator), value(generator),
+                                 value(generator), value(generator),
+                                 value(generator), value(generator));
+    }
+
+    std::vector<std::uint32_t> expected(keys.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      expected[i] = static_cast<std::uint32_t>(i);
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&keys](std::uint32_t lhs, std::uint32_t rhs) {
+                       return keys[lhs] < keys[rhs];
+                     });
+
+    CHECK(SortedItems(queue, keys) == expected);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestFieldPriority();
+  TestTruncation();
+  TestQuantizeDepth();
+  TestFrameOrder();
+  TestStability();
+  TestMatchesStableSort();
+  return test::Result();
+}
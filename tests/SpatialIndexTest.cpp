@@ -0,0 +1,85 @@
+#include <memory>
+#include "GameObject.h"
+#include "Mesh.h"
+#include "MeshComponent.h"
+#include "Scene.h"
+#include "Test.h"
+#include "TransformComponent.h"
+
+namespace {
+
+// Whether the fat box of `gameObject` in the scene's index overlaps a small
+// box around `point`.
+bool IndexContains(const Scene& scene, const GameObject* gameObject,
+                   const glm::vec3& point) {
+  Aabb probe;
+  probe.Expand(point - glm::vec3(0.05f));
+  probe.Expand(point + glm::vec3(0.05f));
+
+  const AabbTree& index = scene.GetSpatialIndex();
+  bool found = false;
+  index.QueryAabb(probe, [&](std::int32_t proxy) {
+    found = index.GetUserData(proxy) == gameObject;
+    return !found;
+  });
+  return found;
+}
+
+// Meshes are CPU-only until uploaded, so these tests need no GL context.
+// The cube spans ±0.5 and the capsule ±1.5 along y; scaled by 4, a point at
+// y = 3 lies outside the cube but inside the capsule.
+const glm::vec3 CapsuleOnlyPoint(0.0f, 3.0f, 0.0f);
+const glm::vec3 CubeCorner(1.9f, 1.9f, 1.9f);
+
+void TestAddMeshComponent() {
+  Scene scene;
+  GameObject* gameObject = scene.CreateGameObject("Object");
+  gameObject->GetComponent<TransformComponent>()->SetScale(glm::vec3(4.0f));
+  scene.Update(0.0f);
+  CHECK(!IndexContains(scene, gameObject, CubeCorner));
+
+  // No transform change: only the new component may trigger the refit.
+  gameObject->AddComponent<MeshComponent>(
+      std::make_shared<const Mesh>(MeshType::Cube));
+  scene.Update(0.0f);
+  CHECK(IndexContains(scene, gameObject, CubeCorner));
+  CHECK(!IndexContains(scene, gameObject, CapsuleOnlyPoint));
+}
+
+void TestSetMesh() {
+  Scene scene;
+  GameObject* gameObject = scene.CreateGameObject("Object");
+  gameObject->GetComponent<TransformComponent>()->SetScale(glm::vec3(4.0f));
+  MeshComponent* meshComponent = gameObject->AddComponent<MeshComponent>(
+      std::make_shared<const Mesh>(MeshType::Cube));
+  scene.Update(0.0f);
+  CHECK(!IndexContains(scene, gameObject, CapsuleOnlyPoint));
+
+  meshComponent->SetMesh(std::make_shared<const Mesh>(MeshType::Capsule));
+  scene.Update(0.0f);
+  CHECK(IndexContains(scene, gameObject, CapsuleOnlyPoint));
+}
+
+// Clearing and setting a mesh in the same frame refits once, to the new mesh.
+void TestClearThenSetMesh() {
+  Scene scene;
+  GameObject* gameObject = scene.CreateGameObject("Object");
+  gameObject->GetComponent<TransformComponent>()->SetScale(glm::vec3(4.0f));
+  MeshComponent* meshComponent = gameObject->AddComponent<MeshComponent>(
+      std::make_shared<const Mesh>(MeshType::Cube));
+  scene.Update(0.0f);
+
+  meshComponent->ClearMesh();
+  meshComponent->SetMesh(std::make_shared<const Mesh>(MeshType::Capsule));
+  scene.Update(0.0f);
+  CHECK(IndexContains(scene, gameObject, CapsuleOnlyPoint));
+}
+
+}  // namespace
+
+int main() {
+  TestAddMeshComponent();
+  TestSetMesh();
+  TestClearThenSetMesh();
+  return test::Result();
+}
@@ -0,0 +1,217 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "GLContext.h"
+#include "Test.h"
+#include "core/GLDeletionQueue.h"
+#include "core/StreamingBuffer.h"
+
+// The ring of frame regions, read back through GPU copies: data written
+// through the persistent mapping reaches the GPU, regions are reused
+// RegionCount frames later only once the GPU is done with them, and a frame
+// outgrowing its region moves to a larger buffer without losing anything.
+
+namespace {
+
+constexpr std::size_t RegionSize = 1024;
+
+/** Bytes 0, 1, 2... offset by `seed`. */
+std::vector<std::uint8_t> Pattern(std::size_t size, std::uint8_t seed) {
+  std::vector<std::uint8_t> data(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<std::uint8_t>(seed + i);
+  }
+  return data;
+}
+
+/** Copies an allocation into a new buffer on the GPU. */
+GLuint CopyOnGpu(const StreamAllocation& allocation) {
+  GLuint copy = 0;
+  glCreateBuffers(1, &copy);
+  glNamedBufferStorage(copy, allocation.size, nullptr, 0);
+  glCopyNamedBufferSubData(allocation.buffer, copy, allocation.offset, 0,
+                           allocation.size);
+  return copy;
+}
+
+/** Reads back and deletes a buffer made by CopyOnGpu(). */
+std::vector<std::uint8_t> ReadCopy(GLuint copy, std::size_t size) {
+  std::vector<std::uint8_t> data(size);
+  glGetNamedBufferSubData(copy, 0, static_cast<GLsizeiptr>(size),
+                          data.data());
+  glDeleteBuffers(1, &copy);
+  return data;
+}
+
+// Allocations are aligned, packed in their frame's region without overlap,
+// and what the CPU wrote is what the GPU reads.
+void TestFrames() {
+  const std::size_t alignments[] = {4, 12, StreamingBuffer::DefaultAlignment,
+                                    StreamingBuffer::GetStorageAlignment()};
+
+  std::size_t previousRegion = RegionSize;
+  for (std::size_t frame = 0; frame < 2 * StreamingBuffer::RegionCount;
+       ++frame) {
+    StreamingBuffer::BeginFrame();
+
+    std::vector<StreamAllocation> allocations;
+    std::vector<GLuint> copies;
+    GLintptr end = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+      const std::vector<std::uint8_t> data =
+          Pattern(40 + i * 30, static_cast<std::uint8_t>(frame * 16 + i));
+      const StreamAllocation allocation =
+          StreamingBuffer::Upload(data.data(), data.size(), alignments[i]);
+
+      CHECK(allocation.IsValid());
+      CHECK_EQUAL(allocation.offset % alignments[i], 0);
+      CHECK(allocation.offset >= end);
+      end = allocation.offset + allocation.size;
+
+      allocations.push_back(allocation);
+      copies.push_back(CopyOnGpu(allocation));
+    }
+
+    // Every allocation of the frame lies in one region, not the previous
+    // frame's.
+    const std::size_t region =
+        static_cast<std::size_t>(allocations[0].offset) / RegionSize;
+    CHECK_EQUAL(static_cast<std::size_t>(end - 1) / RegionSize, region);
+    CHECK(region != previousRegion);
+    previousRegion = region;
+
+    StreamingBuffer::EndFrame();
+    CHECK_EQUAL(StreamingBuffer::GetLastFrameBytes(),
+                static_cast<std::size_t>(end) - region * RegionSize);
+
+    for (std::size_t i = 0; i < allocations.size(); ++i) {
+      CHECK(ReadCopy(copies[i], allocations[i].size) ==
+            Pattern(allocations[i].size,
+                    static_cast<std::uint8_t>(frame * 16 + i)));
+    }
+  }
+}
+
+// A frame filling its whole region reuses it RegionCount frames later. The
+// GPU copy issued from the region must still see the first frame's bytes,
+// although the later frame overwrites them: BeginFrame() waits for it. A
+// fence issued right after the copy is signaled by then, since fences
+// signal in order and the frame's own fence comes later.
+void TestRegionReuse() {
+  std::vector<GLuint> copies;
+  std::vector<GLintptr> offsets;
+  std::vector<GLsync> copyFences;
+
+  for (std::size_t frame = 0; frame < 2 * StreamingBuffer::RegionCount;
+       ++frame) {
+    StreamingBuffer::BeginFrame();
+    if (frame >= StreamingBuffer::RegionCount) {
+      GLsync& fence = copyFences[frame - StreamingBuffer::RegionCount];
+      GLint status = GL_UNSIGNALED;
+      glGetSynciv(fence, GL_SYNC_STATUS, 1, nullptr, &status);
+      CHECK_EQUAL(status, GL_SIGNALED);
+      glDeleteSync(fence);
+    }
+
+    const std::vector<std::uint8_t> data =
+        Pattern(RegionSize, static_cast<std::uint8_t>(frame));
+    const StreamAllocation allocation =
+        StreamingBuffer::Upload(data.data(), data.size());
+    CHECK_EQUAL(allocation.size, static_cast<GLsizeiptr>(RegionSize));
+    copies.push_back(CopyOnGpu(allocation));
+    copyFences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    offsets.push_back(allocation.offset);
+    StreamingBuffer::EndFrame();
+  }
+
+  for (std::size_t frame = copies.size() - StreamingBuffer::RegionCount;
+       frame < copies.size(); ++frame) {
+    glDeleteSync(copyFences[frame]);
+  }
+
+  CHECK_EQUAL(StreamingBuffer::GetRegionSize(), RegionSize);
+  for (std::size_t frame = 0; frame < copies.size(); ++frame) {
+    if (frame >= StreamingBuffer::RegionCount) {
+      CHECK_EQUAL(offsets[frame],
+                  offsets[frame - StreamingBuffer::RegionCount]);
+    }
+    CHECK(ReadCopy(copies[frame], RegionSize) ==
+          Pattern(RegionSize, static_cast<std::uint8_t>(frame)));
+  }
+}
+
+// A frame outgrowing its region goes on in a new, larger buffer. Its earlier
+// allocations stay readable until the old buffer's deletion is flushed, at
+// the start of the next frame.
+void TestGrow() {
+  StreamingBuffer::BeginFrame();
+
+  const std::vector<std::uint8_t> first = Pattern(700, 1);
+  const std::vector<std::uint8_t> second = Pattern(700, 2);
+  const StreamAllocation firstRange =
+      StreamingBuffer::Upload(first.data(), first.size());
+  const StreamAllocation secondRange =
+      StreamingBuffer::Upload(second.data(), second.size());
+
+  CHECK(secondRange.buffer != firstRange.buffer);
+  CHECK(StreamingBuffer::GetRegionSize() >= first.size() + second.size());
+
+  const GLuint firstCopy = CopyOnGpu(firstRange);
+  const GLuint secondCopy = CopyOnGpu(secondRange);
+
+  // Larger than twice the region: the new one is sized for the request.
+  const std::size_t largeSize = 5 * StreamingBuffer::GetRegionSize();
+  const std::vector<std::uint8_t> large = Pattern(largeSize, 3);
+  const StreamAllocation largeRange =
+      StreamingBuffer::Upload(large.data(), large.size());
+  CHECK(largeRange.buffer != secondRange.buffer);
+  CHECK(StreamingBuffer::GetRegionSize() >= largeSize);
+  const GLuint largeCopy = CopyOnGpu(largeRange);
+
+  StreamingBuffer::EndFrame();
+  CHECK_EQUAL(StreamingBuffer::GetLastFrameBytes(),
+              first.size() + second.size() + largeSize);
+
+  CHECK(ReadCopy(firstCopy, first.size()) == first);
+  CHECK(ReadCopy(secondCopy, second.size()) == second);
+  CHECK(ReadCopy(largeCopy, largeSize) == large);
+
+  // The next frames cycle through the regions of the new buffer, without
+  // fences left from the old one.
+  GLDeletionQueue::Flush();
+  const std::size_t regionSize = StreamingBuffer::GetRegionSize();
+  for (std::size_t frame = 0; frame < 2 * StreamingBuffer::RegionCount;
+       ++frame) {
+    StreamingBuffer::BeginFrame();
+    const std::vector<std::uint8_t> data =
+        Pattern(regionSize, static_cast<std::uint8_t>(frame + 4));
+    const StreamAllocation allocation =
+        StreamingBuffer::Upload(data.data(), data.size());
+    CHECK_EQUAL(allocation.buffer, largeRange.buffer);
+    CHECK_EQUAL(static_cast<std::size_t>(allocation.offset),
+                (frame + 1) % StreamingBuffer::RegionCount * regionSize);
+    const GLuint copy = CopyOnGpu(allocation);
+    StreamingBuffer::EndFrame();
+    CHECK(ReadCopy(copy, regionSize) == data);
+  }
+}
+
+}  // namespace
+
+int main() {
+  test::GLContext context;
+  if (!context.IsValid()) {
+    return test::SkipCode;
+  }
+
+  StreamingBuffer::Initialize(RegionSize);
+  CHECK_EQUAL(StreamingBuffer::GetRegionSize(), RegionSize);
+
+  TestFrames();
+  TestRegionReuse();
+  TestGrow();
+
+  StreamingBuffer::Shutdown();
+  GLDeletionQueue::Flush();
+  return test::Result();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdio>
+
+/**
+ * Minimal assertions shared by the test executables.
+ *
+ * Every file of tests/ is one executable registered with CTest. Its main()
+ * runs the checks and returns test::Result(), which is non-zero if any
+ * failed; a failed check prints its location and keeps going.
+ */
+namespace test {
+
+inline int& FailureCount() {
+  static int failures = 0;
+  return failures;
+}
+
+inline int Result() {
+  if (FailureCount() != 0) {
+    std::printf("%d check(s) failed\n", FailureCount());
+    return 1;
+  }
+
+  std::printf("All checks passed\n");
+  return 0;
+}
+
+}  // namespace test
+
+#define CHECK(condition)                                              \
+  do {                                                                \
+    if (!(condition)) {                                               \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,    \
+                  #condition);                                        \
+      ++test::FailureCount();                                         \
+    }                                                                 \
+  } while (false)
+
+#define CHECK_EQUAL(actual, expected)                                 \
+  do {                                                                \
+    if (!((actual) == (expected))) {                                  \
+      std::printf("%s:%d: CHECK_EQUAL(%s, %s) failed\n", __FILE__,    \
+                  __LINE__, #actual, #expected);                      \
+      ++test::FailureCount();                                         \
+    }                                                                 \
+  } while (false)
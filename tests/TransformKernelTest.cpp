@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "Test.h"
+#include "core/TransformKernel.h"
+
+namespace {
+
+/** Random transforms, stored the way the kernels read them. */
+struct TransformArrays {
+  explicit TransformArrays(std::size_t count) {
+    std::mt19937 generator(1158);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+    for (std::vector<float>& array : arrays) {
+      array.resize(count);
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+      glm::quat rotation(component(generator), component(generator),
+                         component(generator), component(generator));
+      rotation = glm::normalize(rotation);
+
+      arrays[0][i] = position(generator);
+      arrays[1][i] = position(generator);
+      arrays[2][i] = position(generator);
+      arrays[3][i] = rotation.x;
+      arrays[4][i] = rotation.y;
+      arrays[5][i] = rotation.z;
+      arrays[6][i] = rotation.w;
+      arrays[7][i] = scale(generator);
+      arrays[8][i] = scale(generator);
+      arrays[9][i] = scale(generator);
+    }
+  }
+
+  [[nodiscard]] TransformSoA GetSoA() const {
+    return {arrays[0].data(), arrays[1].data(), arrays[2].data(),
+            arrays[3].data(), arrays[4].data(), arrays[5].data(),
+            arrays[6].data(), arrays[7].data(), arrays[8].data(),
+            arrays[9].data()};
+  }
+
+  /** What TransformComponent::GetLocalMatrix() computes with glm. */
+  [[nodiscard]] glm::mat4 GetReference(std::size_t i) const {
+    glm::mat4 matrix = glm::mat4_cast(
+        glm::quat(arrays[6][i], arrays[3][i], arrays[4][i], arrays[5][i]));
+    matrix[0] *= arrays[7][i];
+    matrix[1] *= arrays[8][i];
+    matrix[2] *= arrays[9][i];
+    matrix[3] = glm::vec4(arrays[0][i], arrays[1][i], arrays[2][i], 1.0f);
+    return matrix;
+  }
+
+  std::array<std::vector<float>, 10> arrays;
+};
+
+float MaxDifference(const glm::mat4& a, const glm::mat4& b) {
+  float difference = 0.0f;
+  for (int column = 0; column < 4; ++column) {
+    for (int row = 0; row < 4; ++row) {
+      difference =
+          std::max(difference, std::fabs(a[column][row] - b[column][row]));
+    }
+  }
+  return difference;
+}
+
+// Counts around the 4 and 8 lane widths exercise the remainder loops.
+constexpr std::array<std::size_t, 9> Counts{1, 3, 4, 5, 7, 8, 9, 17, 1003};
+
+/** Positions reach 500, so rounding differences stay well below this. */
+constexpr float Tolerance = 1e-4f;
+
+/** Whether the CPU runs `level`: the selected level is the best it runs. */
+bool IsSupported(TransformKernelLevel level) {
+  return static_cast<int>(level) <=
+         static_cast<int>(GetTransformKernelLevel());
+}
+
+void TestKernel(const char* name, TransformKernelLevel level,
+                TransformKernelFn kernel) {
+  if (kernel == nullptr || !IsSupported(level)) {
+    std::printf("%s kernel not available, skipped\n", name);
+    return;
+  }
+
+  for (std::size_t count : Counts) {
+    const TransformArrays transforms(count);
+    // One extra matrix catches writes past the end.
+    std::vector<glm::mat4> output(count + 1, glm::mat4(7.0f));
+    kernel(transforms.GetSoA(), count, output.data());
+
+    float difference = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+      difference = std::max(
+          difference, MaxDifference(output[i], transforms.GetReference(i)));
+    }
+
+    CHECK(difference < Tolerance);
+    CHECK(output[count] == glm::mat4(7.0f));
+  }
+}
+
+// The vector kernels must give the scalar fallback's results.
+void TestKernelsAgree() {
+  constexpr std::size_t Count = 1003;
+  const TransformArrays transforms(Count);
+  std::vector<glm::mat4> scalar(Count);
+  GetTransformKernelScalar()(transforms.GetSoA(), Count, scalar.data());
+
+  const std::array<std::pair<TransformKernelLevel, TransformKernelFn>, 2>
+      kernels{{{TransformKernelLevel::Sse42, GetTransformKernelSse42()},
+               {TransformKernelLevel::Avx2, GetTransformKernelAvx2()}}};
+
+  for (const auto& [level, kernel] : kernels) {
+    if (kernel == nullptr || !IsSupported(level)) {
+      continue;
+    }
+
+    std::vector<glm::mat4> output(Count);
+    kernel(transforms.GetSoA(), Count, output.data());
+    for (std::size_t i = 0; i < Count; ++i) {
+      CHECK(MaxDifference(output[i], scalar[i]) < Tolerance);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  std::printf("Selected kernel level: %d\n",
+              static_cast<int>(GetTransformKernelLevel()));
+
+  TestKernel("Scalar", TransformKernelLevel::Scalar,
+             GetTransformKernelScalar());
+  TestKernel("SSE4.2", TransformKernelLevel::Sse42, GetTransformKernelSse42());
+  TestKernel("AVX2", TransformKernelLevel::Avx2, GetTransformKernelAvx2());
+  TestKernelsAgree();
+  return test::Result();
+}